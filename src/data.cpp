@@ -32,17 +32,27 @@ BOOST_CONCEPT_ASSERT((WireDecodable<Data>));
 static_assert(std::is_base_of<tlv::Error, Data::Error>::value,
               "Data::Error must inherit from tlv::Error");
 
+const size_t Data::ENCODING_HEADROOM = 1024;
+
+/** @brief an encoded packet may leave at most 1/MAX_UNUSED_ENCODING_RATIO of its size unused
+ *         in its buffer, or else it is copied into a buffer of its own size
+ */
+static const size_t MAX_UNUSED_ENCODING_RATIO = 8;
+
 Data::Data()
   : m_content(tlv::Content) // empty content
+  , m_lazyFields(0)
 {
 }
 
 Data::Data(const Name& name)
   : m_name(name)
+  , m_lazyFields(0)
 {
 }
 
 Data::Data(const Block& wire)
+  : m_lazyFields(0)
 {
   wireDecode(wire);
 }
@@ -61,7 +71,8 @@ Data::wireEncode(EncodingImpl<TAG>& encoder, bool unsignedPortion/* = false*/) c
 
   // (reverse encoding)
 
-  if (!unsignedPortion && !m_signature)
+  const Signature& signature = getSignature();
+  if (!unsignedPortion && !signature)
     {
       throw Error("Requested wire format, but data packet has not been signed yet");
     }
@@ -69,11 +80,11 @@ Data::wireEncode(EncodingImpl<TAG>& encoder, bool unsignedPortion/* = false*/) c
   if (!unsignedPortion)
     {
       // SignatureValue
-      totalLength += encoder.prependBlock(m_signature.getValue());
+      totalLength += encoder.prependBlock(signature.getValue());
     }
 
   // SignatureInfo
-  totalLength += encoder.prependBlock(m_signature.getInfo());
+  totalLength += encoder.prependBlock(signature.getInfo());
 
   // Content
   totalLength += encoder.prependBlock(getContent());
@@ -111,7 +122,7 @@ Data::wireEncode(EncodingBuffer& encoder, const Block& signatureValue) const
   encoder.prependVarNumber(totalLength);
   encoder.prependVarNumber(tlv::Data);
 
-  const_cast<Data*>(this)->wireDecode(encoder.block());
+  adoptWire(encoder.block());
   return m_wire;
 }
 
@@ -121,19 +132,26 @@ Data::wireEncode() const
   if (m_wire.hasWire())
     return m_wire;
 
-  EncodingEstimator estimator;
-  size_t estimatedSize = wireEncode(estimator);
-
-  EncodingBuffer buffer(estimatedSize, 0);
+  // Single pass: Data is encoded backwards into a buffer sized after Content plus a guess
+  // for the other elements, which grows if the guess turns out to be too small
+  EncodingBuffer buffer(getContent().size() + ENCODING_HEADROOM, 0);
   wireEncode(buffer);
 
-  const_cast<Data*>(this)->wireDecode(buffer.block());
+  adoptWire(buffer.block());
   return m_wire;
 }
 
 void
 Data::wireDecode(const Block& wire)
 {
+  wireDecodeLazily(wire);
+  decodeLazyFields(m_lazyFields);
+}
+
+void
+Data::wireDecodeLazily(const Block& wire)
+{
+  m_lazyFields = 0;
   m_fullName.clear();
   m_wire = wire;
   m_wire.parse();
@@ -144,26 +162,71 @@ Data::wireDecode(const Block& wire)
   //            Content
   //            Signature
 
-  // Name
-  m_name.wireDecode(m_wire.get(tlv::Name));
-
-  // MetaInfo
-  m_metaInfo.wireDecode(m_wire.get(tlv::MetaInfo));
+  // mandatory elements are checked upfront, only their decoding is deferred
+  m_wire.get(tlv::Name);
+  m_wire.get(tlv::MetaInfo);
+  m_wire.get(tlv::SignatureInfo);
 
   // Content
   m_content = m_wire.get(tlv::Content);
 
-  ///////////////
-  // Signature //
-  ///////////////
+  m_lazyFields = LAZY_NAME | LAZY_META_INFO | LAZY_SIGNATURE;
+}
 
-  // SignatureInfo
-  m_signature.setInfo(m_wire.get(tlv::SignatureInfo));
+void
+Data::adoptWire(const Block& wire) const
+{
+  // Name, MetaInfo, and SignatureInfo have just been encoded from this Data,
+  // so only Name, Content, and SignatureValue are taken from the new wire encoding
+  Data* self = const_cast<Data*>(this);
+
+  m_lazyFields = 0;
+  m_fullName.clear();
 
-  // SignatureValue
-  Block::element_const_iterator val = m_wire.find(tlv::SignatureValue);
-  if (val != m_wire.elements_end())
-    m_signature.setValue(*val);
+  // the encoding buffer is sized for the largest expected packet; the packet is copied into
+  // a buffer of its own size if the buffer has much more unused room than the packet needs
+  size_t bufferSize = wire.getBuffer()->size();
+  if (bufferSize - wire.size() > wire.size() / MAX_UNUSED_ENCODING_RATIO) {
+    m_wire = Block(wire.wire(), wire.size());
+  }
+  else {
+    m_wire = wire;
+  }
+  m_wire.parse();
+
+  // the Name refers to the new wire encoding, so that it can be compared on the wire
+  self->m_name.wireDecode(m_wire.get(tlv::Name));
+  m_content = m_wire.get(tlv::Content);
+  self->m_signature.setValue(m_wire.get(tlv::SignatureValue));
+}
+
+void
+Data::decodeLazyFields(uint8_t fields) const
+{
+  Data* self = const_cast<Data*>(this);
+  fields &= m_lazyFields;
+
+  // each field is marked as decoded only after its decoding succeeded,
+  // so that a malformed field keeps throwing on every access
+
+  if ((fields & LAZY_NAME) != 0) {
+    self->m_name.wireDecode(m_wire.get(tlv::Name));
+    m_lazyFields &= ~LAZY_NAME;
+  }
+
+  if ((fields & LAZY_META_INFO) != 0) {
+    self->m_metaInfo.wireDecode(m_wire.get(tlv::MetaInfo));
+    m_lazyFields &= ~LAZY_META_INFO;
+  }
+
+  if ((fields & LAZY_SIGNATURE) != 0) {
+    Signature signature(m_wire.get(tlv::SignatureInfo));
+    Block::element_const_iterator val = m_wire.find(tlv::SignatureValue);
+    if (val != m_wire.elements_end())
+      signature.setValue(*val);
+    self->m_signature = std::move(signature);
+    m_lazyFields &= ~LAZY_SIGNATURE;
+  }
 }
 
 Data&
@@ -183,8 +246,10 @@ Data::getFullName() const
       throw Error("Full name requested, but Data packet does not have wire format "
                   "(e.g., not signed)");
     }
-    m_fullName = m_name;
+    m_fullName = getName();
     m_fullName.appendImplicitSha256Digest(crypto::sha256(m_wire.wire(), m_wire.size()));
+    // full Name is mostly used as a lookup key: with wire encoding, it is compared on the wire
+    m_fullName.wireEncode();
   }
 
   return m_fullName;
@@ -317,6 +382,10 @@ Data::onChanged()
   // !!!Note!!! Signature is not invalidated and it is responsibility of
   // the application to do proper re-signing if necessary
 
+  // deferred fields cannot be decoded once the wire encoding is gone
+  if (m_lazyFields != 0)
+    decodeLazyFields(m_lazyFields);
+
   m_wire.reset();
   m_fullName.clear();
 }
@@ -129,12 +129,37 @@ public:
   const Block&
   wireEncode(EncodingBuffer& encoder, const Block& signatureValue) const;
 
+  /**
+   * @brief Buffer room to reserve for encoding of all elements but Content
+   *
+   * An EncodingBuffer of getContent().size() + ENCODING_HEADROOM bytes fits a Data packet
+   * with a typical Name and Signature, so that it is encoded in a single pass without
+   * reallocation.  A larger packet is still encoded correctly, at the cost of a reallocation.
+   */
+  static const size_t ENCODING_HEADROOM;
+
   /**
    * @brief Decode from the wire format
    */
   void
   wireDecode(const Block& wire);
 
+  /**
+   * @brief Decode from the wire format, deferring decoding of Name, MetaInfo, and Signature
+   *
+   * Only the outer TLV and Content are decoded immediately.  Name, MetaInfo, and SignatureInfo
+   * are decoded from the retained wire encoding when first accessed, so that an application
+   * which only needs the Name (e.g., to dispatch or forward the packet) does not pay for
+   * decoding of the other fields.
+   *
+   * @throw tlv::Error if the outer TLV is malformed or a mandatory element is missing
+   * @note An error in a deferred field is reported (as tlv::Error) when that field is accessed.
+   * @note Access to a deferred field modifies the object, therefore concurrent access to a
+   *       lazily decoded Data from several threads is unsafe even through const methods.
+   */
+  void
+  wireDecodeLazily(const Block& wire);
+
   /**
    * @brief Check if Data is already has wire encoding
    */
@@ -317,6 +342,29 @@ protected:
   void
   onChanged();
 
+private:
+  enum {
+    LAZY_NAME      = 1 << 0,
+    LAZY_META_INFO = 1 << 1,
+    LAZY_SIGNATURE = 1 << 2
+  };
+
+  /**
+   * @brief Decode those of @p fields that have been deferred by wireDecodeLazily
+   */
+  void
+  decodeLazyFields(uint8_t fields) const;
+
+  /**
+   * @brief Take @p wire, which has just been encoded from this Data, as the wire encoding
+   *
+   * Unlike wireDecode, fields that are already up to date in memory are not decoded again.
+   * If @p wire leaves much of its buffer unused, it is copied into a buffer of its own size,
+   * so that a stored packet does not keep the encoding headroom alive.
+   */
+  void
+  adoptWire(const Block& wire) const;
+
 private:
   Name m_name;
   MetaInfo m_metaInfo;
@@ -325,6 +373,7 @@ private:
 
   mutable Block m_wire;
   mutable Name m_fullName;
+  mutable uint8_t m_lazyFields;
 
   nfd::LocalControlHeader m_localControlHeader;
   friend class nfd::LocalControlHeader;
@@ -342,36 +391,48 @@ Data::hasWire() const
 inline const Name&
 Data::getName() const
 {
+  if ((m_lazyFields & LAZY_NAME) != 0)
+    decodeLazyFields(LAZY_NAME);
   return m_name;
 }
 
 inline const MetaInfo&
 Data::getMetaInfo() const
 {
+  if ((m_lazyFields & LAZY_META_INFO) != 0)
+    decodeLazyFields(LAZY_META_INFO);
   return m_metaInfo;
 }
 
 inline uint32_t
 Data::getContentType() const
 {
+  if ((m_lazyFields & LAZY_META_INFO) != 0)
+    decodeLazyFields(LAZY_META_INFO);
   return m_metaInfo.getType();
 }
 
 inline const time::milliseconds&
 Data::getFreshnessPeriod() const
 {
+  if ((m_lazyFields & LAZY_META_INFO) != 0)
+    decodeLazyFields(LAZY_META_INFO);
   return m_metaInfo.getFreshnessPeriod();
 }
 
 inline const name::Component&
 Data::getFinalBlockId() const
 {
+  if ((m_lazyFields & LAZY_META_INFO) != 0)
+    decodeLazyFields(LAZY_META_INFO);
   return m_metaInfo.getFinalBlockId();
 }
 
 inline const Signature&
 Data::getSignature() const
 {
+  if ((m_lazyFields & LAZY_SIGNATURE) != 0)
+    decodeLazyFields(LAZY_SIGNATURE);
   return m_signature;
 }
 
@@ -26,7 +26,8 @@
 #include "../face.hpp"
 
 #include "registered-prefix.hpp"
-#include "pending-interest.hpp"
+#include "interest-filter-table.hpp"
+#include "pending-interest-table.hpp"
 
 #include "../util/scheduler.hpp"
 #include "../util/config-file.hpp"
@@ -43,8 +44,6 @@ namespace ndn {
 class Face::Impl : noncopyable
 {
 public:
-  typedef std::list<shared_ptr<PendingInterest> > PendingInterestTable;
-  typedef std::list<shared_ptr<InterestFilterRecord> > InterestFilterTable;
   typedef std::list<shared_ptr<RegisteredPrefix> > RegisteredPrefixTable;
 
   explicit
@@ -59,42 +58,29 @@ public:
   void
   satisfyPendingInterests(Data& data)
   {
-    for (PendingInterestTable::iterator i = m_pendingInterestTable.begin();
-         i != m_pendingInterestTable.end();
-         )
-      {
-        if ((*i)->getInterest()->matchesData(data))
-          {
-            // Copy pointers to the objects and remove the PIT entry before calling the callback.
-            OnData onData = (*i)->getOnData();
-            shared_ptr<const Interest> interest = (*i)->getInterest();
-
-            PendingInterestTable::iterator next = i;
-            ++next;
-            m_pendingInterestTable.erase(i);
-            i = next;
-
-            if (static_cast<bool>(onData)) {
-              onData(*interest, data);
-            }
-          }
-        else
-          ++i;
+    // matching entries are removed from the PIT before any callback is called
+    std::vector<shared_ptr<PendingInterest>> satisfied =
+      m_pendingInterestTable.extractMatching(data);
+
+    for (const shared_ptr<PendingInterest>& pendingInterest : satisfied) {
+      const OnData& onData = pendingInterest->getOnData();
+      if (static_cast<bool>(onData)) {
+        onData(*pendingInterest->getInterest(), data);
       }
+    }
+
+    this->schedulePitExpire();
   }
 
   void
   processInterestFilters(Interest& interest)
   {
-    for (InterestFilterTable::iterator i = m_interestFilterTable.begin();
-         i != m_interestFilterTable.end();
-         ++i)
-      {
-        if ((*i)->doesMatch(interest.getName()))
-          {
-            (**i)(interest);
-          }
-      }
+    std::vector<shared_ptr<InterestFilterRecord>> matches =
+      m_interestFilterTable.findMatching(interest.getName());
+
+    for (const shared_ptr<InterestFilterRecord>& record : matches) {
+      (*record)(interest);
+    }
   }
 
   /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -117,7 +103,7 @@ public:
   {
     this->ensureConnected();
 
-    m_pendingInterestTable.push_back(make_shared<PendingInterest>(interest, onData, onTimeout));
+    m_pendingInterestTable.insert(make_shared<PendingInterest>(interest, onData, onTimeout));
 
     if (!interest->getLocalControlHeader().empty(nfd::LocalControlHeader::ENCODE_NEXT_HOP))
       {
@@ -131,17 +117,14 @@ public:
         m_face.m_transport->send(interest->wireEncode());
       }
 
-    if (!m_pitTimeoutCheckTimerActive) {
-      m_pitTimeoutCheckTimerActive = true;
-      m_pitTimeoutCheckTimer->expires_from_now(time::milliseconds(100));
-      m_pitTimeoutCheckTimer->async_wait(bind(&Impl::checkPitExpire, this));
-    }
+    this->schedulePitExpire();
   }
 
   void
   asyncRemovePendingInterest(const PendingInterestId* pendingInterestId)
   {
-    m_pendingInterestTable.remove_if(MatchPendingInterestId(pendingInterestId));
+    m_pendingInterestTable.erase(pendingInterestId);
+    this->schedulePitExpire();
   }
 
   void
@@ -168,19 +151,13 @@ public:
   void
   asyncSetInterestFilter(const shared_ptr<InterestFilterRecord>& interestFilterRecord)
   {
-    m_interestFilterTable.push_back(interestFilterRecord);
+    m_interestFilterTable.insert(interestFilterRecord);
   }
 
   void
   asyncUnsetInterestFilter(const InterestFilterId* interestFilterId)
   {
-    InterestFilterTable::iterator i = std::find_if(m_interestFilterTable.begin(),
-                                                   m_interestFilterTable.end(),
-                                                   MatchInterestFilterId(interestFilterId));
-    if (i != m_interestFilterTable.end())
-      {
-        m_interestFilterTable.erase(i);
-      }
+    m_interestFilterTable.erase(interestFilterId);
   }
 
   /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -242,7 +219,7 @@ public:
 
     if (static_cast<bool>(registeredPrefix->getFilter())) {
       // it was a combined operation
-      m_interestFilterTable.push_back(registeredPrefix->getFilter());
+      m_interestFilterTable.insert(registeredPrefix->getFilter());
     }
 
     if (static_cast<bool>(onSuccess)) {
@@ -264,7 +241,7 @@ public:
         if (static_cast<bool>(filter))
           {
             // it was a combined operation
-            m_interestFilterTable.remove(filter);
+            m_interestFilterTable.erase(filter);
           }
         (*i)->unregister(bind(&Impl::finalizeUnregisterPrefix, this, i, onSuccess),
                          bind(onFailure, _2));
@@ -286,10 +263,7 @@ public:
 
     if (!m_pitTimeoutCheckTimerActive && m_registeredPrefixTable.empty())
       {
-        m_face.m_transport->pause();
-        if (!m_ioServiceWork) {
-          m_processEventsTimeoutTimer->cancel();
-        }
+        this->schedulePauseIfIdle();
       }
 
     if (static_cast<bool>(onSuccess)) {
@@ -300,44 +274,80 @@ public:
   /////////////////////////////////////////////////////////////////////////////////////////////////
   /////////////////////////////////////////////////////////////////////////////////////////////////
 
+  /**
+   * @brief Arm the PIT timer for the earliest PIT entry timeout
+   *
+   * The timer is only rearmed when the earliest timeout moves earlier than the time the timer
+   * is currently armed for; a timer firing too early simply rearms itself.  When PIT becomes
+   * empty, the timer is stopped and, unless there are registered prefixes, the transport
+   * is paused with schedulePauseIfIdle().
+   */
   void
-  checkPitExpire()
+  schedulePitExpire()
   {
-    // Check for PIT entry timeouts.
-    time::steady_clock::TimePoint now = time::steady_clock::now();
-
-    PendingInterestTable::iterator i = m_pendingInterestTable.begin();
-    while (i != m_pendingInterestTable.end())
-      {
-        if ((*i)->isTimedOut(now))
-          {
-            // Save the PendingInterest and remove it from the PIT.  Then call the callback.
-            shared_ptr<PendingInterest> pendingInterest = *i;
-
-            i = m_pendingInterestTable.erase(i);
-
-            pendingInterest->callTimeout();
-          }
-        else
-          ++i;
+    if (m_pendingInterestTable.empty()) {
+      if (m_pitTimeoutCheckTimerActive) {
+        m_pitTimeoutCheckTimerActive = false;
+        m_pitTimeoutCheckTimer->cancel();
       }
 
-    if (!m_pendingInterestTable.empty()) {
-      m_pitTimeoutCheckTimerActive = true;
+      if (m_registeredPrefixTable.empty()) {
+        this->schedulePauseIfIdle();
+      }
+      return;
+    }
 
-      m_pitTimeoutCheckTimer->expires_from_now(time::milliseconds(100));
-      m_pitTimeoutCheckTimer->async_wait(bind(&Impl::checkPitExpire, this));
+    const time::steady_clock::TimePoint& nextTimeout =
+      m_pendingInterestTable.getEarliestTimeout();
+    if (m_pitTimeoutCheckTimerActive && m_pitTimeoutCheckTimer->expires_at() <= nextTimeout) {
+      return;
     }
-    else {
-      m_pitTimeoutCheckTimerActive = false;
 
-      if (m_registeredPrefixTable.empty()) {
+    m_pitTimeoutCheckTimerActive = true;
+    m_pitTimeoutCheckTimer->expires_at(nextTimeout);
+    m_pitTimeoutCheckTimer->async_wait(bind(&Impl::checkPitExpire, this, _1));
+  }
+
+  /**
+   * @brief Pause the transport after the current handler, unless PIT or registered prefix
+   *        table is no longer empty by then
+   *
+   * Pausing is deferred, as this can be called from within the transport's receive handler,
+   * where there is no pending receive operation for pause() to cancel.
+   */
+  void
+  schedulePauseIfIdle()
+  {
+    m_face.m_ioService.post([this] {
+        if (!m_pendingInterestTable.empty() || !m_registeredPrefixTable.empty())
+          return;
+
         m_face.m_transport->pause();
         if (!m_ioServiceWork) {
           m_processEventsTimeoutTimer->cancel();
         }
-      }
+      });
+  }
+
+  void
+  checkPitExpire(const boost::system::error_code& error)
+  {
+    if (error) // cancelled or rearmed
+      return;
+
+    m_pitTimeoutCheckTimerActive = false;
+
+    // Check for PIT entry timeouts; only entries that are timed out are visited
+    time::steady_clock::TimePoint now = time::steady_clock::now();
+
+    std::vector<shared_ptr<PendingInterest>> timedOut =
+      m_pendingInterestTable.extractTimedOut(now);
+
+    for (const shared_ptr<PendingInterest>& pendingInterest : timedOut) {
+      pendingInterest->callTimeout();
     }
+
+    this->schedulePitExpire();
   }
 
 private:
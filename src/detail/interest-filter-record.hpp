@@ -25,13 +25,15 @@
 #include "../common.hpp"
 #include "../name.hpp"
 #include "../interest.hpp"
+#include "../interest-filter.hpp"
+#include "../util/small-function.hpp"
 
 namespace ndn {
 
 class InterestFilterRecord : noncopyable
 {
 public:
-  typedef function<void (const InterestFilter&, const Interest&)> OnInterest;
+  typedef util::SmallFunction<void(const InterestFilter&, const Interest&)> OnInterest;
 
   InterestFilterRecord(const InterestFilter& filter, const OnInterest& onInterest)
     : m_filter(filter)
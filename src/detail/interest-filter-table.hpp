@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_DETAIL_INTEREST_FILTER_TABLE_HPP
+#define NDN_DETAIL_INTEREST_FILTER_TABLE_HPP
+
+#include "../common.hpp"
+#include "interest-filter-record.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace ndn {
+
+/**
+ * @brief Table of Interest filters of a Face
+ *
+ * Records are indexed by the hash of the prefix of their InterestFilter, which acts as a
+ * hash-based name tree: an incoming Interest is only checked against records found under each
+ * prefix of the Interest Name, instead of against every registered filter.  Prefix hashes are
+ * taken from Name::getPrefixHash, so that the Interest Name is hashed only once.  Regular
+ * expression filters are evaluated only for Interests under their prefix.
+ */
+class InterestFilterTable : noncopyable
+{
+public:
+  InterestFilterTable()
+    : m_lastSeqNo(0)
+  {
+  }
+
+  /**
+   * @brief Insert a new record
+   * @return InterestFilterId of the record
+   */
+  const InterestFilterId*
+  insert(const shared_ptr<InterestFilterRecord>& record)
+  {
+    const InterestFilterId* id = getId(*record);
+    Entry& entry = m_entries[id];
+    if (entry.record != nullptr) {
+      return id;
+    }
+
+    entry.record = record;
+    entry.seqNo = ++m_lastSeqNo;
+    const Name& prefix = record->getFilter().getPrefix();
+    m_prefixIndex.insert(std::make_pair(prefix.getPrefixHash(prefix.size()), &entry));
+    return id;
+  }
+
+  /**
+   * @brief Remove the record identified by @p id
+   * @return true if record was found and removed
+   */
+  bool
+  erase(const InterestFilterId* id)
+  {
+    EntryTable::iterator it = m_entries.find(id);
+    if (it == m_entries.end()) {
+      return false;
+    }
+
+    const Name& prefix = it->second.record->getFilter().getPrefix();
+    auto range = m_prefixIndex.equal_range(prefix.getPrefixHash(prefix.size()));
+    for (PrefixIndex::iterator i = range.first; i != range.second; ++i) {
+      if (i->second == &it->second) {
+        m_prefixIndex.erase(i);
+        break;
+      }
+    }
+
+    m_entries.erase(it);
+    return true;
+  }
+
+  /**
+   * @brief Remove @p record
+   * @return true if record was found and removed
+   */
+  bool
+  erase(const shared_ptr<InterestFilterRecord>& record)
+  {
+    return this->erase(getId(*record));
+  }
+
+  /**
+   * @brief Find all records whose filter matches @p name
+   *
+   * Returned records are ordered by their insertion into the table.
+   */
+  std::vector<shared_ptr<InterestFilterRecord>>
+  findMatching(const Name& name) const
+  {
+    if (m_entries.empty()) {
+      return {};
+    }
+
+    std::vector<const Entry*> matches;
+    for (size_t prefixLen = 0; prefixLen <= name.size(); ++prefixLen) {
+      this->collectMatches(name, prefixLen, matches);
+    }
+
+    std::sort(matches.begin(), matches.end(),
+              [] (const Entry* a, const Entry* b) { return a->seqNo < b->seqNo; });
+
+    std::vector<shared_ptr<InterestFilterRecord>> records;
+    records.reserve(matches.size());
+    for (const Entry* entry : matches) {
+      records.push_back(entry->record);
+    }
+    return records;
+  }
+
+  size_t
+  size() const
+  {
+    return m_entries.size();
+  }
+
+  bool
+  empty() const
+  {
+    return m_entries.empty();
+  }
+
+  void
+  clear()
+  {
+    m_prefixIndex.clear();
+    m_entries.clear();
+  }
+
+private:
+  struct Entry
+  {
+    shared_ptr<InterestFilterRecord> record;
+    uint64_t seqNo;
+  };
+
+  typedef std::unordered_map<const InterestFilterId*, Entry> EntryTable;
+  typedef std::unordered_multimap<size_t, const Entry*> PrefixIndex; ///< keyed by prefix hash
+
+  static const InterestFilterId*
+  getId(const InterestFilterRecord& record)
+  {
+    return reinterpret_cast<const InterestFilterId*>(&record);
+  }
+
+  /** @brief collect records whose filter prefix is the first @p prefixLen components of @p name
+   */
+  void
+  collectMatches(const Name& name, size_t prefixLen, std::vector<const Entry*>& matches) const
+  {
+    auto range = m_prefixIndex.equal_range(name.getPrefixHash(prefixLen));
+    for (PrefixIndex::const_iterator it = range.first; it != range.second; ++it) {
+      // equal hash does not imply equal prefix, so prefix match needs to be confirmed
+      const InterestFilter& filter = it->second->record->getFilter();
+      if (filter.getPrefix().size() == prefixLen && filter.getPrefix().isPrefixOf(name) &&
+          (!filter.hasRegexFilter() || filter.doesMatch(name))) {
+        matches.push_back(it->second);
+      }
+    }
+  }
+
+private:
+  EntryTable m_entries;
+  PrefixIndex m_prefixIndex;
+  uint64_t m_lastSeqNo;
+};
+
+} // namespace ndn
+
+#endif // NDN_DETAIL_INTEREST_FILTER_TABLE_HPP
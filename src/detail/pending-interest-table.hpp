@@ -0,0 +1,341 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_DETAIL_PENDING_INTEREST_TABLE_HPP
+#define NDN_DETAIL_PENDING_INTEREST_TABLE_HPP
+
+#include "../common.hpp"
+#include "pending-interest.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace ndn {
+
+class PendingInterestId;
+
+/**
+ * @brief Pending Interest Table of a Face
+ *
+ * Entries are indexed by the hash of the Name of the expressed Interest.  An incoming Data
+ * can only satisfy Interests whose Name is a prefix of the Data full Name, therefore matching
+ * needs one hash lookup per prefix of the Data Name instead of a scan over every pending
+ * Interest.  Prefix hashes are taken from Name::getPrefixHash, so that no prefix Name is
+ * created and the Data Name is hashed only once.  Entries are also indexed by
+ * PendingInterestId, so that removal does not need a scan either.
+ *
+ * Timeouts are tracked with a binary min-heap ordered by expiry time, with each entry
+ * remembering its own position in the heap.  Removing timed out entries therefore costs
+ * O(log n) per expiring entry, and removing an entry for any other reason is O(log n) as well.
+ */
+class PendingInterestTable : noncopyable
+{
+public:
+  PendingInterestTable()
+    : m_lastSeqNo(0)
+    , m_nImplicitDigestEntries(0)
+  {
+  }
+
+  /**
+   * @brief Insert a new entry
+   * @return PendingInterestId of the new entry
+   */
+  const PendingInterestId*
+  insert(const shared_ptr<PendingInterest>& pendingInterest)
+  {
+    const PendingInterestId* id = getId(*pendingInterest);
+    Entry& entry = m_entries[id];
+    BOOST_ASSERT(entry.pendingInterest == nullptr);
+    entry.pendingInterest = pendingInterest;
+    entry.seqNo = ++m_lastSeqNo;
+    this->pushExpiry(&entry);
+
+    const Name& name = pendingInterest->getInterest()->getName();
+    m_nameIndex.insert(std::make_pair(name.getPrefixHash(name.size()), &entry));
+    if (hasImplicitDigest(name)) {
+      ++m_nImplicitDigestEntries;
+    }
+    return id;
+  }
+
+  /**
+   * @brief Remove the entry identified by @p id
+   * @return true if entry was found and removed
+   */
+  bool
+  erase(const PendingInterestId* id)
+  {
+    EntryTable::iterator it = m_entries.find(id);
+    if (it == m_entries.end()) {
+      return false;
+    }
+
+    this->eraseEntry(it);
+    return true;
+  }
+
+  /**
+   * @brief Remove and return all entries whose Interest can be satisfied by @p data
+   *
+   * Returned entries are ordered by their insertion into the table.
+   */
+  std::vector<shared_ptr<PendingInterest>>
+  extractMatching(const Data& data)
+  {
+    if (m_entries.empty()) {
+      return {};
+    }
+
+    std::vector<const Entry*> matches;
+
+    const Name& dataName = data.getName();
+    for (size_t prefixLen = 0; prefixLen <= dataName.size(); ++prefixLen) {
+      this->collectMatches(dataName, prefixLen, data, matches);
+    }
+
+    if (m_nImplicitDigestEntries > 0) {
+      // only Interests with an implicit digest can be as long as the Data full Name,
+      // so full Name (SHA-256 over the whole wire) is computed only when such Interests exist
+      const Name& fullName = data.getFullName();
+      this->collectMatches(fullName, fullName.size(), data, matches);
+    }
+
+    return this->extract(matches);
+  }
+
+  /**
+   * @brief Remove and return all entries that are timed out at @p now
+   *
+   * Returned entries are ordered by their expiry time.  Only the expiring entries are visited.
+   */
+  std::vector<shared_ptr<PendingInterest>>
+  extractTimedOut(const time::steady_clock::TimePoint& now)
+  {
+    std::vector<shared_ptr<PendingInterest>> extracted;
+    while (!m_expiryHeap.empty() && m_expiryHeap.front()->pendingInterest->isTimedOut(now)) {
+      extracted.push_back(m_expiryHeap.front()->pendingInterest);
+      this->erase(getId(*extracted.back()));
+    }
+    return extracted;
+  }
+
+  /**
+   * @brief Get the earliest time point at which an entry times out
+   * @pre !empty()
+   */
+  const time::steady_clock::TimePoint&
+  getEarliestTimeout() const
+  {
+    BOOST_ASSERT(!m_expiryHeap.empty());
+    return m_expiryHeap.front()->pendingInterest->getTimeout();
+  }
+
+  size_t
+  size() const
+  {
+    return m_entries.size();
+  }
+
+  bool
+  empty() const
+  {
+    return m_entries.empty();
+  }
+
+  void
+  clear()
+  {
+    m_expiryHeap.clear();
+    m_nameIndex.clear();
+    m_entries.clear();
+    m_nImplicitDigestEntries = 0;
+  }
+
+private:
+  struct Entry
+  {
+    shared_ptr<PendingInterest> pendingInterest;
+    uint64_t seqNo;
+    size_t heapIndex;
+  };
+
+  typedef std::unordered_map<const PendingInterestId*, Entry> EntryTable;
+  typedef std::unordered_multimap<size_t, const Entry*> NameIndex; ///< keyed by Name hash
+
+  static const PendingInterestId*
+  getId(const PendingInterest& pendingInterest)
+  {
+    return reinterpret_cast<const PendingInterestId*>(pendingInterest.getInterest().get());
+  }
+
+  static bool
+  hasImplicitDigest(const Name& name)
+  {
+    return !name.empty() && name.get(-1).isImplicitSha256Digest();
+  }
+
+  /** @brief collect entries whose Interest Name has @p prefixLen components and matches @p data
+   *  @param name Data Name or full Name, of which the first @p prefixLen components are looked up
+   */
+  void
+  collectMatches(const Name& name, size_t prefixLen, const Data& data,
+                 std::vector<const Entry*>& matches) const
+  {
+    auto range = m_nameIndex.equal_range(name.getPrefixHash(prefixLen));
+    for (NameIndex::const_iterator it = range.first; it != range.second; ++it) {
+      // Name length check rules out hash collisions with Interests under other prefixes,
+      // which would otherwise be collected twice; matchesData checks the Name itself
+      const Interest& interest = *it->second->pendingInterest->getInterest();
+      if (interest.getName().size() == prefixLen && interest.matchesData(data)) {
+        matches.push_back(it->second);
+      }
+    }
+  }
+
+  std::vector<shared_ptr<PendingInterest>>
+  extract(std::vector<const Entry*>& matches)
+  {
+    std::sort(matches.begin(), matches.end(),
+              [] (const Entry* a, const Entry* b) { return a->seqNo < b->seqNo; });
+
+    std::vector<shared_ptr<PendingInterest>> extracted;
+    extracted.reserve(matches.size());
+    for (const Entry* entry : matches) {
+      extracted.push_back(entry->pendingInterest);
+      this->erase(getId(*entry->pendingInterest));
+    }
+    return extracted;
+  }
+
+  void
+  eraseEntry(EntryTable::iterator it)
+  {
+    const Name& name = it->second.pendingInterest->getInterest()->getName();
+    auto range = m_nameIndex.equal_range(name.getPrefixHash(name.size()));
+    for (NameIndex::iterator i = range.first; i != range.second; ++i) {
+      if (i->second == &it->second) {
+        m_nameIndex.erase(i);
+        break;
+      }
+    }
+    if (hasImplicitDigest(name)) {
+      --m_nImplicitDigestEntries;
+    }
+
+    this->removeExpiry(&it->second);
+    m_entries.erase(it);
+  }
+
+  /** @brief whether @p a times out before @p b; ties are broken by insertion order
+   */
+  static bool
+  expiresBefore(const Entry* a, const Entry* b)
+  {
+    const time::steady_clock::TimePoint& ta = a->pendingInterest->getTimeout();
+    const time::steady_clock::TimePoint& tb = b->pendingInterest->getTimeout();
+    return ta < tb || (ta == tb && a->seqNo < b->seqNo);
+  }
+
+  void
+  placeExpiry(Entry* entry, size_t index)
+  {
+    m_expiryHeap[index] = entry;
+    entry->heapIndex = index;
+  }
+
+  void
+  siftUpExpiry(size_t index)
+  {
+    Entry* entry = m_expiryHeap[index];
+    while (index > 0) {
+      size_t parent = (index - 1) / 2;
+      if (!expiresBefore(entry, m_expiryHeap[parent])) {
+        break;
+      }
+      this->placeExpiry(m_expiryHeap[parent], index);
+      index = parent;
+    }
+    this->placeExpiry(entry, index);
+  }
+
+  void
+  siftDownExpiry(size_t index)
+  {
+    Entry* entry = m_expiryHeap[index];
+    size_t size = m_expiryHeap.size();
+    while (true) {
+      size_t child = 2 * index + 1;
+      if (child >= size) {
+        break;
+      }
+      if (child + 1 < size && expiresBefore(m_expiryHeap[child + 1], m_expiryHeap[child])) {
+        ++child;
+      }
+      if (!expiresBefore(m_expiryHeap[child], entry)) {
+        break;
+      }
+      this->placeExpiry(m_expiryHeap[child], index);
+      index = child;
+    }
+    this->placeExpiry(entry, index);
+  }
+
+  void
+  pushExpiry(Entry* entry)
+  {
+    m_expiryHeap.push_back(entry);
+    this->siftUpExpiry(m_expiryHeap.size() - 1);
+  }
+
+  void
+  removeExpiry(Entry* entry)
+  {
+    size_t index = entry->heapIndex;
+    BOOST_ASSERT(index < m_expiryHeap.size() && m_expiryHeap[index] == entry);
+
+    Entry* last = m_expiryHeap.back();
+    m_expiryHeap.pop_back();
+    if (last == entry) {
+      return;
+    }
+
+    this->placeExpiry(last, index);
+    if (index > 0 && expiresBefore(last, m_expiryHeap[(index - 1) / 2])) {
+      this->siftUpExpiry(index);
+    }
+    else {
+      this->siftDownExpiry(index);
+    }
+  }
+
+private:
+  EntryTable m_entries;
+  NameIndex m_nameIndex;
+  std::vector<Entry*> m_expiryHeap;
+  uint64_t m_lastSeqNo;
+  size_t m_nImplicitDigestEntries;
+};
+
+} // namespace ndn
+
+#endif // NDN_DETAIL_PENDING_INTEREST_TABLE_HPP
@@ -26,14 +26,15 @@
 #include "../interest.hpp"
 #include "../data.hpp"
 #include "../util/time.hpp"
+#include "../util/small-function.hpp"
 
 namespace ndn {
 
 class PendingInterest : noncopyable
 {
 public:
-  typedef function<void(const Interest&, Data&)> OnData;
-  typedef function<void(const Interest&)> OnTimeout;
+  typedef util::SmallFunction<void(const Interest&, Data&)> OnData;
+  typedef util::SmallFunction<void(const Interest&)> OnTimeout;
 
   /**
    * @brief Create a new PitEntry and set the timeout based on the current time and
@@ -68,6 +69,15 @@ public:
     return m_onData;
   }
 
+  /**
+   * @return the time point at which this interest times out
+   */
+  const time::steady_clock::TimePoint&
+  getTimeout() const
+  {
+    return m_timeout;
+  }
+
   /**
    * Check if this interest is timed out.
    * @return true if this interest timed out, otherwise false.
@@ -304,30 +304,56 @@ Block::parse() const
   Buffer::const_iterator begin = value_begin();
   Buffer::const_iterator end = value_end();
 
+  // first pass validates the sub-elements and counts them, so that m_subBlocks is allocated
+  // exactly once instead of growing geometrically while elements are appended
+  size_t nElements = 0;
   while (begin != end)
     {
-      Buffer::const_iterator element_begin = begin;
-
-      uint32_t type = tlv::readType(begin, end);
+      tlv::readType(begin, end);
       uint64_t length = tlv::readVarNumber(begin, end);
 
       if (length > static_cast<uint64_t>(end - begin))
         {
-          m_subBlocks.clear();
           throw tlv::Error("TLV length exceeds buffer length");
         }
+
+      begin += length;
+      ++nElements;
+    }
+
+  m_subBlocks.reserve(nElements);
+  ElementArena* arena = m_subBlocks.get_allocator().getArena();
+
+  begin = value_begin();
+  while (begin != end)
+    {
+      Buffer::const_iterator element_begin = begin;
+
+      uint32_t type = tlv::readType(begin, end);
+      uint64_t length = tlv::readVarNumber(begin, end);
       Buffer::const_iterator element_end = begin + length;
 
-      m_subBlocks.push_back(Block(m_buffer,
-                                  type,
-                                  element_begin, element_end,
-                                  begin, element_end));
+      m_subBlocks.emplace_back(m_buffer,
+                               type,
+                               element_begin, element_end,
+                               begin, element_end);
+      if (arena != nullptr) {
+        // the subblock will allocate its own subblocks from the same arena
+        m_subBlocks.back().m_subBlocks = element_container(ElementAllocator<Block>(arena));
+      }
 
       begin = element_end;
       // don't do recursive parsing, just the top level
     }
 }
 
+void
+Block::useElementArena(size_t capacity)
+{
+  ElementAllocator<Block> allocator(ElementArena::create(capacity));
+  m_subBlocks = element_container(m_subBlocks.begin(), m_subBlocks.end(), allocator);
+}
+
 void
 Block::encode()
 {
@@ -29,6 +29,7 @@
 #include "buffer.hpp"
 #include "tlv.hpp"
 #include "encoding-buffer-fwd.hpp"
+#include "element-arena.hpp"
 
 namespace boost {
 namespace asio {
@@ -43,7 +44,12 @@ namespace ndn {
 class Block
 {
 public:
-  typedef std::vector<Block>                 element_container;
+  /** @brief list of subblocks
+   *
+   *  @note This is not std::vector<Block>: its allocator takes memory from an ElementArena
+   *        when useElementArena() is in effect, and from the heap otherwise.
+   */
+  typedef std::vector<Block, ElementAllocator<Block>> element_container;
   typedef element_container::iterator        element_iterator;
   typedef element_container::const_iterator  element_const_iterator;
 
@@ -232,10 +238,34 @@ public: // sub elements
    *
    *  This method is not really const, but it does not modify any data.  It simply
    *  parses contents of the buffer into subblocks
+   *
+   *  Subblocks are counted before they are stored, so parsing a Block makes one allocation
+   *  for its subblock list.  That list comes from the heap, so decoding a packet makes one heap
+   *  allocation per parsed level, unless useElementArena() was called, in which case all levels
+   *  share one arena.  Subblocks hold their own reference to the wire buffer in either case.
    */
   void
   parse() const;
 
+  /** @brief Allocate subblocks from an arena, instead of one heap allocation per parsed Block
+   *
+   *  Subblocks of this Block, of the subblocks parsed from it at any depth, and of copies of
+   *  any of them, are allocated from one ElementArena of @p capacity octets.  Decoding a packet
+   *  from such a Block, e.g., with Data::wireDecode, then costs a single heap allocation for
+   *  all levels of its TLV structure.  The arena is freed when the last Block using it is
+   *  destroyed, so a small element kept from a large packet keeps the whole arena allocated.
+   *
+   *  This should be called before the Block is parsed; subblocks that already exist are moved
+   *  into the arena, but their own subblocks are not.
+   */
+  void
+  useElementArena(size_t capacity = ElementArena::DEFAULT_CAPACITY);
+
+  /** @return the arena of subblocks, or nullptr if they are allocated from the heap
+   */
+  const ElementArena*
+  getElementArena() const;
+
   /** @brief Encode subblocks into wire buffer
    */
   void
@@ -431,6 +461,12 @@ Block::push_back(const Block& element)
   m_subBlocks.push_back(element);
 }
 
+inline const ElementArena*
+Block::getElementArena() const
+{
+  return m_subBlocks.get_allocator().getArena();
+}
+
 inline const Block::element_container&
 Block::elements() const
 {
@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "element-arena.hpp"
+
+#include <new>
+
+namespace ndn {
+
+/** @brief alignment of the storage and of every allocation in the arena
+ */
+static const size_t ALIGNMENT = 2 * sizeof(void*);
+
+static size_t
+alignSize(size_t size)
+{
+  return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+// a Data with a 10-component Name needs about 2 KB on 64-bit platforms
+const size_t ElementArena::DEFAULT_CAPACITY = 4096;
+
+ElementArena::ElementArena(size_t capacity)
+  : m_nRefs(0)
+  , m_usedSize(0)
+  , m_nAllocations(0)
+  , m_nHeapAllocations(0)
+  , m_capacity(capacity)
+{
+}
+
+ElementArena*
+ElementArena::create(size_t capacity)
+{
+  capacity = alignSize(capacity);
+  void* memory = ::operator new(alignSize(sizeof(ElementArena)) + capacity);
+  return new (memory) ElementArena(capacity);
+}
+
+uint8_t*
+ElementArena::getStorage() const
+{
+  return reinterpret_cast<uint8_t*>(const_cast<ElementArena*>(this)) +
+         alignSize(sizeof(ElementArena));
+}
+
+void
+ElementArena::release()
+{
+  if (m_nRefs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    this->~ElementArena();
+    ::operator delete(this);
+  }
+}
+
+void*
+ElementArena::allocate(size_t size)
+{
+  size = alignSize(size);
+  size_t offset = m_usedSize.fetch_add(size, std::memory_order_relaxed);
+  if (size <= m_capacity && offset <= m_capacity - size) {
+    m_nAllocations.fetch_add(1, std::memory_order_relaxed);
+    return getStorage() + offset;
+  }
+
+  // the region is exhausted; m_usedSize stays beyond the capacity, so later requests
+  // are also served from the heap
+  m_nHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+  return ::operator new(size);
+}
+
+} // namespace ndn
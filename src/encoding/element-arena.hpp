@@ -0,0 +1,235 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_ENCODING_ELEMENT_ARENA_HPP
+#define NDN_ENCODING_ELEMENT_ARENA_HPP
+
+#include "../common.hpp"
+
+#include <atomic>
+
+namespace ndn {
+
+/** @brief Memory shared by the sub-element lists of the Blocks of one packet
+ *
+ *  Memory is handed out from a fixed-size region that follows the arena in a single heap
+ *  allocation, and is not reused until the arena is freed.  Requests that do not fit are
+ *  served from the heap.  The arena is reference counted by the allocators that refer to it,
+ *  and is freed when the last of them is destroyed.
+ *
+ *  Allocation and reference counting are thread-safe, so that copies of a Block can be parsed
+ *  on different threads.
+ */
+class ElementArena : noncopyable
+{
+public:
+  /** @brief default capacity, in octets, enough for the sub-elements of a typical packet
+   */
+  static const size_t DEFAULT_CAPACITY;
+
+  /** @brief creates an arena of @p capacity octets, without references
+   */
+  static ElementArena*
+  create(size_t capacity = DEFAULT_CAPACITY);
+
+  void
+  acquire()
+  {
+    m_nRefs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /** @brief drops a reference, and frees the arena if it was the last one
+   */
+  void
+  release();
+
+  /** @return memory of @p size octets, from the arena if it fits, otherwise from the heap
+   */
+  void*
+  allocate(size_t size);
+
+  /** @brief returns memory obtained from allocate()
+   *
+   *  Memory in the arena is reclaimed only when the arena is freed.
+   */
+  void
+  deallocate(void* p)
+  {
+    if (!contains(p)) {
+      ::operator delete(p);
+    }
+  }
+
+  size_t
+  getCapacity() const
+  {
+    return m_capacity;
+  }
+
+  /** @return number of octets handed out from the arena
+   */
+  size_t
+  getUsedSize() const
+  {
+    return std::min(m_usedSize.load(std::memory_order_relaxed), m_capacity);
+  }
+
+  /** @return number of allocations served from the arena
+   */
+  size_t
+  getNAllocations() const
+  {
+    return m_nAllocations.load(std::memory_order_relaxed);
+  }
+
+  /** @return number of allocations that did not fit and were served from the heap
+   */
+  size_t
+  getNHeapAllocations() const
+  {
+    return m_nHeapAllocations.load(std::memory_order_relaxed);
+  }
+
+private:
+  explicit
+  ElementArena(size_t capacity);
+
+  uint8_t*
+  getStorage() const;
+
+  bool
+  contains(const void* p) const
+  {
+    const uint8_t* storage = getStorage();
+    return static_cast<const uint8_t*>(p) >= storage &&
+           static_cast<const uint8_t*>(p) < storage + m_capacity;
+  }
+
+private:
+  std::atomic<size_t> m_nRefs;
+  std::atomic<size_t> m_usedSize;
+  std::atomic<size_t> m_nAllocations;
+  std::atomic<size_t> m_nHeapAllocations;
+  size_t m_capacity;
+};
+
+/** @brief Allocator of Block sub-element lists, from the heap or from an ElementArena
+ *
+ *  A default-constructed allocator uses the heap and adds no cost beyond a null check.
+ *  The allocator is propagated when its container is copied, moved, or swapped, so that
+ *  copies of a Block that uses an arena use the same arena.
+ */
+template<typename T>
+class ElementAllocator
+{
+public:
+  typedef T value_type;
+  typedef std::true_type propagate_on_container_copy_assignment;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+
+  ElementAllocator() noexcept
+    : m_arena(nullptr)
+  {
+  }
+
+  explicit
+  ElementAllocator(ElementArena* arena) noexcept
+    : m_arena(arena)
+  {
+    if (m_arena != nullptr) {
+      m_arena->acquire();
+    }
+  }
+
+  ElementAllocator(const ElementAllocator& other) noexcept
+    : ElementAllocator(other.m_arena)
+  {
+  }
+
+  template<typename U>
+  ElementAllocator(const ElementAllocator<U>& other) noexcept
+    : ElementAllocator(other.getArena())
+  {
+  }
+
+  ~ElementAllocator()
+  {
+    if (m_arena != nullptr) {
+      m_arena->release();
+    }
+  }
+
+  ElementAllocator&
+  operator=(const ElementAllocator& other) noexcept
+  {
+    ElementAllocator copy(other);
+    std::swap(m_arena, copy.m_arena);
+    return *this;
+  }
+
+  T*
+  allocate(size_t n)
+  {
+    if (m_arena != nullptr) {
+      return static_cast<T*>(m_arena->allocate(n * sizeof(T)));
+    }
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+
+  void
+  deallocate(T* p, size_t) noexcept
+  {
+    if (m_arena != nullptr) {
+      m_arena->deallocate(p);
+    }
+    else {
+      ::operator delete(p);
+    }
+  }
+
+  ElementArena*
+  getArena() const noexcept
+  {
+    return m_arena;
+  }
+
+  template<typename U>
+  bool
+  operator==(const ElementAllocator<U>& other) const noexcept
+  {
+    return m_arena == other.getArena();
+  }
+
+  template<typename U>
+  bool
+  operator!=(const ElementAllocator<U>& other) const noexcept
+  {
+    return m_arena != other.getArena();
+  }
+
+private:
+  ElementArena* m_arena;
+};
+
+} // namespace ndn
+
+#endif // NDN_ENCODING_ELEMENT_ARENA_HPP
@@ -31,6 +31,7 @@
 #include "interest-filter.hpp"
 #include "data.hpp"
 #include "security/identity-certificate.hpp"
+#include "util/small-function.hpp"
 
 namespace boost {
 namespace asio {
@@ -53,18 +54,21 @@ class Controller;
 
 /**
  * @brief Callback called when expressed Interest gets satisfied with Data packet
+ *
+ * OnData, OnTimeout, and OnInterest are stored without allocating memory when the callable
+ * object is small, such as a bind expression with an object pointer and a shared_ptr.
  */
-typedef function<void(const Interest&, Data&)> OnData;
+typedef util::SmallFunction<void(const Interest&, Data&)> OnData;
 
 /**
  * @brief Callback called when expressed Interest times out
  */
-typedef function<void(const Interest&)> OnTimeout;
+typedef util::SmallFunction<void(const Interest&)> OnTimeout;
 
 /**
  * @brief Callback called when incoming Interest matches the specified InterestFilter
  */
-typedef function<void (const InterestFilter&, const Interest&)> OnInterest;
+typedef util::SmallFunction<void(const InterestFilter&, const Interest&)> OnInterest;
 
 /**
  * @brief Callback called when registerPrefix or setInterestFilter command succeeds
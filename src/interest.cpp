@@ -37,6 +37,7 @@ Interest::Interest()
   : m_scope(-1)
   , m_interestLifetime(time::milliseconds::min())
   , m_selectedDelegationIndex(INVALID_SELECTED_DELEGATION_INDEX)
+  , m_lazyFields(0)
 {
 }
 
@@ -45,6 +46,7 @@ Interest::Interest(const Name& name)
   , m_scope(-1)
   , m_interestLifetime(time::milliseconds::min())
   , m_selectedDelegationIndex(INVALID_SELECTED_DELEGATION_INDEX)
+  , m_lazyFields(0)
 {
 }
 
@@ -53,6 +55,7 @@ Interest::Interest(const Name& name, const time::milliseconds& interestLifetime)
   , m_scope(-1)
   , m_interestLifetime(interestLifetime)
   , m_selectedDelegationIndex(INVALID_SELECTED_DELEGATION_INDEX)
+  , m_lazyFields(0)
 {
 }
 
@@ -66,6 +69,7 @@ Interest::Interest(const Name& name,
   , m_scope(scope)
   , m_interestLifetime(interestLifetime)
   , m_selectedDelegationIndex(INVALID_SELECTED_DELEGATION_INDEX)
+  , m_lazyFields(0)
 {
   if (nonce > 0) {
     setNonce(nonce);
@@ -73,6 +77,7 @@ Interest::Interest(const Name& name,
 }
 
 Interest::Interest(const Block& wire)
+  : m_lazyFields(0)
 {
   wireDecode(wire);
 }
@@ -101,7 +106,7 @@ Interest::setNonce(uint32_t nonce)
     m_nonce = dataBlock(tlv::Nonce,
                         reinterpret_cast<const uint8_t*>(&nonce),
                         sizeof(nonce));
-    m_wire.reset();
+    this->resetWire();
   }
   return *this;
 }
@@ -123,25 +128,25 @@ Interest::refreshNonce()
 bool
 Interest::matchesName(const Name& name) const
 {
-  if (name.size() < m_name.size())
+  if (name.size() < getName().size())
     return false;
 
-  if (!m_name.isPrefixOf(name))
+  if (!getName().isPrefixOf(name))
     return false;
 
   if (getMinSuffixComponents() >= 0 &&
       // name must include implicit digest
-      !(name.size() - m_name.size() >= static_cast<size_t>(getMinSuffixComponents())))
+      !(name.size() - getName().size() >= static_cast<size_t>(getMinSuffixComponents())))
     return false;
 
   if (getMaxSuffixComponents() >= 0 &&
       // name must include implicit digest
-      !(name.size() - m_name.size() <= static_cast<size_t>(getMaxSuffixComponents())))
+      !(name.size() - getName().size() <= static_cast<size_t>(getMaxSuffixComponents())))
     return false;
 
   if (!getExclude().empty() &&
-      name.size() > m_name.size() &&
-      getExclude().isExcluded(name[m_name.size()]))
+      name.size() > getName().size() &&
+      getExclude().isExcluded(name[getName().size()]))
     return false;
 
   return true;
@@ -150,7 +155,7 @@ Interest::matchesName(const Name& name) const
 bool
 Interest::matchesData(const Data& data) const
 {
-  size_t interestNameLength = m_name.size();
+  size_t interestNameLength = getName().size();
   const Name& dataName = data.getName();
   size_t fullNameLength = dataName.size() + 1;
 
@@ -169,8 +174,8 @@ Interest::matchesData(const Data& data) const
 
   // check prefix
   if (interestNameLength == fullNameLength) {
-    if (m_name.get(-1).isImplicitSha256Digest()) {
-      if (m_name != data.getFullName())
+    if (getName().get(-1).isImplicitSha256Digest()) {
+      if (getName() != data.getFullName())
         return false;
     }
     else {
@@ -181,7 +186,7 @@ Interest::matchesData(const Data& data) const
   }
   else {
     // Interest Name is a strict prefix of Data full Name
-    if (!m_name.isPrefixOf(dataName))
+    if (!getName().isPrefixOf(dataName))
       return false;
   }
 
@@ -320,6 +325,14 @@ Interest::wireEncode() const
 void
 Interest::wireDecode(const Block& wire)
 {
+  wireDecodeLazily(wire);
+  decodeLazyFields(m_lazyFields);
+}
+
+void
+Interest::wireDecodeLazily(const Block& wire)
+{
+  m_lazyFields = 0;
   m_wire = wire;
   m_wire.parse();
 
@@ -335,17 +348,11 @@ Interest::wireDecode(const Block& wire)
   if (m_wire.type() != tlv::Interest)
     throw Error("Unexpected TLV number when decoding Interest");
 
-  // Name
-  m_name.wireDecode(m_wire.get(tlv::Name));
+  // Name and Selectors are decoded on demand, only the presence of Name is checked here
+  m_wire.get(tlv::Name);
+  m_lazyFields = LAZY_NAME | LAZY_SELECTORS;
 
-  // Selectors
-  Block::element_const_iterator val = m_wire.find(tlv::Selectors);
-  if (val != m_wire.elements_end())
-    {
-      m_selectors.wireDecode(*val);
-    }
-  else
-    m_selectors = Selectors();
+  Block::element_const_iterator val;
 
   // Nonce
   m_nonce = m_wire.get(tlv::Nonce);
@@ -393,6 +400,39 @@ Interest::wireDecode(const Block& wire)
   }
 }
 
+void
+Interest::decodeLazyFields(uint8_t fields) const
+{
+  Interest* self = const_cast<Interest*>(this);
+  fields &= m_lazyFields;
+
+  if ((fields & LAZY_NAME) != 0) {
+    self->m_name.wireDecode(m_wire.get(tlv::Name));
+    m_lazyFields &= ~LAZY_NAME;
+  }
+
+  if ((fields & LAZY_SELECTORS) != 0) {
+    Block::element_const_iterator val = m_wire.find(tlv::Selectors);
+    if (val != m_wire.elements_end()) {
+      self->m_selectors.wireDecode(*val);
+    }
+    else {
+      self->m_selectors = Selectors();
+    }
+    m_lazyFields &= ~LAZY_SELECTORS;
+  }
+}
+
+void
+Interest::resetWire()
+{
+  // deferred fields cannot be decoded once the wire encoding is gone
+  if (m_lazyFields != 0)
+    decodeLazyFields(m_lazyFields);
+
+  m_wire.reset();
+}
+
 bool
 Interest::hasLink() const
 {
@@ -418,7 +458,7 @@ Interest::setLink(const Block& link)
   if (!link.hasWire()) {
     throw Error("The given link does not have a wire format");
   }
-  m_wire.reset();
+  this->resetWire();
   this->unsetSelectedDelegation();
 }
 
@@ -426,7 +466,7 @@ void
 Interest::unsetLink()
 {
   m_link.reset();
-  m_wire.reset();
+  this->resetWire();
   this->unsetSelectedDelegation();
 }
 
@@ -459,7 +499,7 @@ Interest::setSelectedDelegation(const Name& delegationName)
   else {
     throw std::invalid_argument("Invalid selected delegation name");
   }
-  m_wire.reset();
+  this->resetWire();
 }
 
 void
@@ -469,14 +509,14 @@ Interest::setSelectedDelegation(size_t delegationIndex)
     throw Error("Invalid selected delegation index");
   }
   m_selectedDelegationIndex = delegationIndex;
-  m_wire.reset();
+  this->resetWire();
 }
 
 void
 Interest::unsetSelectedDelegation()
 {
   m_selectedDelegationIndex = INVALID_SELECTED_DELEGATION_INDEX;
-  m_wire.reset();
+  this->resetWire();
 }
 
 std::ostream&
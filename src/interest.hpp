@@ -113,6 +113,22 @@ public:
   void
   wireDecode(const Block& wire);
 
+  /**
+   * @brief Decode from the wire format, deferring decoding of Name and Selectors
+   *
+   * Name and Selectors are decoded from the retained wire encoding when first accessed,
+   * so that an application which only needs the Name (e.g., to dispatch or forward the
+   * packet) does not pay for decoding of the Selectors, and one that only forwards the
+   * packet as is does not pay for decoding of either.
+   *
+   * @throw tlv::Error if the outer TLV or any other field is malformed
+   * @note An error in a deferred field is reported (as tlv::Error) when that field is accessed.
+   * @note Access to a deferred field modifies the object, therefore concurrent access to a
+   *       lazily decoded Interest from several threads is unsafe even through const methods.
+   */
+  void
+  wireDecodeLazily(const Block& wire);
+
   /**
    * @brief Check if already has wire
    */
@@ -225,14 +241,16 @@ public: // Name and guiders
   const Name&
   getName() const
   {
+    if ((m_lazyFields & LAZY_NAME) != 0)
+      decodeLazyFields(LAZY_NAME);
     return m_name;
   }
 
   Interest&
   setName(const Name& name)
   {
+    this->resetWire();
     m_name = name;
-    m_wire.reset();
     return *this;
   }
 
@@ -245,8 +263,8 @@ public: // Name and guiders
   Interest&
   setScope(int scope)
   {
+    this->resetWire();
     m_scope = scope;
-    m_wire.reset();
     return *this;
   }
 
@@ -259,8 +277,8 @@ public: // Name and guiders
   Interest&
   setInterestLifetime(const time::milliseconds& interestLifetime)
   {
+    this->resetWire();
     m_interestLifetime = interestLifetime;
-    m_wire.reset();
     return *this;
   }
 
@@ -345,104 +363,106 @@ public: // Selectors
   bool
   hasSelectors() const
   {
-    return !m_selectors.empty();
+    return !getSelectors().empty();
   }
 
   const Selectors&
   getSelectors() const
   {
+    if ((m_lazyFields & LAZY_SELECTORS) != 0)
+      decodeLazyFields(LAZY_SELECTORS);
     return m_selectors;
   }
 
   Interest&
   setSelectors(const Selectors& selectors)
   {
+    this->resetWire();
     m_selectors = selectors;
-    m_wire.reset();
     return *this;
   }
 
   int
   getMinSuffixComponents() const
   {
-    return m_selectors.getMinSuffixComponents();
+    return getSelectors().getMinSuffixComponents();
   }
 
   Interest&
   setMinSuffixComponents(int minSuffixComponents)
   {
+    this->resetWire();
     m_selectors.setMinSuffixComponents(minSuffixComponents);
-    m_wire.reset();
     return *this;
   }
 
   int
   getMaxSuffixComponents() const
   {
-    return m_selectors.getMaxSuffixComponents();
+    return getSelectors().getMaxSuffixComponents();
   }
 
   Interest&
   setMaxSuffixComponents(int maxSuffixComponents)
   {
+    this->resetWire();
     m_selectors.setMaxSuffixComponents(maxSuffixComponents);
-    m_wire.reset();
     return *this;
   }
 
   const KeyLocator&
   getPublisherPublicKeyLocator() const
   {
-    return m_selectors.getPublisherPublicKeyLocator();
+    return getSelectors().getPublisherPublicKeyLocator();
   }
 
   Interest&
   setPublisherPublicKeyLocator(const KeyLocator& keyLocator)
   {
+    this->resetWire();
     m_selectors.setPublisherPublicKeyLocator(keyLocator);
-    m_wire.reset();
     return *this;
   }
 
   const Exclude&
   getExclude() const
   {
-    return m_selectors.getExclude();
+    return getSelectors().getExclude();
   }
 
   Interest&
   setExclude(const Exclude& exclude)
   {
+    this->resetWire();
     m_selectors.setExclude(exclude);
-    m_wire.reset();
     return *this;
   }
 
   int
   getChildSelector() const
   {
-    return m_selectors.getChildSelector();
+    return getSelectors().getChildSelector();
   }
 
   Interest&
   setChildSelector(int childSelector)
   {
+    this->resetWire();
     m_selectors.setChildSelector(childSelector);
-    m_wire.reset();
     return *this;
   }
 
   int
   getMustBeFresh() const
   {
-    return m_selectors.getMustBeFresh();
+    return getSelectors().getMustBeFresh();
   }
 
   Interest&
   setMustBeFresh(bool mustBeFresh)
   {
+    this->resetWire();
     m_selectors.setMustBeFresh(mustBeFresh);
-    m_wire.reset();
     return *this;
   }
 
@@ -459,6 +479,24 @@ public: // EqualityComparable concept
     return !(*this == other);
   }
 
+private:
+  enum {
+    LAZY_NAME      = 1 << 0,
+    LAZY_SELECTORS = 1 << 1
+  };
+
+  /**
+   * @brief Decode those of @p fields that have been deferred by wireDecodeLazily
+   */
+  void
+  decodeLazyFields(uint8_t fields) const;
+
+  /**
+   * @brief Clear the wire encoding, after decoding any deferred field out of it
+   */
+  void
+  resetWire();
+
 private:
   Name m_name;
   Selectors m_selectors;
@@ -469,6 +507,7 @@ private:
   mutable Block m_link;
   size_t m_selectedDelegationIndex;
   mutable Block m_wire;
+  mutable uint8_t m_lazyFields;
 
   nfd::LocalControlHeader m_localControlHeader;
   friend class nfd::LocalControlHeader;
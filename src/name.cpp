@@ -33,6 +33,8 @@
 
 #include <boost/functional/hash.hpp>
 
+#include <algorithm>
+
 namespace ndn {
 
 BOOST_CONCEPT_ASSERT((boost::EqualityComparable<Name>));
@@ -64,6 +66,19 @@ Name::Name(const std::string& uri)
   construct(uri.c_str());
 }
 
+Name::Name(const Name& other)
+  : m_nameBlock(other.m_nameBlock)
+{
+}
+
+Name&
+Name::operator=(const Name& other)
+{
+  m_nameBlock = other.m_nameBlock;
+  m_prefixHashes.reset();
+  return *this;
+}
+
 template<encoding::Tag TAG>
 size_t
 Name::wireEncode(EncodingImpl<TAG>& encoder) const
@@ -112,6 +127,7 @@ Name::wireDecode(const Block& wire)
 
   m_nameBlock = wire;
   m_nameBlock.parse();
+  m_prefixHashes.reset();
 }
 
 void
@@ -203,21 +219,21 @@ Name::append(const Name& name)
 Name&
 Name::appendNumber(uint64_t number)
 {
-  m_nameBlock.push_back(Component::fromNumber(number));
+  this->appendComponent(Component::fromNumber(number));
   return *this;
 }
 
 Name&
 Name::appendNumberWithMarker(uint8_t marker, uint64_t number)
 {
-  m_nameBlock.push_back(Component::fromNumberWithMarker(marker, number));
+  this->appendComponent(Component::fromNumberWithMarker(marker, number));
   return *this;
 }
 
 Name&
 Name::appendVersion(uint64_t version)
 {
-  m_nameBlock.push_back(Component::fromVersion(version));
+  this->appendComponent(Component::fromVersion(version));
   return *this;
 }
 
@@ -231,42 +247,42 @@ Name::appendVersion()
 Name&
 Name::appendSegment(uint64_t segmentNo)
 {
-  m_nameBlock.push_back(Component::fromSegment(segmentNo));
+  this->appendComponent(Component::fromSegment(segmentNo));
   return *this;
 }
 
 Name&
 Name::appendSegmentOffset(uint64_t offset)
 {
-  m_nameBlock.push_back(Component::fromSegmentOffset(offset));
+  this->appendComponent(Component::fromSegmentOffset(offset));
   return *this;
 }
 
 Name&
 Name::appendTimestamp(const time::system_clock::TimePoint& timePoint)
 {
-  m_nameBlock.push_back(Component::fromTimestamp(timePoint));
+  this->appendComponent(Component::fromTimestamp(timePoint));
   return *this;
 }
 
 Name&
 Name::appendSequenceNumber(uint64_t seqNo)
 {
-  m_nameBlock.push_back(Component::fromSequenceNumber(seqNo));
+  this->appendComponent(Component::fromSequenceNumber(seqNo));
   return *this;
 }
 
 Name&
 Name::appendImplicitSha256Digest(const ConstBufferPtr& digest)
 {
-  m_nameBlock.push_back(Component::fromImplicitSha256Digest(digest));
+  this->appendComponent(Component::fromImplicitSha256Digest(digest));
   return *this;
 }
 
 Name&
 Name::appendImplicitSha256Digest(const uint8_t* digest, size_t digestSize)
 {
-  m_nameBlock.push_back(Component::fromImplicitSha256Digest(digest, digestSize));
+  this->appendComponent(Component::fromImplicitSha256Digest(digest, digestSize));
   return *this;
 }
 
@@ -298,13 +314,119 @@ Name::getSuccessor() const
   return getPrefix(-1).append(get(-1).getSuccessor());
 }
 
+/** @brief find the first differing octet of two wire encodings
+ *  @return offset of the first differing octet, or the length of the shorter encoding
+ *
+ *  The encodings are compared with memcmp first, and a word at a time if they differ.
+ */
+static size_t
+findFirstDifference(const uint8_t* first1, size_t size1, const uint8_t* first2, size_t size2)
+{
+  size_t length = std::min(size1, size2);
+  if (std::memcmp(first1, first2, length) == 0)
+    return length;
+
+  size_t offset = 0;
+  for (; offset + sizeof(uint64_t) <= length; offset += sizeof(uint64_t)) {
+    uint64_t word1, word2;
+    std::memcpy(&word1, first1 + offset, sizeof(word1));
+    std::memcpy(&word2, first2 + offset, sizeof(word2));
+    if (word1 != word2)
+      break;
+  }
+  while (first1[offset] == first2[offset])
+    ++offset;
+  return offset;
+}
+
+/** @brief count components whose wire encoding lies entirely within [first, first + length)
+ *  @param first beginning of concatenated component TLVs
+ *  @param last end of concatenated component TLVs
+ */
+static size_t
+countComponentsWithin(const uint8_t* first, const uint8_t* last, size_t length)
+{
+  const uint8_t* end = first + length;
+  size_t nComponents = 0;
+  while (first < end) {
+    uint64_t type = 0, valueLength = 0;
+    if (!tlv::readVarNumber(first, last, type) || !tlv::readVarNumber(first, last, valueLength) ||
+        first > end || valueLength > static_cast<uint64_t>(end - first))
+      break;
+    first += valueLength;
+    ++nComponents;
+  }
+  return nComponents;
+}
+
+size_t
+Name::countIdenticalPrefixComponents(const Name& other) const
+{
+  if (!m_nameBlock.hasWire() || !other.m_nameBlock.hasWire())
+    return 0;
+
+  // Components with identical wire encodings are equal, so only the components from the
+  // first differing octet onwards need to be compared individually
+  const uint8_t* value = m_nameBlock.value();
+  size_t valueSize = m_nameBlock.value_size();
+  size_t otherValueSize = other.m_nameBlock.value_size();
+  size_t offset = findFirstDifference(value, valueSize, other.m_nameBlock.value(), otherValueSize);
+
+  if (offset == valueSize)
+    return size();
+  if (offset == otherValueSize)
+    return other.size();
+
+  // components of a decoded Name are slices of its wire encoding, so the component containing
+  // the differing octet is found with a binary search; otherwise component TLVs are walked
+  const Block::element_container& components = m_nameBlock.elements();
+  const uint8_t* difference = value + offset;
+  if (!components.empty() &&
+      components.front().hasWire() && components.front().wire() == value &&
+      components.back().hasWire() &&
+      components.back().wire() + components.back().size() == value + valueSize) {
+    return std::partition_point(components.begin(), components.end(),
+                                [difference] (const Block& component) {
+                                  return component.wire() + component.size() <= difference;
+                                }) - components.begin();
+  }
+  return countComponentsWithin(value, value + valueSize, offset);
+}
+
+size_t
+Name::getPrefixHash(size_t nComponents) const
+{
+  BOOST_ASSERT(nComponents <= size());
+
+  shared_ptr<const std::vector<size_t>> prefixHashes = std::atomic_load(&m_prefixHashes);
+  if (prefixHashes == nullptr) {
+    // every component of an encoded Name has wire encoding, which is what gets hashed
+    const Block& wire = wireEncode();
+
+    auto computed = make_shared<std::vector<size_t>>();
+    computed->reserve(wire.elements_size() + 1);
+    size_t hash = 0;
+    computed->push_back(hash);
+    for (const Block& component : wire.elements()) {
+      boost::hash_combine(hash, boost::hash_range(component.wire(),
+                                                  component.wire() + component.size()));
+      computed->push_back(hash);
+    }
+
+    prefixHashes = computed;
+    std::atomic_store(&m_prefixHashes, prefixHashes);
+  }
+
+  return (*prefixHashes)[nComponents];
+}
+
 bool
 Name::equals(const Name& name) const
 {
   if (size() != name.size())
     return false;
 
-  for (size_t i = 0; i < size(); ++i) {
+  for (size_t i = countIdenticalPrefixComponents(name); i < size(); ++i) {
     if (at(i) != name.at(i))
       return false;
   }
@@ -320,7 +442,7 @@ Name::isPrefixOf(const Name& name) const
     return false;
 
   // Check if at least one of given components doesn't match.
-  for (size_t i = 0; i < size(); ++i) {
+  for (size_t i = countIdenticalPrefixComponents(name); i < size(); ++i) {
     if (at(i) != name.at(i))
       return false;
   }
@@ -335,7 +457,12 @@ Name::compare(size_t pos1, size_t count1, const Name& other, size_t pos2, size_t
   count2 = std::min(count2, other.size() - pos2);
   size_t count = std::min(count1, count2);
 
-  for (size_t i = 0; i < count; ++i) {
+  size_t i = 0;
+  if (pos1 == 0 && pos2 == 0) {
+    i = std::min(count, countIdenticalPrefixComponents(other));
+  }
+
+  for (; i < count; ++i) {
     int comp = this->at(pos1 + i).compare(other.at(pos2 + i));
     if (comp != 0) { // i-th component differs
       return comp;
@@ -378,8 +505,7 @@ namespace std {
 size_t
 hash<ndn::Name>::operator()(const ndn::Name& name) const
 {
-  return boost::hash_range(name.wireEncode().wire(),
-                           name.wireEncode().wire() + name.wireEncode().size());
+  return name.getPrefixHash(name.size());
 }
 
 } // namespace std
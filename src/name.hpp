@@ -98,6 +98,22 @@ public:
    */
   Name(const std::string& uri);
 
+  /**
+   * @brief Copy @p other, without its cached prefix hashes
+   *
+   * The copy computes prefix hashes upon its first getPrefixHash, so that copying neither reads
+   * the cache of @p other, which may be written on another thread, nor pays for atomic access.
+   */
+  Name(const Name& other);
+
+  Name(Name&& other) = default;
+
+  Name&
+  operator=(const Name& other);
+
+  Name&
+  operator=(Name&& other) = default;
+
   /**
    * @brief Fast encoding or block size estimation
    */
@@ -138,7 +154,7 @@ public:
   Name&
   append(const uint8_t* value, size_t valueLength)
   {
-    m_nameBlock.push_back(Component(value, valueLength));
+    this->appendComponent(Component(value, valueLength));
     return *this;
   }
 
@@ -155,7 +171,7 @@ public:
   Name&
   append(Iterator first, Iterator last)
   {
-    m_nameBlock.push_back(Component(first, last));
+    this->appendComponent(Component(first, last));
     return *this;
   }
 
@@ -165,7 +181,7 @@ public:
   Name&
   append(const Component& value)
   {
-    m_nameBlock.push_back(value);
+    this->appendComponent(value);
     return *this;
   }
 
@@ -179,7 +195,7 @@ public:
   Name&
   append(const char* value)
   {
-    m_nameBlock.push_back(Component(value));
+    this->appendComponent(Component(value));
     return *this;
   }
 
@@ -187,9 +203,9 @@ public:
   append(const Block& value)
   {
     if (value.type() == tlv::NameComponent)
-      m_nameBlock.push_back(value);
+      this->appendComponent(value);
     else
-      m_nameBlock.push_back(Block(tlv::NameComponent, value));
+      this->appendComponent(Block(tlv::NameComponent, value));
 
     return *this;
   }
@@ -209,6 +225,7 @@ public:
   clear()
   {
     m_nameBlock = Block(tlv::Name);
+    m_prefixHashes.reset();
   }
 
   /**
@@ -360,6 +377,22 @@ public:
   bool
   equals(const Name& name) const;
 
+  /**
+   * @brief Get hash of the first @p nComponents components of this name
+   *
+   * The returned value equals std::hash<Name>()(getPrefix(nComponents)).  Hashes of all prefixes
+   * are computed together upon first use and cached until the name is modified, so that looking
+   * up every prefix of a name in a hash table costs O(size()) rather than O(size()^2) hashing.
+   *
+   * The cache is published with std::atomic_store, so several threads may hash the same const
+   * Name concurrently, provided that it has wire encoding.  Two threads hashing it for the first
+   * time may both compute the hashes; either result is kept.
+   *
+   * @pre nComponents <= size()
+   */
+  size_t
+  getPrefixHash(size_t nComponents) const;
+
   /**
    * @brief Check if the N components of this name are the same as the first N components
    *        of the given name.
@@ -367,6 +400,9 @@ public:
    * @param name The Name to check.
    * @return true if this matches the given name, otherwise false.  This always returns
    *              true if this name is empty.
+   * @note When both names have wire encoding, as decoded names do, the components are
+   *       compared over the wire octets and inspected individually only after a difference.
+   *       The same applies to equals and compare.
    */
   bool
   isPrefixOf(const Name& name) const;
@@ -597,8 +633,29 @@ public:
    */
   static const size_t npos;
 
+private:
+  void
+  appendComponent(const Block& component)
+  {
+    m_nameBlock.push_back(component);
+    m_prefixHashes.reset();
+  }
+
+  /** @brief number of leading components that are identical on the wire in both names
+   *  @return 0 unless both names have wire encoding
+   */
+  size_t
+  countIdenticalPrefixComponents(const Name& other) const;
+
 private:
   mutable Block m_nameBlock;
+
+  /** @brief hashes of prefixes of size 0 to size(), computed upon first getPrefixHash
+   *
+   *  Accessed with std::atomic_load and std::atomic_store from getPrefixHash, which may be
+   *  called on several threads at once.  Copies of a Name do not share the cache.
+   */
+  mutable shared_ptr<const std::vector<size_t>> m_prefixHashes;
 };
 
 std::ostream&
@@ -643,11 +643,11 @@ KeyChain::signWithSha256(Data& data)
   DigestSha256 sig;
   data.setSignature(sig);
 
-  Block sigValue(tlv::SignatureValue,
-                 crypto::sha256(data.wireEncode().value(),
-                                data.wireEncode().value_size() -
-                                data.getSignature().getValue().size()));
-  data.setSignatureValue(sigValue);
+  EncodingBuffer encoder;
+  data.wireEncode(encoder, true);
+
+  Block sigValue(tlv::SignatureValue, crypto::sha256(encoder.buf(), encoder.size()));
+  data.wireEncode(encoder, sigValue);
 }
 
 void
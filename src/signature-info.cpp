@@ -150,6 +150,7 @@ SignatureInfo::wireEncode() const
   wireEncode(buffer);
 
   m_wire = buffer.block();
+  m_wire.parse();
   return m_wire;
 }
 
@@ -24,7 +24,7 @@
 
 #include "transport.hpp"
 
-#include <list>
+#include <vector>
 
 namespace ndn {
 
@@ -34,13 +34,33 @@ class StreamTransportImpl
 public:
   typedef StreamTransportImpl<BaseTransport,Protocol> Impl;
 
-  typedef std::list<Block> BlockSequence;
-  typedef std::list<BlockSequence> TransmissionQueue;
+  /** \brief Blocks waiting to be written
+   *
+   *  Blocks before m_transmissionQueueHead have been written; the queue is emptied (keeping its
+   *  capacity) when all Blocks are written, so steady-state sending does not allocate.
+   */
+  typedef std::vector<Block> TransmissionQueue;
+
+  /** \brief size of a receive chunk in zero-copy receive mode
+   */
+  static const size_t RECEIVE_CHUNK_SIZE = 8 * MAX_NDN_PACKET_SIZE;
+
+  /** \brief maximum number of spare receive chunks kept for reuse in zero-copy receive mode
+   */
+  static const size_t RECEIVE_CHUNK_POOL_SIZE = 4;
 
   StreamTransportImpl(BaseTransport& transport, boost::asio::io_service& ioService)
     : m_transport(transport)
     , m_socket(ioService)
     , m_inputBufferSize(0)
+    , m_isZeroCopyReceive(false)
+    , m_chunkBegin(0)
+    , m_chunkEnd(0)
+#ifdef NDN_CXX_HAVE_TESTS
+    , m_nReceiveCopiedBytes(0)
+#endif
+    , m_transmissionQueueHead(0)
+    , m_nBlocksInFlight(0)
     , m_connectionInProgress(false)
     , m_connectTimer(ioService)
   {
@@ -58,9 +78,7 @@ public:
         m_transport.m_isConnected = true;
 
         if (!m_transmissionQueue.empty()) {
-          boost::asio::async_write(m_socket, *m_transmissionQueue.begin(),
-                                   bind(&Impl::handleAsyncWrite, this, _1,
-                                        m_transmissionQueue.begin()));
+          asyncWriteBatch();
         }
       }
     else
@@ -112,6 +130,8 @@ public:
     m_transport.m_isConnected = false;
     m_transport.m_isExpectingData = false;
     m_transmissionQueue.clear();
+    m_transmissionQueueHead = 0;
+    m_nBlocksInFlight = 0;
   }
 
   void
@@ -137,49 +157,86 @@ public:
       {
         m_transport.m_isExpectingData = true;
         m_inputBufferSize = 0;
+
+        m_isZeroCopyReceive = m_transport.m_isZeroCopyReceiveEnabled;
+        if (m_isZeroCopyReceive) {
+          m_chunk = allocateChunk();
+          m_chunkBegin = m_chunkEnd = 0;
+          asyncReceiveChunk();
+          return;
+        }
+
         m_socket.async_receive(boost::asio::buffer(m_inputBuffer, MAX_NDN_PACKET_SIZE), 0,
                                bind(&Impl::handleAsyncReceive, this, _1, _2));
       }
   }
 
+#ifdef NDN_CXX_HAVE_TESTS
+  /** \return number of received bytes that were copied after being read from the socket
+   *  \note only available in builds with tests
+   */
+  uint64_t
+  getNReceiveCopiedBytes() const
+  {
+    return m_nReceiveCopiedBytes;
+  }
+#endif
+
   void
   send(const Block& wire)
   {
-    BlockSequence sequence;
-    sequence.push_back(wire);
-    m_transmissionQueue.push_back(sequence);
-
-    if (m_transport.m_isConnected && m_transmissionQueue.size() == 1) {
-      boost::asio::async_write(m_socket, *m_transmissionQueue.begin(),
-                               bind(&Impl::handleAsyncWrite, this, _1,
-                                    m_transmissionQueue.begin()));
+    m_transmissionQueue.push_back(wire);
+
+    if (m_transport.m_isConnected && m_nBlocksInFlight == 0) {
+      asyncWriteBatch();
     }
 
-    // if not connected or there is transmission in progress (m_transmissionQueue.size() > 1),
-    // next write will be scheduled either in connectHandler or in asyncWriteHandler
+    // if not connected or there is transmission in progress, the Block will be written
+    // as part of a batch scheduled either in connectHandler or in handleAsyncWrite
   }
 
   void
   send(const Block& header, const Block& payload)
   {
-    BlockSequence sequence;
-    sequence.push_back(header);
-    sequence.push_back(payload);
-    m_transmissionQueue.push_back(sequence);
-
-    if (m_transport.m_isConnected && m_transmissionQueue.size() == 1) {
-      boost::asio::async_write(m_socket, *m_transmissionQueue.begin(),
-                               bind(&Impl::handleAsyncWrite, this, _1,
-                                    m_transmissionQueue.begin()));
+    m_transmissionQueue.push_back(header);
+    m_transmissionQueue.push_back(payload);
+
+    if (m_transport.m_isConnected && m_nBlocksInFlight == 0) {
+      asyncWriteBatch();
     }
 
-    // if not connected or there is transmission in progress (m_transmissionQueue.size() > 1),
-    // next write will be scheduled either in connectHandler or in asyncWriteHandler
+    // if not connected or there is transmission in progress, the Blocks will be written
+    // as part of a batch scheduled either in connectHandler or in handleAsyncWrite
   }
 
+  /** \brief write queued Blocks with a single gather write, within the transport batch limits
+   */
   void
-  handleAsyncWrite(const boost::system::error_code& error,
-                   TransmissionQueue::iterator queueItem)
+  asyncWriteBatch()
+  {
+    BOOST_ASSERT(m_nBlocksInFlight == 0);
+    BOOST_ASSERT(m_transmissionQueueHead < m_transmissionQueue.size());
+
+    m_writeBuffers.clear();
+    size_t nBytes = 0;
+    for (size_t i = m_transmissionQueueHead; i < m_transmissionQueue.size(); ++i) {
+      const Block& block = m_transmissionQueue[i];
+      if (!m_writeBuffers.empty() &&
+          (m_writeBuffers.size() >= m_transport.m_sendBatchMaxBlocks ||
+           nBytes + block.size() > m_transport.m_sendBatchMaxBytes))
+        break;
+
+      m_writeBuffers.push_back(boost::asio::buffer(block.wire(), block.size()));
+      nBytes += block.size();
+    }
+
+    m_nBlocksInFlight = m_writeBuffers.size();
+    boost::asio::async_write(m_socket, m_writeBuffers,
+                             bind(&Impl::handleAsyncWrite, this, _1));
+  }
+
+  void
+  handleAsyncWrite(const boost::system::error_code& error)
   {
     if (error)
       {
@@ -192,13 +249,23 @@ public:
         throw Transport::Error(error, "error while sending data to socket");
       }
 
-    m_transmissionQueue.erase(queueItem);
+    m_transmissionQueueHead += m_nBlocksInFlight;
+    m_nBlocksInFlight = 0;
 
-    if (!m_transmissionQueue.empty()) {
-      boost::asio::async_write(m_socket, *m_transmissionQueue.begin(),
-                               bind(&Impl::handleAsyncWrite, this, _1,
-                                    m_transmissionQueue.begin()));
+    if (m_transmissionQueueHead == m_transmissionQueue.size()) {
+      m_transmissionQueue.clear();
+      m_transmissionQueueHead = 0;
+      return;
     }
+
+    if (m_transmissionQueueHead > m_transmissionQueue.size() / 2) {
+      // drop written Blocks once they make up most of the queue
+      m_transmissionQueue.erase(m_transmissionQueue.begin(),
+                                m_transmissionQueue.begin() + m_transmissionQueueHead);
+      m_transmissionQueueHead = 0;
+    }
+
+    asyncWriteBatch();
   }
 
   bool
@@ -211,6 +278,7 @@ public:
       if (!isOk)
         return false;
 
+      countReceiveCopiedBytes(element.size());
       m_transport.receive(element);
       offset += element.size();
     }
@@ -250,6 +318,7 @@ public:
             std::copy(m_inputBuffer + offset, m_inputBuffer + m_inputBufferSize,
                       m_inputBuffer);
             m_inputBufferSize -= offset;
+            countReceiveCopiedBytes(m_inputBufferSize);
           }
         else
           {
@@ -257,11 +326,152 @@ public:
           }
       }
 
+    if (!m_transport.m_isExpectingData) {
+      // paused or closed by a receive callback, which could not cancel this receive operation
+      return;
+    }
+
     m_socket.async_receive(boost::asio::buffer(m_inputBuffer + m_inputBufferSize,
                                                MAX_NDN_PACKET_SIZE - m_inputBufferSize), 0,
                            bind(&Impl::handleAsyncReceive, this, _1, _2));
   }
 
+  /** \brief deliver all complete TLV elements in the current receive chunk
+   *
+   *  Delivered Blocks share ownership of the chunk; no bytes are copied.
+   */
+  void
+  processChunk()
+  {
+    const Buffer& chunk = *m_chunk;
+    while (m_chunkBegin < m_chunkEnd) {
+      Buffer::const_iterator begin = chunk.begin() + m_chunkBegin;
+      Buffer::const_iterator end = chunk.begin() + m_chunkEnd;
+      Buffer::const_iterator valueBegin = begin;
+
+      uint32_t type = 0;
+      uint64_t length = 0;
+      if (!tlv::readType(valueBegin, end, type) ||
+          !tlv::readVarNumber(valueBegin, end, length))
+        return;
+
+      // a chunk can hold a complete element that would not fit in the copying input buffer
+      if (length > MAX_NDN_PACKET_SIZE - static_cast<uint64_t>(valueBegin - begin))
+        {
+          m_transport.close();
+          throw Transport::Error(boost::system::error_code(),
+                                 "TLV element exceeds the maximum packet size");
+        }
+
+      if (length > static_cast<uint64_t>(end - valueBegin))
+        return;
+
+      Buffer::const_iterator valueEnd = valueBegin + length;
+      Block element(m_chunk, type, begin, valueEnd, valueBegin, valueEnd);
+      m_chunkBegin += element.size();
+      m_transport.receive(element);
+    }
+  }
+
+  void
+  handleAsyncReceiveChunk(const boost::system::error_code& error, std::size_t nBytesRecvd)
+  {
+    if (error)
+      {
+        if (error == boost::system::errc::operation_canceled) {
+          // async receive has been explicitly cancelled (e.g., socket close)
+          return;
+        }
+
+        m_transport.close();
+        throw Transport::Error(error, "error while receiving data from socket");
+      }
+
+    m_chunkEnd += nBytesRecvd;
+    processChunk();
+
+    if (m_chunkEnd - m_chunkBegin >= MAX_NDN_PACKET_SIZE)
+      {
+        m_transport.close();
+        throw Transport::Error(boost::system::error_code(),
+                               "input buffer full, but a valid TLV cannot be decoded");
+      }
+
+    if (!m_transport.m_isExpectingData) {
+      // paused or closed by a receive callback, which could not cancel this receive operation
+      return;
+    }
+
+    if (m_chunk->size() - m_chunkBegin < MAX_NDN_PACKET_SIZE)
+      {
+        // not enough room to complete the largest possible packet
+        refillChunk();
+      }
+
+    asyncReceiveChunk();
+  }
+
+  void
+  asyncReceiveChunk()
+  {
+    m_socket.async_receive(boost::asio::buffer(m_chunk->buf() + m_chunkEnd,
+                                               m_chunk->size() - m_chunkEnd), 0,
+                           bind(&Impl::handleAsyncReceiveChunk, this, _1, _2));
+  }
+
+  /** \brief continue receiving into a chunk that has enough room for a maximum size packet
+   *
+   *  Only the bytes of an incomplete packet at the end of current chunk are copied.  If no
+   *  delivered Block refers to the current chunk anymore, it is compacted in place.
+   */
+  void
+  refillChunk()
+  {
+    size_t nPending = m_chunkEnd - m_chunkBegin;
+
+    if (m_chunk.unique()) {
+      std::copy(m_chunk->begin() + m_chunkBegin, m_chunk->begin() + m_chunkEnd,
+                m_chunk->begin());
+    }
+    else {
+      BufferPtr next = allocateChunk();
+      std::copy(m_chunk->begin() + m_chunkBegin, m_chunk->begin() + m_chunkEnd,
+                next->begin());
+
+      if (m_chunkPool.size() < RECEIVE_CHUNK_POOL_SIZE) {
+        // chunk becomes reusable after all Blocks referring to it are released
+        m_chunkPool.push_back(m_chunk);
+      }
+      m_chunk = next;
+    }
+
+    countReceiveCopiedBytes(nPending);
+    m_chunkBegin = 0;
+    m_chunkEnd = nPending;
+  }
+
+  void
+  countReceiveCopiedBytes(size_t nBytes)
+  {
+#ifdef NDN_CXX_HAVE_TESTS
+    m_nReceiveCopiedBytes += nBytes;
+#endif
+  }
+
+  BufferPtr
+  allocateChunk()
+  {
+    for (auto i = m_chunkPool.begin(); i != m_chunkPool.end(); ++i) {
+      if (i->unique()) {
+        BufferPtr chunk = *i;
+        m_chunkPool.erase(i);
+        return chunk;
+      }
+    }
+
+    return make_shared<Buffer>(RECEIVE_CHUNK_SIZE);
+  }
+
 protected:
   BaseTransport& m_transport;
 
@@ -269,12 +479,30 @@ protected:
   uint8_t m_inputBuffer[MAX_NDN_PACKET_SIZE];
   size_t m_inputBufferSize;
 
+  bool m_isZeroCopyReceive;
+  BufferPtr m_chunk; ///< current receive chunk in zero-copy receive mode
+  size_t m_chunkBegin; ///< offset of the first byte not yet delivered in m_chunk
+  size_t m_chunkEnd; ///< offset past the last received byte in m_chunk
+  std::vector<BufferPtr> m_chunkPool;
+#ifdef NDN_CXX_HAVE_TESTS
+  uint64_t m_nReceiveCopiedBytes; ///< maintained only in builds with tests
+#endif
+
   TransmissionQueue m_transmissionQueue;
+  size_t m_transmissionQueueHead; ///< index of the first Block not yet written
+  size_t m_nBlocksInFlight; ///< number of Blocks in the gather write in progress
+  std::vector<boost::asio::const_buffer> m_writeBuffers;
   bool m_connectionInProgress;
 
   boost::asio::deadline_timer m_connectTimer;
 };
 
+template<class BaseTransport, class Protocol>
+const size_t StreamTransportImpl<BaseTransport, Protocol>::RECEIVE_CHUNK_SIZE;
+
+template<class BaseTransport, class Protocol>
+const size_t StreamTransportImpl<BaseTransport, Protocol>::RECEIVE_CHUNK_POOL_SIZE;
+
 
 template<class BaseTransport, class Protocol>
 class StreamTransportWithResolverImpl : public StreamTransportImpl<BaseTransport, Protocol>
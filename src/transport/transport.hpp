@@ -92,6 +92,31 @@ public:
   inline bool
   isExpectingData();
 
+  /**
+   * @brief Enable or disable zero-copy receive
+   *
+   * In zero-copy mode, a stream transport reads from the socket into pooled, reference-counted
+   * chunks, and each received Block refers directly into a chunk instead of owning a copy of
+   * its bytes.  A Block (or a packet decoded from it) that is retained by the application keeps
+   * its whole chunk alive, so this mode trades memory footprint for fewer copies.
+   *
+   * The setting takes effect the next time the transport starts receiving, i.e., on resume().
+   * Transports that are not stream-based ignore it.
+   */
+  inline void
+  setZeroCopyReceive(bool isEnabled);
+
+  /**
+   * @brief Limit how much a stream transport coalesces into a single gather write
+   *
+   * Blocks queued for sending while a previous write is in progress are handed to the socket
+   * together in one gather write.  A batch contains at least one Block, and no more than
+   * @p maxBlocks Blocks or @p maxBytes octets otherwise.  Defaults are 64 Blocks
+   * and 16 * MAX_NDN_PACKET_SIZE octets.  Transports that are not stream-based ignore it.
+   */
+  inline void
+  setSendBatchLimits(size_t maxBlocks, size_t maxBytes);
+
 protected:
   inline void
   receive(const Block& wire);
@@ -100,6 +125,9 @@ protected:
   boost::asio::io_service* m_ioService;
   bool m_isConnected;
   bool m_isExpectingData;
+  bool m_isZeroCopyReceiveEnabled;
+  size_t m_sendBatchMaxBlocks;
+  size_t m_sendBatchMaxBytes;
   ReceiveCallback m_receiveCallback;
 };
 
@@ -108,6 +136,9 @@ Transport::Transport()
   : m_ioService(0)
   , m_isConnected(false)
   , m_isExpectingData(false)
+  , m_isZeroCopyReceiveEnabled(false)
+  , m_sendBatchMaxBlocks(64)
+  , m_sendBatchMaxBytes(16 * MAX_NDN_PACKET_SIZE)
 {
 }
 
@@ -148,6 +179,19 @@ Transport::isExpectingData()
   return m_isExpectingData;
 }
 
+inline void
+Transport::setZeroCopyReceive(bool isEnabled)
+{
+  m_isZeroCopyReceiveEnabled = isEnabled;
+}
+
+inline void
+Transport::setSendBatchLimits(size_t maxBlocks, size_t maxBytes)
+{
+  m_sendBatchMaxBlocks = maxBlocks;
+  m_sendBatchMaxBytes = maxBytes;
+}
+
 inline void
 Transport::receive(const Block& wire)
 {
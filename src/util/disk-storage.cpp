@@ -0,0 +1,477 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "disk-storage.hpp"
+#include "../encoding/block-helpers.hpp"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn {
+namespace util {
+
+// TLV types of index records, which are private to the index file
+enum {
+  DiskStorageInsertion = 128,
+  DiskStorageErasure = 129,
+  DiskStorageOffset = 130,
+  DiskStorageLength = 131,
+  DiskStorageStaleTime = 132
+};
+
+/** @brief the segment file is first mapped in chunks of this size, to avoid remapping it
+ *         upon every insertion into a new storage
+ */
+static const size_t MIN_MAPPING_SIZE = 1024 * 1024;
+
+static std::string
+makeErrorMessage(const std::string& what)
+{
+  return what + ": " + std::strerror(errno);
+}
+
+static int
+openFile(const boost::filesystem::path& path)
+{
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (fd < 0) {
+    throw DiskStorage::Error(makeErrorMessage("cannot open " + path.string()));
+  }
+  return fd;
+}
+
+/** @brief compacts the index on open if it holds more than this many records per stored packet
+ */
+static const size_t MAX_INDEX_RECORDS_PER_PACKET = 2;
+
+static size_t
+getFileSize(int fd)
+{
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    throw DiskStorage::Error(makeErrorMessage("fstat"));
+  }
+  return st.st_size;
+}
+
+DiskStorage::DiskStorage(const boost::filesystem::path& dir)
+  : m_write(&::write)
+  , m_dirFd(-1)
+  , m_segmentFd(-1)
+  , m_indexFd(-1)
+  , m_mapping(nullptr)
+  , m_mappingSize(0)
+  , m_segmentFileSize(0)
+  , m_indexFileSize(0)
+  , m_isFailed(false)
+{
+  try {
+    boost::filesystem::create_directories(dir);
+    lockDirectory(dir);
+    m_segmentFd = openFile(dir / "segments");
+    m_indexFd = openFile(dir / "index");
+    m_segmentFileSize = getFileSize(m_segmentFd);
+    remap();
+    size_t nRecords = loadIndex();
+    if (nRecords > MAX_INDEX_RECORDS_PER_PACKET * m_index.size()) {
+      compactIndex(dir);
+    }
+  }
+  catch (const boost::filesystem::filesystem_error& e) {
+    close();
+    throw Error(e.what());
+  }
+  catch (...) {
+    close();
+    throw;
+  }
+}
+
+DiskStorage::~DiskStorage()
+{
+  close();
+}
+
+void
+DiskStorage::close()
+{
+  if (m_mapping != nullptr) {
+    ::munmap(const_cast<uint8_t*>(m_mapping), m_mappingSize);
+    m_mapping = nullptr;
+  }
+  if (m_segmentFd >= 0) {
+    ::close(m_segmentFd);
+    m_segmentFd = -1;
+  }
+  if (m_indexFd >= 0) {
+    ::close(m_indexFd);
+    m_indexFd = -1;
+  }
+  // closing the directory releases the lock
+  if (m_dirFd >= 0) {
+    ::close(m_dirFd);
+    m_dirFd = -1;
+  }
+}
+
+void
+DiskStorage::lockDirectory(const boost::filesystem::path& dir)
+{
+  m_dirFd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (m_dirFd < 0) {
+    throw Error(makeErrorMessage("cannot open " + dir.string()));
+  }
+
+  if (::flock(m_dirFd, LOCK_EX | LOCK_NB) != 0) {
+    if (errno == EWOULDBLOCK) {
+      throw Error(dir.string() + " is in use by another DiskStorage");
+    }
+    throw Error(makeErrorMessage("cannot lock " + dir.string()));
+  }
+}
+
+void
+DiskStorage::append(int fd, size_t& fileSize, const uint8_t* buffer, size_t size)
+{
+  size_t nWrittenTotal = 0;
+  while (nWrittenTotal < size) {
+    ssize_t nWritten = m_write(fd, buffer + nWrittenTotal, size - nWrittenTotal);
+    if (nWritten < 0) {
+      if (errno == EINTR)
+        continue;
+
+      // discard the bytes written so far, so that the file ends where the storage expects
+      std::string message = makeErrorMessage("write");
+      rollBack(fd, fileSize);
+      throw Error(message);
+    }
+    nWrittenTotal += nWritten;
+  }
+  fileSize += size;
+}
+
+void
+DiskStorage::rollBack(int fd, size_t size)
+{
+  if (::ftruncate(fd, size) != 0) {
+    m_isFailed = true;
+  }
+}
+
+void
+DiskStorage::checkFailed() const
+{
+  if (m_isFailed) {
+    throw Error("storage has failed, as a write could not be undone");
+  }
+}
+
+void
+DiskStorage::remap()
+{
+  if (m_segmentFileSize <= m_mappingSize)
+    return;
+
+  // the mapping may extend past the end of the file, as only appended bytes are ever read
+  size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  size_t size = std::max(std::max(2 * m_mappingSize, m_segmentFileSize), MIN_MAPPING_SIZE);
+  size = (size + pageSize - 1) / pageSize * pageSize;
+
+  void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, m_segmentFd, 0);
+  if (mapping == MAP_FAILED) {
+    throw Error(makeErrorMessage("mmap"));
+  }
+
+  if (m_mapping != nullptr) {
+    ::munmap(const_cast<uint8_t*>(m_mapping), m_mappingSize);
+  }
+  m_mapping = reinterpret_cast<const uint8_t*>(mapping);
+  m_mappingSize = size;
+}
+
+size_t
+DiskStorage::loadIndex()
+{
+  size_t indexFileSize = getFileSize(m_indexFd);
+  BufferPtr buffer = make_shared<Buffer>(indexFileSize);
+  size_t nRead = 0;
+  while (nRead < indexFileSize) {
+    ssize_t n = ::pread(m_indexFd, buffer->buf() + nRead, indexFileSize - nRead, nRead);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0) {
+      throw Error(makeErrorMessage("cannot read index"));
+    }
+    nRead += n;
+  }
+
+  size_t offset = 0;
+  size_t nRecords = 0;
+  while (offset < indexFileSize) {
+    bool isOk = false;
+    Block record;
+    std::tie(isOk, record) = Block::fromBuffer(buffer, offset);
+    if (!isOk)
+      break;
+
+    try {
+      record.parse();
+      Name name(record.get(tlv::Name));
+
+      if (record.type() == DiskStorageErasure) {
+        m_index.erase(name);
+      }
+      else if (record.type() == DiskStorageInsertion) {
+        Record location;
+        location.offset = readNonNegativeInteger(record.get(DiskStorageOffset));
+        location.length = readNonNegativeInteger(record.get(DiskStorageLength));
+        location.staleTime = time::system_clock::TimePoint::max();
+        Block::element_const_iterator staleTime = record.find(DiskStorageStaleTime);
+        if (staleTime != record.elements_end()) {
+          location.staleTime = time::fromUnixTimestamp(
+                                 time::milliseconds(readNonNegativeInteger(*staleTime)));
+        }
+
+        if (location.offset + location.length > m_segmentFileSize)
+          break;
+        m_index[name] = location;
+      }
+      else {
+        break;
+      }
+    }
+    catch (const tlv::Error&) {
+      break;
+    }
+
+    offset += record.size();
+    ++nRecords;
+  }
+
+  // discard a partially written record, so that new records can be appended after valid ones
+  if (offset < indexFileSize && ::ftruncate(m_indexFd, offset) != 0) {
+    throw Error(makeErrorMessage("cannot truncate index"));
+  }
+  m_indexFileSize = offset;
+  return nRecords;
+}
+
+void
+DiskStorage::compactIndex(const boost::filesystem::path& dir)
+{
+  std::vector<uint8_t> buffer;
+  for (const Index::value_type& item : m_index) {
+    Block record = makeInsertionRecord(item.first, item.second);
+    buffer.insert(buffer.end(), record.wire(), record.wire() + record.size());
+  }
+
+  // the compacted index replaces the index only once it is complete and synchronized,
+  // so that either index is intact if the process is terminated
+  boost::filesystem::path tmpPath = dir / "index.tmp";
+  int fd = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_APPEND, 0644);
+  if (fd < 0)
+    return;
+
+  size_t nWrittenTotal = 0;
+  while (nWrittenTotal < buffer.size()) {
+    ssize_t nWritten = m_write(fd, buffer.data() + nWrittenTotal, buffer.size() - nWrittenTotal);
+    if (nWritten < 0 && errno == EINTR)
+      continue;
+    if (nWritten < 0)
+      break;
+    nWrittenTotal += nWritten;
+  }
+
+  if (nWrittenTotal < buffer.size() || ::fsync(fd) != 0 ||
+      ::rename(tmpPath.c_str(), (dir / "index").c_str()) != 0) {
+    // compaction is an optimization: the storage stays usable with the uncompacted index
+    ::close(fd);
+    ::unlink(tmpPath.c_str());
+    return;
+  }
+
+  // the rename is durable once the directory is synchronized; if it is lost, the old index
+  // is still valid
+  ::fsync(m_dirFd);
+  ::close(m_indexFd);
+  m_indexFd = fd;
+  m_indexFileSize = buffer.size();
+}
+
+Block
+DiskStorage::makeInsertionRecord(const Name& fullName, const Record& location)
+{
+  Block record(DiskStorageInsertion);
+  record.push_back(fullName.wireEncode());
+  record.push_back(nonNegativeIntegerBlock(DiskStorageOffset, location.offset));
+  record.push_back(nonNegativeIntegerBlock(DiskStorageLength, location.length));
+  if (location.staleTime != time::system_clock::TimePoint::max()) {
+    record.push_back(nonNegativeIntegerBlock(DiskStorageStaleTime,
+                                             time::toUnixTimestamp(location.staleTime).count()));
+  }
+  record.encode();
+  return record;
+}
+
+void
+DiskStorage::appendIndexRecord(const Block& record)
+{
+  append(m_indexFd, m_indexFileSize, record.wire(), record.size());
+}
+
+void
+DiskStorage::insert(const Data& data)
+{
+  checkFailed();
+
+  const Name& fullName = data.getFullName();
+  if (m_index.find(fullName) != m_index.end())
+    return;
+
+  Record location;
+  location.offset = m_segmentFileSize;
+  location.length = data.wireEncode().size();
+  location.staleTime = time::system_clock::TimePoint::max();
+  if (data.getFreshnessPeriod() >= time::milliseconds::zero()) {
+    location.staleTime = time::system_clock::now() + data.getFreshnessPeriod();
+  }
+  Block record = makeInsertionRecord(fullName, location);
+
+  // the packet is written before its index record, so that the index never refers to
+  // a packet that is not in the segment file
+  append(m_segmentFd, m_segmentFileSize, data.wireEncode().wire(), location.length);
+  try {
+    remap();
+    appendIndexRecord(record);
+  }
+  catch (const Error&) {
+    // the packet cannot be found without its index record
+    m_segmentFileSize = location.offset;
+    rollBack(m_segmentFd, m_segmentFileSize);
+    throw;
+  }
+  m_index[fullName] = location;
+}
+
+shared_ptr<const Data>
+DiskStorage::decode(const Record& location) const
+{
+  return make_shared<Data>(Block(m_mapping + location.offset, location.length));
+}
+
+bool
+DiskStorage::canSatisfy(const Interest& interest, const Index::value_type& item,
+                        const time::system_clock::TimePoint& now) const
+{
+  if (interest.getMustBeFresh() && item.second.staleTime <= now) {
+    return false;
+  }
+
+  // the Interest Name is a prefix of the full name, which is sufficient without other selectors
+  if (interest.getMinSuffixComponents() < 0 && interest.getMaxSuffixComponents() < 0 &&
+      interest.getExclude().empty() && interest.getPublisherPublicKeyLocator().empty()) {
+    return true;
+  }
+
+  return interest.matchesData(*decode(item.second));
+}
+
+shared_ptr<const Data>
+DiskStorage::find(const Interest& interest) const
+{
+  time::system_clock::TimePoint now;
+  if (interest.getMustBeFresh()) {
+    now = time::system_clock::now();
+  }
+
+  const Name& prefix = interest.getName();
+  bool hasLeftmostSelector = (interest.getChildSelector() <= 0);
+  size_t childPrefixLength = prefix.size() + 1;
+
+  // rightmost child selector returns the leftmost Data under the rightmost child
+  Index::const_iterator rightmost = m_index.end();
+  for (Index::const_iterator it = m_index.lower_bound(prefix);
+       it != m_index.end() && prefix.isPrefixOf(it->first); ++it) {
+    if (!canSatisfy(interest, *it, now))
+      continue;
+
+    if (hasLeftmostSelector) {
+      return decode(it->second);
+    }
+
+    if (rightmost == m_index.end() ||
+        it->first.compare(0, childPrefixLength, rightmost->first, 0, childPrefixLength) != 0) {
+      rightmost = it;
+    }
+  }
+
+  if (rightmost != m_index.end()) {
+    return decode(rightmost->second);
+  }
+  return shared_ptr<const Data>();
+}
+
+shared_ptr<const Data>
+DiskStorage::find(const Name& name) const
+{
+  Index::const_iterator it = m_index.lower_bound(name);
+  if (it == m_index.end() || !name.isPrefixOf(it->first)) {
+    return shared_ptr<const Data>();
+  }
+  return decode(it->second);
+}
+
+void
+DiskStorage::erase(const Name& prefix, const bool isPrefix)
+{
+  checkFailed();
+
+  Index::iterator it = isPrefix ? m_index.lower_bound(prefix) : m_index.find(prefix);
+  while (it != m_index.end() && prefix.isPrefixOf(it->first)) {
+    Block record(DiskStorageErasure);
+    record.push_back(it->first.wireEncode());
+    record.encode();
+    appendIndexRecord(record);
+
+    it = m_index.erase(it);
+    if (!isPrefix)
+      break;
+  }
+}
+
+void
+DiskStorage::flush()
+{
+  if (::fsync(m_segmentFd) != 0 || ::fsync(m_indexFd) != 0) {
+    throw Error(makeErrorMessage("fsync"));
+  }
+}
+
+} // namespace util
+} // namespace ndn
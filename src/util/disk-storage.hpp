@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_DISK_STORAGE_HPP
+#define NDN_UTIL_DISK_STORAGE_HPP
+
+#include "../common.hpp"
+#include "../interest.hpp"
+#include "../data.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <map>
+
+#include <sys/types.h>
+
+namespace ndn {
+namespace util {
+
+/** @brief Provides persistent storage of Data packets in a memory-mapped file
+ *
+ *  Wire encodings of Data packets are appended to a segment file, which is mapped into memory
+ *  for reading.  For every insertion and erasure, a record with the full name of the packet and
+ *  its location in the segment file is appended to an index file.  Opening a storage maps the
+ *  segment file and replays the index file, so that neither packets are decoded nor digests are
+ *  computed, and stored packets are available as soon as the constructor returns.
+ *
+ *  The segment file is append-only: erasing a packet removes it from the index, but does not
+ *  reclaim its space in the segment file.  The index file grows with every insertion and
+ *  erasure; when opening finds more than two records per stored packet, the index file is
+ *  rewritten with one record per stored packet.  The segment file is never compacted.
+ *
+ *  Finding a packet copies its wire encoding out of the mapping, so that the returned Data
+ *  stays valid after the mapping is replaced or the storage is closed.
+ *
+ *  If a write fails, the file is truncated to its size before the write, so that the files stay
+ *  consistent with the storage.  If the file cannot be truncated, the storage is marked failed:
+ *  stored packets can still be found, but insertions and erasures throw.
+ *
+ *  The directory is locked while the storage is open, so that it cannot be opened by another
+ *  DiskStorage, in this or another process.
+ *
+ *  @note This class is not thread-safe.
+ */
+class DiskStorage : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  /** @brief opens a storage in @p dir, creating it if it does not exist
+   *  @throw Error the storage cannot be opened, or is open in another DiskStorage
+   */
+  explicit
+  DiskStorage(const boost::filesystem::path& dir);
+
+  ~DiskStorage();
+
+  /** @brief Inserts a Data packet
+   *
+   *  @note Packets are considered duplicate if the name with implicit digest matches.
+   *  @throw Error the packet cannot be written, or the storage has failed
+   */
+  void
+  insert(const Data& data);
+
+  /** @brief Finds the best match Data for an Interest
+   *
+   *  The wire encoding of the returned packet is copied out of the segment file, once per call.
+   *  Other stored packets are copied and decoded only if the Interest has selectors other than
+   *  ChildSelector and MustBeFresh.  MustBeFresh is evaluated against the system clock,
+   *  because the storage can outlive the process.
+   *
+   *  @return{ the best match, if any; otherwise a null shared_ptr }
+   */
+  shared_ptr<const Data>
+  find(const Interest& interest) const;
+
+  /** @brief Finds a Data for a Name with or without the implicit digest
+   *
+   *  If several packets match, the first one in canonical order is returned.
+   *  @return{ the one matched the Name; otherwise a null shared_ptr }
+   */
+  shared_ptr<const Data>
+  find(const Name& name) const;
+
+  /** @brief Deletes stored packets by prefix by default
+   *  @param[in] isPrefix If it is clear, the function will only delete the
+   *  packet whose full name is @p prefix.
+   *  @throw Error the erasure cannot be recorded, or the storage has failed
+   */
+  void
+  erase(const Name& prefix, const bool isPrefix = true);
+
+  /** @return{ number of packets stored }
+   */
+  size_t
+  size() const
+  {
+    return m_index.size();
+  }
+
+  /** @return{ size of the segment file, including the space of erased packets }
+   */
+  size_t
+  getSegmentFileSize() const
+  {
+    return m_segmentFileSize;
+  }
+
+  /** @return{ whether a write failed and the files could not be restored }
+   */
+  bool
+  isFailed() const
+  {
+    return m_isFailed;
+  }
+
+  /** @brief writes appended packets and index records to stable storage
+   *  @throw Error the files cannot be synchronized
+   */
+  void
+  flush();
+
+private:
+  void
+  close();
+
+  void
+  lockDirectory(const boost::filesystem::path& dir);
+
+  /** @brief appends @p size octets to the file, whose size is @p fileSize
+   *
+   *  If the write fails, the file is truncated to @p fileSize, or the storage is marked failed.
+   *  Otherwise, @p fileSize is increased by @p size.
+   *  @throw Error the write fails
+   */
+  void
+  append(int fd, size_t& fileSize, const uint8_t* buffer, size_t size);
+
+  /** @brief truncates the file to @p size, or marks the storage failed
+   */
+  void
+  rollBack(int fd, size_t size);
+
+  /** @brief location and freshness of a stored packet
+   */
+  struct Record
+  {
+    uint64_t offset;
+    uint64_t length;
+    time::system_clock::TimePoint staleTime;
+  };
+
+  typedef std::map<Name, Record> Index;
+
+  /** @brief replays the index file into the index
+   *  @return{ number of records replayed }
+   */
+  size_t
+  loadIndex();
+
+  /** @brief replaces the index file with one insertion record per stored packet
+   *
+   *  If the new index file cannot be written, the old one is kept.
+   */
+  void
+  compactIndex(const boost::filesystem::path& dir);
+
+  static Block
+  makeInsertionRecord(const Name& fullName, const Record& location);
+
+  void
+  appendIndexRecord(const Block& record);
+
+  void
+  checkFailed() const;
+
+  /** @brief makes sure the mapping covers the segment file
+   */
+  void
+  remap();
+
+  shared_ptr<const Data>
+  decode(const Record& record) const;
+
+  bool
+  canSatisfy(const Interest& interest, const Index::value_type& item,
+             const time::system_clock::TimePoint& now) const;
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  /** @brief writes to a file descriptor, with the semantics of write(2)
+   *
+   *  It can be replaced to inject write failures in unit tests.
+   */
+  function<ssize_t(int fd, const void* buffer, size_t size)> m_write;
+
+private:
+  int m_dirFd;
+  int m_segmentFd;
+  int m_indexFd;
+  const uint8_t* m_mapping;
+  size_t m_mappingSize;
+  size_t m_segmentFileSize;
+  size_t m_indexFileSize;
+  bool m_isFailed;
+  Index m_index;
+};
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_DISK_STORAGE_HPP
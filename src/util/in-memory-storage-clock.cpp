@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "in-memory-storage-clock.hpp"
+
+namespace ndn {
+namespace util {
+
+InMemoryStorageClock::InMemoryStorageClock(size_t limit)
+  : InMemoryStorage(limit)
+  , m_hand(m_cleanupIndex.get<byClock>().end())
+{
+}
+
+InMemoryStorageClock::~InMemoryStorageClock()
+{
+}
+
+void
+InMemoryStorageClock::afterInsert(InMemoryStorageEntry* entry)
+{
+  BOOST_ASSERT(m_cleanupIndex.size() <= size());
+  CleanupEntry cleanupEntry;
+  cleanupEntry.entry = entry;
+  cleanupEntry.isReferenced = false;
+  // the new entry is the last one to be visited by the hand
+  m_cleanupIndex.get<byClock>().insert(m_hand, cleanupEntry);
+}
+
+bool
+InMemoryStorageClock::evictItem()
+{
+  CleanupIndex::index<byClock>::type& clock = m_cleanupIndex.get<byClock>();
+  if (clock.empty()) {
+    return false;
+  }
+
+  // terminates within two rounds, as the first round clears every referenced bit
+  while (true) {
+    if (m_hand == clock.end()) {
+      m_hand = clock.begin();
+    }
+
+    if (!m_hand->isReferenced) {
+      break;
+    }
+    clock.modify(m_hand, &clearReferenced);
+    ++m_hand;
+  }
+
+  InMemoryStorageEntry* entry = m_hand->entry;
+  m_hand = clock.erase(m_hand);
+  eraseImpl(entry);
+  return true;
+}
+
+void
+InMemoryStorageClock::beforeErase(InMemoryStorageEntry* entry)
+{
+  CleanupIndex::index<byEntity>::type::iterator it = m_cleanupIndex.get<byEntity>().find(entry);
+  if (it == m_cleanupIndex.get<byEntity>().end())
+    return;
+
+  CleanupIndex::index<byClock>::type::iterator pos = m_cleanupIndex.project<byClock>(it);
+  if (pos == m_hand) {
+    ++m_hand;
+  }
+  m_cleanupIndex.get<byEntity>().erase(it);
+}
+
+void
+InMemoryStorageClock::afterAccess(InMemoryStorageEntry* entry)
+{
+  CleanupIndex::index<byEntity>::type::iterator it = m_cleanupIndex.get<byEntity>().find(entry);
+  m_cleanupIndex.get<byEntity>().modify(it, &setReferenced);
+}
+
+} // namespace util
+} // namespace ndn
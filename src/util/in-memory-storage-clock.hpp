@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_IN_MEMORY_STORAGE_CLOCK_HPP
+#define NDN_UTIL_IN_MEMORY_STORAGE_CLOCK_HPP
+
+#include "in-memory-storage.hpp"
+
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+
+namespace ndn {
+namespace util {
+
+/** @brief Provides an in-memory storage with CLOCK replacement policy, an approximation of LRU.
+ *
+ *  Entries are kept in a circular list swept by a clock hand.  An access only sets the
+ *  referenced bit of the entry, so that cache hits cost O(1) and do not allocate.  Eviction
+ *  advances the hand, clearing referenced bits, until it finds an entry that has not been
+ *  referenced since the previous sweep.
+ *  @sa https://en.wikipedia.org/w/index.php?title=Page_replacement_algorithm&oldid=646584396#Clock
+ */
+class InMemoryStorageClock : public InMemoryStorage
+{
+public:
+  explicit
+  InMemoryStorageClock(size_t limit = 10);
+
+  virtual
+  ~InMemoryStorageClock();
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PROTECTED:
+  /** @brief Removes one Data packet from in-memory storage based on CLOCK, i.e. evict the first
+   *  entry under the clock hand that has not been referenced since the previous sweep
+   *  @return{ whether the Data was removed }
+   */
+  virtual bool
+  evictItem();
+
+  /** @brief Update the entry when the entry is returned by the find() function,
+   *  set its referenced bit
+   */
+  virtual void
+  afterAccess(InMemoryStorageEntry* entry);
+
+  /** @brief Update the entry after a entry is successfully inserted, add it to the cleanupIndex
+   *  right behind the clock hand
+   */
+  virtual void
+  afterInsert(InMemoryStorageEntry* entry);
+
+  /** @brief Update the entry or other data structures before a entry is successfully erased,
+   *  erase it from the cleanupIndex
+   */
+  virtual void
+  beforeErase(InMemoryStorageEntry* entry);
+
+private:
+  //binds referenced bit and entry together
+  struct CleanupEntry
+  {
+    InMemoryStorageEntry* entry;
+    bool isReferenced;
+  };
+
+  static inline void
+  setReferenced(CleanupEntry& cleanupEntry)
+  {
+    cleanupEntry.isReferenced = true;
+  }
+
+  static inline void
+  clearReferenced(CleanupEntry& cleanupEntry)
+  {
+    cleanupEntry.isReferenced = false;
+  }
+
+private:
+  //multi_index_container to implement CLOCK
+  class byEntity;
+  class byClock;
+
+  typedef boost::multi_index_container<
+    CleanupEntry,
+    boost::multi_index::indexed_by<
+
+      // by Entry itself
+      boost::multi_index::hashed_unique<
+        boost::multi_index::tag<byEntity>,
+        boost::multi_index::member<CleanupEntry, InMemoryStorageEntry*, &CleanupEntry::entry>
+      >,
+
+      // by position on the clock
+      boost::multi_index::sequenced<
+        boost::multi_index::tag<byClock>
+      >
+
+    >
+  > CleanupIndex;
+
+  CleanupIndex m_cleanupIndex;
+  /// clock hand, end() stands for begin()
+  CleanupIndex::index<byClock>::type::iterator m_hand;
+};
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_IN_MEMORY_STORAGE_CLOCK_HPP
@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "in-memory-storage-counters.hpp"
+#include "../encoding/block-helpers.hpp"
+#include "../encoding/encoding-buffer.hpp"
+#include "concepts.hpp"
+
+namespace ndn {
+namespace util {
+
+BOOST_CONCEPT_ASSERT((WireEncodable<InMemoryStorageCounters>));
+BOOST_CONCEPT_ASSERT((WireDecodable<InMemoryStorageCounters>));
+
+/** @brief TLV types of eviction counters, in the order of EvictionCause
+ */
+static const uint32_t EVICTION_TYPES[InMemoryStorageCounters::N_EVICTION_CAUSES] = {
+  tlv::ims::NLimitEvictions,
+  tlv::ims::NByteLimitEvictions,
+  tlv::ims::NCapacityEvictions,
+  tlv::ims::NExpirations
+};
+
+InMemoryStorageCounters::InMemoryStorageCounters()
+  : m_nHits(0)
+  , m_nMisses(0)
+  , m_nInserts(0)
+  , m_nDuplicateInserts(0)
+  , m_nErased(0)
+  , m_nResizes(0)
+{
+  for (std::atomic<uint64_t>& counter : m_nEvictions) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+  for (std::atomic<uint64_t>& counter : m_nLookups) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+}
+
+InMemoryStorageCounters::InMemoryStorageCounters(const Block& wire)
+{
+  wireDecode(wire);
+}
+
+void
+InMemoryStorageCounters::lookedUp(const time::nanoseconds& latency)
+{
+  size_t bucket = 0;
+  for (uint64_t ns = std::max<int64_t>(latency.count(), 1); ns > 1; ns >>= 1) {
+    ++bucket;
+  }
+  increment(m_nLookups[std::min(bucket, N_LATENCY_BUCKETS - 1)]);
+}
+
+template<encoding::Tag TAG>
+size_t
+InMemoryStorageCounters::wireEncode(EncodingImpl<TAG>& encoder) const
+{
+  size_t totalLength = 0;
+
+  bool hasHistogram = false;
+  for (const std::atomic<uint64_t>& counter : m_nLookups) {
+    hasHistogram = hasHistogram || counter.load(std::memory_order_relaxed) > 0;
+  }
+  if (hasHistogram) {
+    size_t histogramLength = 0;
+    for (size_t i = N_LATENCY_BUCKETS; i > 0; --i) {
+      histogramLength += prependNonNegativeIntegerBlock(encoder, tlv::ims::NLookups,
+                                                        getNLookups(i - 1));
+    }
+    totalLength += histogramLength;
+    totalLength += encoder.prependVarNumber(histogramLength);
+    totalLength += encoder.prependVarNumber(tlv::ims::LookupLatencyHistogram);
+  }
+
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::ims::NResizes, getNResizes());
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::ims::NErased, getNErased());
+  for (size_t i = N_EVICTION_CAUSES; i > 0; --i) {
+    totalLength += prependNonNegativeIntegerBlock(encoder, EVICTION_TYPES[i - 1],
+                                                  getNEvictions(static_cast<EvictionCause>(i - 1)));
+  }
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::ims::NDuplicateInserts,
+                                                getNDuplicateInserts());
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::ims::NInserts, getNInserts());
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::ims::NMisses, getNMisses());
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::ims::NHits, getNHits());
+
+  totalLength += encoder.prependVarNumber(totalLength);
+  totalLength += encoder.prependVarNumber(tlv::Content);
+  return totalLength;
+}
+
+template size_t
+InMemoryStorageCounters::wireEncode<encoding::EncoderTag>(
+  EncodingImpl<encoding::EncoderTag>&) const;
+
+template size_t
+InMemoryStorageCounters::wireEncode<encoding::EstimatorTag>(
+  EncodingImpl<encoding::EstimatorTag>&) const;
+
+Block
+InMemoryStorageCounters::wireEncode() const
+{
+  // counters may change between estimation and encoding, so the buffer is allowed to grow
+  EncodingBuffer buffer;
+  wireEncode(buffer);
+  return buffer.block();
+}
+
+static uint64_t
+decodeCounter(Block::element_const_iterator& val, const Block& wire, uint32_t type,
+              const char* fieldName)
+{
+  if (val == wire.elements_end() || val->type() != type) {
+    throw InMemoryStorageCounters::Error(std::string("missing required ") + fieldName +
+                                         " field");
+  }
+  return readNonNegativeInteger(*val++);
+}
+
+void
+InMemoryStorageCounters::wireDecode(const Block& block)
+{
+  if (block.type() != tlv::Content) {
+    throw Error("expecting Content block for InMemoryStorageCounters payload");
+  }
+  Block wire = block;
+  wire.parse();
+  Block::element_const_iterator val = wire.elements_begin();
+
+  m_nHits = decodeCounter(val, wire, tlv::ims::NHits, "NHits");
+  m_nMisses = decodeCounter(val, wire, tlv::ims::NMisses, "NMisses");
+  m_nInserts = decodeCounter(val, wire, tlv::ims::NInserts, "NInserts");
+  m_nDuplicateInserts = decodeCounter(val, wire, tlv::ims::NDuplicateInserts,
+                                      "NDuplicateInserts");
+  m_nEvictions[EVICTION_LIMIT] = decodeCounter(val, wire, tlv::ims::NLimitEvictions,
+                                               "NLimitEvictions");
+  m_nEvictions[EVICTION_BYTE_LIMIT] = decodeCounter(val, wire, tlv::ims::NByteLimitEvictions,
+                                                    "NByteLimitEvictions");
+  m_nEvictions[EVICTION_CAPACITY] = decodeCounter(val, wire, tlv::ims::NCapacityEvictions,
+                                                  "NCapacityEvictions");
+  m_nEvictions[EVICTION_EXPIRED] = decodeCounter(val, wire, tlv::ims::NExpirations,
+                                                 "NExpirations");
+  m_nErased = decodeCounter(val, wire, tlv::ims::NErased, "NErased");
+  m_nResizes = decodeCounter(val, wire, tlv::ims::NResizes, "NResizes");
+
+  for (std::atomic<uint64_t>& counter : m_nLookups) {
+    counter = 0;
+  }
+  if (val != wire.elements_end() && val->type() == tlv::ims::LookupLatencyHistogram) {
+    Block histogram = *val;
+    histogram.parse();
+    if (histogram.elements_size() > N_LATENCY_BUCKETS) {
+      throw Error("too many buckets in LookupLatencyHistogram");
+    }
+    Block::element_const_iterator bucket = histogram.elements_begin();
+    for (size_t i = 0; bucket != histogram.elements_end(); ++i) {
+      m_nLookups[i] = decodeCounter(bucket, histogram, tlv::ims::NLookups, "NLookups");
+    }
+  }
+}
+
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,246 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_IN_MEMORY_STORAGE_COUNTERS_HPP
+#define NDN_UTIL_IN_MEMORY_STORAGE_COUNTERS_HPP
+
+#include "../common.hpp"
+#include "../encoding/block.hpp"
+#include "time.hpp"
+
+#include <atomic>
+
+namespace ndn {
+
+namespace tlv {
+namespace ims {
+
+// InMemoryStorage status dataset
+enum {
+  NHits                  = 129,
+  NMisses                = 130,
+  NInserts               = 131,
+  NDuplicateInserts      = 132,
+  NLimitEvictions        = 133,
+  NByteLimitEvictions    = 134,
+  NCapacityEvictions     = 135,
+  NExpirations           = 136,
+  NErased                = 137,
+  NResizes               = 138,
+  LookupLatencyHistogram = 139,
+  NLookups               = 140
+};
+
+} // namespace ims
+} // namespace tlv
+
+namespace util {
+
+/** @brief Counts operations of an InMemoryStorage
+ *
+ *  Every counter has a single writer, the thread that operates the InMemoryStorage, which
+ *  increments it with relaxed loads and stores rather than read-modify-write instructions.
+ *  Counters can be read from any thread, e.g. by a status dataset publisher, at no cost to
+ *  the writer.
+ *
+ *  The lookup latency histogram is recorded only if enabled with
+ *  InMemoryStorage::enableLatencyHistogram, because it reads the clock twice per lookup.
+ *  Bucket i counts lookups that took [2^i, 2^(i+1)) nanoseconds, and bucket 0 also counts
+ *  those that took less than 1 nanosecond.
+ */
+class InMemoryStorageCounters : noncopyable
+{
+public:
+  class Error : public tlv::Error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : tlv::Error(what)
+    {
+    }
+  };
+
+  enum EvictionCause {
+    /** @brief the storage reached its limit (in packets) upon insertion
+     */
+    EVICTION_LIMIT,
+    /** @brief the storage reached its byte limit
+     */
+    EVICTION_BYTE_LIMIT,
+    /** @brief the capacity was reduced below the number of stored packets
+     */
+    EVICTION_CAPACITY,
+    /** @brief the packet was removed by InMemoryStorage::eraseExpired
+     */
+    EVICTION_EXPIRED,
+    N_EVICTION_CAUSES
+  };
+
+  static const size_t N_LATENCY_BUCKETS = 32;
+
+  InMemoryStorageCounters();
+
+  explicit
+  InMemoryStorageCounters(const Block& wire);
+
+  uint64_t
+  getNHits() const
+  {
+    return m_nHits.load(std::memory_order_relaxed);
+  }
+
+  uint64_t
+  getNMisses() const
+  {
+    return m_nMisses.load(std::memory_order_relaxed);
+  }
+
+  uint64_t
+  getNInserts() const
+  {
+    return m_nInserts.load(std::memory_order_relaxed);
+  }
+
+  uint64_t
+  getNDuplicateInserts() const
+  {
+    return m_nDuplicateInserts.load(std::memory_order_relaxed);
+  }
+
+  uint64_t
+  getNEvictions(EvictionCause cause) const
+  {
+    return m_nEvictions[cause].load(std::memory_order_relaxed);
+  }
+
+  /** @return{ number of packets removed by InMemoryStorage::erase }
+   */
+  uint64_t
+  getNErased() const
+  {
+    return m_nErased.load(std::memory_order_relaxed);
+  }
+
+  /** @return{ number of times the capacity was changed }
+   */
+  uint64_t
+  getNResizes() const
+  {
+    return m_nResizes.load(std::memory_order_relaxed);
+  }
+
+  /** @return{ number of lookups in latency bucket @p bucket }
+   */
+  uint64_t
+  getNLookups(size_t bucket) const
+  {
+    return m_nLookups[bucket].load(std::memory_order_relaxed);
+  }
+
+  /** @brief prepend the counters as a Content block to the encoder
+   *
+   *  The latency histogram is included only if it has recorded any lookup.
+   */
+  template<encoding::Tag TAG>
+  size_t
+  wireEncode(EncodingImpl<TAG>& encoder) const;
+
+  /** @brief encode the counters as a Content block, which is the payload of a status dataset
+   */
+  Block
+  wireEncode() const;
+
+  /** @brief decode the counters from a Content block
+   */
+  void
+  wireDecode(const Block& wire);
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  void
+  hit()
+  {
+    increment(m_nHits);
+  }
+
+  void
+  miss()
+  {
+    increment(m_nMisses);
+  }
+
+  void
+  inserted()
+  {
+    increment(m_nInserts);
+  }
+
+  void
+  duplicateInserted()
+  {
+    increment(m_nDuplicateInserts);
+  }
+
+  void
+  evicted(EvictionCause cause)
+  {
+    increment(m_nEvictions[cause]);
+  }
+
+  void
+  erased()
+  {
+    increment(m_nErased);
+  }
+
+  void
+  resized()
+  {
+    increment(m_nResizes);
+  }
+
+  void
+  lookedUp(const time::nanoseconds& latency);
+
+private:
+  static void
+  increment(std::atomic<uint64_t>& counter)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint64_t> m_nHits;
+  std::atomic<uint64_t> m_nMisses;
+  std::atomic<uint64_t> m_nInserts;
+  std::atomic<uint64_t> m_nDuplicateInserts;
+  std::atomic<uint64_t> m_nEvictions[N_EVICTION_CAUSES];
+  std::atomic<uint64_t> m_nErased;
+  std::atomic<uint64_t> m_nResizes;
+  std::atomic<uint64_t> m_nLookups[N_LATENCY_BUCKETS];
+
+  friend class InMemoryStorage;
+};
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_IN_MEMORY_STORAGE_COUNTERS_HPP
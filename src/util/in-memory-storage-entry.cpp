@@ -24,16 +24,126 @@
 namespace ndn {
 namespace util {
 
+/** @brief estimated size of a node in the name index or in a replacement policy index
+ */
+static const size_t INDEX_NODE_SIZE = 4 * sizeof(void*);
+
+/** @brief size of the previous and next pointers added to a cache node by the byArrival index
+ */
+static const size_t SEQUENCED_NODE_SIZE = 2 * sizeof(void*);
+
+/** @brief size of the TLV of an implicit digest component
+ */
+static const size_t DIGEST_COMPONENT_SIZE = 2 + 32;
+
 void
 InMemoryStorageEntry::release()
 {
   m_dataPacket.reset();
+  m_overheadSize = 0;
 }
 
 void
 InMemoryStorageEntry::setData(const Data& data)
 {
   m_dataPacket = data.shared_from_this();
+
+  m_insertionTime = time::steady_clock::now();
+  if (data.getFreshnessPeriod() >= time::milliseconds::zero()) {
+    m_staleTime = m_insertionTime + data.getFreshnessPeriod();
+  }
+  else {
+    m_staleTime = time::steady_clock::TimePoint::max();
+  }
+
+  // decoded Data, with a Block per top-level element and per component of Name and full Name,
+  // wire encoding of the full Name, a node in both the name index and the policy index,
+  // and the links of the byArrival index in the cache node;
+  // the full Name is accounted for even if it is never computed
+  const Block& wire = data.wireEncode();
+  size_t nBlocks = wire.elements_size() + 2 * data.getName().size() + 1;
+  size_t fullNameSize = wire.get(tlv::Name).size() + DIGEST_COMPONENT_SIZE;
+  m_overheadSize = sizeof(Data) + nBlocks * sizeof(Block) + fullNameSize +
+                   2 * INDEX_NODE_SIZE + SEQUENCED_NODE_SIZE;
+}
+
+/** @brief compares the full name of @p data with @p other, where @p other is longer than
+ *         the name of @p data
+ */
+static int
+compareLongerName(const Data& data, const Name& other)
+{
+  const Name& name = data.getName();
+  size_t nComponents = name.size();
+  BOOST_ASSERT(other.size() > nComponents);
+
+  int cmp = name.compare(0, nComponents, other, 0, nComponents);
+  if (cmp != 0) {
+    return cmp;
+  }
+
+  // components are ordered by type first, so the digest is needed only if the types are equal
+  const name::Component& component = other.get(nComponents);
+  if (!component.isImplicitSha256Digest()) {
+    return tlv::ImplicitSha256DigestComponent < component.type() ? -1 : 1;
+  }
+
+  cmp = data.getFullName().get(nComponents).compare(component);
+  if (cmp != 0) {
+    return cmp;
+  }
+  return other.size() == nComponents + 1 ? 0 : -1;
+}
+
+int
+InMemoryStorageEntry::compareFullName(const Name& other) const
+{
+  const Name& name = getName();
+  if (other.size() <= name.size()) {
+    // the full name is longer than other
+    int cmp = name.compare(0, other.size(), other);
+    return cmp == 0 ? 1 : cmp;
+  }
+
+  return compareLongerName(*m_dataPacket, other);
+}
+
+int
+InMemoryStorageEntry::compareFullNames(const Data& lhs, const Data& rhs)
+{
+  const Name& lhsName = lhs.getName();
+  const Name& rhsName = rhs.getName();
+
+  if (lhsName.size() < rhsName.size()) {
+    // if the full name of lhs equals the name of rhs, it is less than the full name of rhs
+    int cmp = compareLongerName(lhs, rhsName);
+    return cmp == 0 ? -1 : cmp;
+  }
+
+  if (lhsName.size() > rhsName.size()) {
+    int cmp = compareLongerName(rhs, lhsName);
+    return cmp == 0 ? 1 : -cmp;
+  }
+
+  int cmp = lhsName.compare(rhsName);
+  if (cmp != 0) {
+    return cmp;
+  }
+  return lhs.getFullName().get(-1).compare(rhs.getFullName().get(-1));
+}
+
+bool
+InMemoryStorageEntry::hasFullNamePrefix(const Name& prefix) const
+{
+  const Name& name = getName();
+  if (prefix.size() <= name.size()) {
+    return prefix.isPrefixOf(name);
+  }
+
+  return prefix.size() == name.size() + 1 &&
+         prefix.get(-1).isImplicitSha256Digest() &&
+         name.compare(0, name.size(), prefix, 0, name.size()) == 0 &&
+         getFullName().get(-1) == prefix.get(-1);
 }
 
 } // namespace util
@@ -34,6 +34,11 @@ namespace util {
 class InMemoryStorageEntry : noncopyable
 {
 public:
+  InMemoryStorageEntry()
+    : m_overheadSize(0)
+  {
+  }
+
   /** @brief Releases reference counts on shared objects
    */
   void
@@ -49,6 +54,8 @@ public:
 
   /** @brief Returns the full name (including implicit digest) of the Data packet stored
    *         in the in-memory storage entry
+   *
+   *  The implicit digest is computed upon the first call.
    */
   const Name&
   getFullName() const
@@ -56,6 +63,42 @@ public:
     return m_dataPacket->getFullName();
   }
 
+  /** @brief Compares the full name of the Data packet with @p other in canonical order
+   *
+   *  The implicit digest is computed only if @p other has the same name up to the position of
+   *  the implicit digest, and an implicit digest at that position.
+   *
+   *  @retval negative the full name is less than @p other
+   *  @retval zero the full name equals @p other
+   *  @retval positive the full name is greater than @p other
+   */
+  int
+  compareFullName(const Name& other) const;
+
+  /** @brief Compares the full name of the Data packet with the full name of @p other
+   *  @sa compareFullNames
+   */
+  int
+  compareFullName(const Data& other) const
+  {
+    return compareFullNames(*m_dataPacket, other);
+  }
+
+  /** @brief Compares full names of two Data packets in canonical order
+   *
+   *  Implicit digests are computed only if both packets have the same name, or the name of one
+   *  packet is the name of the other followed by an implicit digest.
+   */
+  static int
+  compareFullNames(const Data& lhs, const Data& rhs);
+
+  /** @brief Returns whether @p prefix is a prefix of the full name of the Data packet
+   *
+   *  The implicit digest is computed only if @p prefix is one component longer than the name.
+   */
+  bool
+  hasFullNamePrefix(const Name& prefix) const;
+
 
   /** @brief Returns the Data packet stored in the in-memory storage entry
    */
@@ -66,13 +109,62 @@ public:
   }
 
 
+  /** @brief Returns the time at which the Data packet was placed into the entry
+   */
+  const time::steady_clock::TimePoint&
+  getInsertionTime() const
+  {
+    return m_insertionTime;
+  }
+
+  /** @brief Returns the time at which the Data packet becomes stale
+   *
+   *  This is the insertion time plus FreshnessPeriod, or TimePoint::max() if the Data packet
+   *  does not have FreshnessPeriod.
+   */
+  const time::steady_clock::TimePoint&
+  getStaleTime() const
+  {
+    return m_staleTime;
+  }
+
+  /** @brief Returns whether the Data packet is fresh at @p now
+   */
+  bool
+  isFresh(const time::steady_clock::TimePoint& now) const
+  {
+    return now < m_staleTime;
+  }
+
+  /** @brief Returns the size of the wire encoding of the Data packet
+   */
+  size_t
+  getPayloadSize() const
+  {
+    return m_dataPacket->wireEncode().size();
+  }
+
+  /** @brief Returns the estimated memory used for the Data packet in addition to its wire
+   *         encoding, including the decoded packet and the index nodes
+   */
+  size_t
+  getOverheadSize() const
+  {
+    return m_overheadSize;
+  }
+
   /** @brief Changes the content of in-memory storage entry
+   *  @pre @p data has wire encoding
+   *  @note The implicit digest is not computed.
    */
   void
   setData(const Data& data);
 
 private:
   shared_ptr<const Data> m_dataPacket;
+  time::steady_clock::TimePoint m_insertionTime;
+  time::steady_clock::TimePoint m_staleTime;
+  size_t m_overheadSize;
 };
 
 } // namespace util
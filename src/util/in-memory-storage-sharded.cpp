@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "in-memory-storage-sharded.hpp"
+
+namespace ndn {
+namespace util {
+
+InMemoryStorageSharded::InMemoryStorageSharded(const ShardFactory& makeShard, size_t nShards,
+                                               size_t nPrefixComponents, size_t limit)
+  : m_nPrefixComponents(nPrefixComponents)
+  , m_limit(limit)
+{
+  BOOST_ASSERT(nShards > 0);
+  BOOST_ASSERT(limit >= nShards);
+
+  m_shards.reserve(nShards);
+  for (size_t i = 0; i < nShards; ++i) {
+    size_t shardLimit = limit;
+    if (limit != std::numeric_limits<size_t>::max()) {
+      // the remainder goes to the first shards, so that the shard limits add up to limit
+      shardLimit = limit / nShards + (i < limit % nShards ? 1 : 0);
+    }
+
+    m_shards.push_back(unique_ptr<Shard>(new Shard));
+    m_shards.back()->storage = makeShard(shardLimit);
+  }
+}
+
+size_t
+InMemoryStorageSharded::findShard(const Name& prefix) const
+{
+  size_t nComponents = prefix.size();
+  if (nComponents > 0 && prefix.get(-1).isImplicitSha256Digest()) {
+    // a full name can only match Data whose Name is one component shorter
+    return getShardIndex(prefix, nComponents - 1);
+  }
+
+  if (nComponents < m_nPrefixComponents) {
+    return m_shards.size();
+  }
+
+  return getShardIndex(prefix, nComponents);
+}
+
+void
+InMemoryStorageSharded::insert(const Data& data)
+{
+  // decode every field and compute the full name before the shard is locked: stored packets
+  // are read from other threads, and Data would otherwise do both lazily without synchronization
+  data.getMetaInfo();
+  data.getSignature();
+  data.getFullName();
+
+  const Name& name = data.getName();
+  Shard& shard = *m_shards[getShardIndex(name, name.size())];
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.storage->insert(data);
+}
+
+shared_ptr<const Data>
+InMemoryStorageSharded::find(const Interest& interest)
+{
+  size_t index = findShard(interest.getName());
+  if (index < m_shards.size()) {
+    Shard& shard = *m_shards[index];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.storage->find(interest);
+  }
+
+  shared_ptr<const Data> best;
+  size_t bestIndex = m_shards.size();
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    Shard& shard = *m_shards[i];
+    shared_ptr<const Data> candidate;
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      InMemoryStorageEntry* entry = shard.storage->findEntry(interest);
+      if (entry == 0) {
+        continue;
+      }
+      candidate = entry->getData().shared_from_this();
+    }
+
+    selectCandidate(interest, candidate, best);
+    if (best == candidate) {
+      bestIndex = i;
+    }
+  }
+
+  if (best == nullptr) {
+    // the miss is counted in the shard that would store Data named exactly as the Interest
+    const Name& name = interest.getName();
+    Shard& shard = *m_shards[getShardIndex(name, name.size())];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.storage->countLookup(false);
+    return best;
+  }
+
+  // only the returned packet counts as a hit and as accessed; it may have been evicted meanwhile
+  Shard& shard = *m_shards[bestIndex];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.storage->countLookup(true);
+  shard.storage->find(best->getFullName());
+  return best;
+}
+
+void
+InMemoryStorageSharded::selectCandidate(const Interest& interest,
+                                        const shared_ptr<const Data>& candidate,
+                                        shared_ptr<const Data>& best)
+{
+  if (best == nullptr) {
+    best = candidate;
+    return;
+  }
+
+  const Name& name = candidate->getFullName();
+  const Name& bestName = best->getFullName();
+
+  if (interest.getChildSelector() <= 0) {
+    if (name < bestName) {
+      best = candidate;
+    }
+    return;
+  }
+
+  // rightmost child selector returns the leftmost Data under the rightmost child
+  size_t childPrefixLength = interest.getName().size() + 1;
+  int cmp = name.compare(0, childPrefixLength, bestName, 0, childPrefixLength);
+  if (cmp > 0 || (cmp == 0 && name < bestName)) {
+    best = candidate;
+  }
+}
+
+shared_ptr<const Data>
+InMemoryStorageSharded::find(const Name& name)
+{
+  size_t index = findShard(name);
+  size_t first = index < m_shards.size() ? index : 0;
+  size_t last = index < m_shards.size() ? index + 1 : m_shards.size();
+
+  for (size_t i = first; i < last; ++i) {
+    Shard& shard = *m_shards[i];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shared_ptr<const Data> found = shard.storage->find(name);
+    if (found != nullptr) {
+      return found;
+    }
+  }
+  return nullptr;
+}
+
+void
+InMemoryStorageSharded::erase(const Name& prefix, const bool isPrefix)
+{
+  size_t index = findShard(prefix);
+  if (!isPrefix && index == m_shards.size()) {
+    // a Name shorter than nPrefixComponents is stored in the shard of the whole Name
+    index = getShardIndex(prefix, prefix.size());
+  }
+
+  size_t first = index < m_shards.size() ? index : 0;
+  size_t last = index < m_shards.size() ? index + 1 : m_shards.size();
+
+  for (size_t i = first; i < last; ++i) {
+    Shard& shard = *m_shards[i];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.storage->erase(prefix, isPrefix);
+  }
+}
+
+size_t
+InMemoryStorageSharded::size() const
+{
+  size_t nPackets = 0;
+  for (const unique_ptr<Shard>& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    nPackets += shard->storage->size();
+  }
+  return nPackets;
+}
+
+} // namespace util
+} // namespace ndn
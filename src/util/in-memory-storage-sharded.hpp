@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_IN_MEMORY_STORAGE_SHARDED_HPP
+#define NDN_UTIL_IN_MEMORY_STORAGE_SHARDED_HPP
+
+#include "in-memory-storage.hpp"
+
+#include <mutex>
+
+namespace ndn {
+namespace util {
+
+/** @brief Provides thread-safe in-memory storage partitioned into independently locked shards
+ *
+ *  Each shard is an InMemoryStorage created by a user supplied factory, so that the replacement
+ *  policy (LRU, LFU, FIFO, or none) is applied within every shard.  A Data packet is placed
+ *  into the shard selected by the hash of the first nPrefixComponents components of its Name.
+ *  An Interest or a Name with at least that many components (or ending with an implicit digest)
+ *  is therefore looked up in a single shard, while shorter ones are looked up in every shard
+ *  and the results are merged according to the child selector.
+ *
+ *  Threads operating on different shards do not contend with each other.  Data packets are
+ *  fully decoded and their full names are computed before the shard is locked, which keeps the
+ *  SHA-256 digest out of the critical section and makes stored packets safe to read from any
+ *  thread, as Data computes its full name lazily without synchronization.
+ *
+ *  @note Unlike InMemoryStorage::insert, which computes the implicit digest only when needed,
+ *        every insert computes it, unless the full name of the packet was computed already.
+ *        The ShardedInsertDigest benchmark in tests/benchmarks/in-memory-storage-bench.cpp
+ *        measures this cost.
+ *
+ *  @code
+ *  InMemoryStorageSharded ims([] (size_t limit) {
+ *                               return unique_ptr<InMemoryStorage>(new InMemoryStorageLru(limit));
+ *                             },
+ *                             16, 2, 100000);
+ *  @endcode
+ */
+class InMemoryStorageSharded : noncopyable
+{
+public:
+  /** @brief creates the InMemoryStorage of one shard with the given limit (in packets)
+   */
+  typedef function<unique_ptr<InMemoryStorage>(size_t limit)> ShardFactory;
+
+  /** @brief create a sharded in-memory storage
+   *  @param makeShard creates the storage of each shard
+   *  @param nShards number of shards
+   *  @param nPrefixComponents number of leading Name components that select the shard
+   *  @param limit maximum number of packets, divided among shards so that their limits differ
+   *               by at most one packet and add up to @p limit
+   *  @pre limit >= nShards
+   */
+  InMemoryStorageSharded(const ShardFactory& makeShard, size_t nShards, size_t nPrefixComponents,
+                         size_t limit = std::numeric_limits<size_t>::max());
+
+  /** @brief Inserts a Data packet
+   *
+   *  The full name of @p data is computed, if it was not already, before the shard is locked.
+   *  @sa InMemoryStorage::insert
+   */
+  void
+  insert(const Data& data);
+
+  /** @brief Finds the best match Data for an Interest
+   *  @sa InMemoryStorage::find(const Interest&)
+   */
+  shared_ptr<const Data>
+  find(const Interest& interest);
+
+  /** @brief Finds a Data for a Name with or without the implicit digest
+   *
+   *  If several packets match, a packet will be arbitrarily chosen to return.
+   *  @sa InMemoryStorage::find(const Name&)
+   */
+  shared_ptr<const Data>
+  find(const Name& name);
+
+  /** @brief Deletes in-memory storage entries by prefix by default
+   *  @sa InMemoryStorage::erase
+   */
+  void
+  erase(const Name& prefix, const bool isPrefix = true);
+
+  /** @return{ maximum number of packets that can be allowed to store in in-memory storage }
+   */
+  size_t
+  getLimit() const
+  {
+    return m_limit;
+  }
+
+  /** @return{ number of packets stored in in-memory storage }
+   *  @note The result is a snapshot, as other threads may modify the storage concurrently.
+   */
+  size_t
+  size() const;
+
+  /** @return{ number of shards }
+   */
+  size_t
+  getNShards() const
+  {
+    return m_shards.size();
+  }
+
+  /** @brief Returns the counters of the storage of shard @p index
+   *
+   *  Every find(const Interest&) counts one hit or miss: a lookup across shards counts
+   *  its hit in the shard of the returned packet, and its miss in the shard that would store
+   *  Data named exactly as the Interest.  The latency histogram records only lookups in
+   *  a single shard.  The counters can be read from any thread.
+   *  @pre index < getNShards()
+   */
+  const InMemoryStorageCounters&
+  getShardCounters(size_t index) const
+  {
+    return m_shards[index]->storage->getCounters();
+  }
+
+private:
+  struct Shard
+  {
+    mutable std::mutex mutex;
+    unique_ptr<InMemoryStorage> storage;
+  };
+
+  /** @return{ index of the shard which may contain Data under @p prefix,
+   *           or getNShards() if every shard may contain such Data }
+   */
+  size_t
+  findShard(const Name& prefix) const;
+
+  size_t
+  getShardIndex(const Name& name, size_t nComponents) const
+  {
+    return name.getPrefixHash(std::min(nComponents, m_nPrefixComponents)) % m_shards.size();
+  }
+
+  /** @brief merges a candidate found in one shard into the best match across shards
+   */
+  static void
+  selectCandidate(const Interest& interest, const shared_ptr<const Data>& candidate,
+                  shared_ptr<const Data>& best);
+
+private:
+  std::vector<unique_ptr<Shard>> m_shards;
+  size_t m_nPrefixComponents;
+  size_t m_limit;
+};
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_IN_MEMORY_STORAGE_SHARDED_HPP
@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "in-memory-storage-slru.hpp"
+
+namespace ndn {
+namespace util {
+
+const size_t InMemoryStorageSlru::PROTECTED_PERCENTAGE;
+
+InMemoryStorageSlru::InMemoryStorageSlru(size_t limit)
+  : InMemoryStorage(limit)
+  , m_probationBegin(m_cleanupIndex.get<byUsedTime>().end())
+  , m_nProtected(0)
+{
+}
+
+InMemoryStorageSlru::~InMemoryStorageSlru()
+{
+}
+
+void
+InMemoryStorageSlru::afterInsert(InMemoryStorageEntry* entry)
+{
+  BOOST_ASSERT(m_cleanupIndex.size() <= size());
+  CleanupEntry cleanupEntry;
+  cleanupEntry.entry = entry;
+  cleanupEntry.isProtected = false;
+  m_probationBegin = m_cleanupIndex.get<byUsedTime>().insert(m_probationBegin, cleanupEntry).first;
+}
+
+bool
+InMemoryStorageSlru::evictItem()
+{
+  CleanupIndex::index<byUsedTime>::type& list = m_cleanupIndex.get<byUsedTime>();
+  if (list.empty()) {
+    return false;
+  }
+
+  CleanupIndex::index<byUsedTime>::type::iterator it = --list.end();
+  if (it == m_probationBegin) {
+    ++m_probationBegin;
+  }
+  if (it->isProtected) {
+    --m_nProtected;
+  }
+
+  InMemoryStorageEntry* entry = it->entry;
+  list.erase(it);
+  eraseImpl(entry);
+  return true;
+}
+
+void
+InMemoryStorageSlru::beforeErase(InMemoryStorageEntry* entry)
+{
+  CleanupIndex::index<byEntity>::type::iterator it = m_cleanupIndex.get<byEntity>().find(entry);
+  if (it == m_cleanupIndex.get<byEntity>().end())
+    return;
+
+  if (m_cleanupIndex.project<byUsedTime>(it) == m_probationBegin) {
+    ++m_probationBegin;
+  }
+  if (it->isProtected) {
+    --m_nProtected;
+  }
+  m_cleanupIndex.get<byEntity>().erase(it);
+}
+
+void
+InMemoryStorageSlru::afterAccess(InMemoryStorageEntry* entry)
+{
+  CleanupIndex::index<byUsedTime>::type& list = m_cleanupIndex.get<byUsedTime>();
+  CleanupIndex::index<byUsedTime>::type::iterator it =
+    m_cleanupIndex.project<byUsedTime>(m_cleanupIndex.get<byEntity>().find(entry));
+
+  if (!it->isProtected) {
+    if (it == m_probationBegin) {
+      ++m_probationBegin;
+    }
+    list.modify(it, &setProtected);
+    ++m_nProtected;
+  }
+  list.relocate(list.begin(), it);
+
+  // demote least recently used protected entries to the probationary segment
+  while (m_nProtected * 100 > getCapacity() * PROTECTED_PERCENTAGE) {
+    --m_probationBegin;
+    list.modify(m_probationBegin, &clearProtected);
+    --m_nProtected;
+  }
+}
+
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_IN_MEMORY_STORAGE_SLRU_HPP
+#define NDN_UTIL_IN_MEMORY_STORAGE_SLRU_HPP
+
+#include "in-memory-storage.hpp"
+
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+
+namespace ndn {
+namespace util {
+
+/** @brief Provides an in-memory storage with segmented LRU (SLRU) replacement policy.
+ *
+ *  A newly inserted entry enters the probationary segment, and is promoted to the protected
+ *  segment upon its first access.  When the protected segment outgrows its share of the storage,
+ *  its least recently used entries are demoted back to the most recently used end of the
+ *  probationary segment.  Entries are evicted from the least recently used end of the
+ *  probationary segment, so that a scan over many packets accessed only once cannot flush
+ *  the packets which are accessed repeatedly.
+ *
+ *  Both segments are kept in a single list ordered from the most recently used protected
+ *  entry to the least recently used probationary entry, so that a cache hit only moves an
+ *  entry within the list, which costs O(1) and does not allocate.
+ *  @sa https://en.wikipedia.org/w/index.php?title=Cache_replacement_policies&oldid=692880429#Segmented_LRU_.28SLRU.29
+ */
+class InMemoryStorageSlru : public InMemoryStorage
+{
+public:
+  explicit
+  InMemoryStorageSlru(size_t limit = 10);
+
+  virtual
+  ~InMemoryStorageSlru();
+
+  /// maximum size of the protected segment, in percent of the current capacity
+  static const size_t PROTECTED_PERCENTAGE = 80;
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PROTECTED:
+  /** @brief Removes one Data packet from in-memory storage based on SLRU, i.e. evict the least
+   *  recently used Data packet of the probationary segment, if any, or else of the protected
+   *  segment
+   *  @return{ whether the Data was removed }
+   */
+  virtual bool
+  evictItem();
+
+  /** @brief Update the entry when the entry is returned by the find() function,
+   *  move it to the most recently used end of the protected segment
+   */
+  virtual void
+  afterAccess(InMemoryStorageEntry* entry);
+
+  /** @brief Update the entry after a entry is successfully inserted, add it to the
+   *  most recently used end of the probationary segment
+   */
+  virtual void
+  afterInsert(InMemoryStorageEntry* entry);
+
+  /** @brief Update the entry or other data structures before a entry is successfully erased,
+   *  erase it from the cleanupIndex
+   */
+  virtual void
+  beforeErase(InMemoryStorageEntry* entry);
+
+private:
+  //binds segment and entry together
+  struct CleanupEntry
+  {
+    InMemoryStorageEntry* entry;
+    bool isProtected;
+  };
+
+  static inline void
+  setProtected(CleanupEntry& cleanupEntry)
+  {
+    cleanupEntry.isProtected = true;
+  }
+
+  static inline void
+  clearProtected(CleanupEntry& cleanupEntry)
+  {
+    cleanupEntry.isProtected = false;
+  }
+
+private:
+  //multi_index_container to implement SLRU
+  class byEntity;
+  class byUsedTime;
+
+  typedef boost::multi_index_container<
+    CleanupEntry,
+    boost::multi_index::indexed_by<
+
+      // by Entry itself
+      boost::multi_index::hashed_unique<
+        boost::multi_index::tag<byEntity>,
+        boost::multi_index::member<CleanupEntry, InMemoryStorageEntry*, &CleanupEntry::entry>
+      >,
+
+      // by segment, then by last used time
+      boost::multi_index::sequenced<
+        boost::multi_index::tag<byUsedTime>
+      >
+
+    >
+  > CleanupIndex;
+
+  CleanupIndex m_cleanupIndex;
+  /// first entry of the probationary segment, or end() if it is empty
+  CleanupIndex::index<byUsedTime>::type::iterator m_probationBegin;
+  /// number of entries in the protected segment
+  size_t m_nProtected;
+};
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_IN_MEMORY_STORAGE_SLRU_HPP
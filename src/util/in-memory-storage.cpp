@@ -29,6 +29,9 @@
 namespace ndn {
 namespace util {
 
+const time::nanoseconds InMemoryStorage::DEFAULT_SWEEP_PERIOD = time::seconds(1);
+const size_t InMemoryStorage::DEFAULT_MAX_PACKETS_PER_SWEEP = 1000;
+
 InMemoryStorage::const_iterator::const_iterator(const Data* ptr, const Cache* cache,
                                                 Cache::index<byFullName>::type::iterator it)
   : m_ptr(ptr)
@@ -86,6 +89,12 @@ InMemoryStorage::const_iterator::operator!=(const const_iterator& rhs)
 InMemoryStorage::InMemoryStorage(size_t limit)
   : m_limit(limit)
   , m_nPackets(0)
+  , m_byteLimit(std::numeric_limits<size_t>::max())
+  , m_nPayloadBytes(0)
+  , m_nEntryOverheadBytes(0)
+  , m_scheduler(nullptr)
+  , m_nMaxPacketsPerSweep(DEFAULT_MAX_PACKETS_PER_SWEEP)
+  , m_isLatencyHistogramEnabled(false)
 {
   // TODO consider a more suitable initial value
   m_capacity = 10;
@@ -101,6 +110,8 @@ InMemoryStorage::InMemoryStorage(size_t limit)
 
 InMemoryStorage::~InMemoryStorage()
 {
+  stopSweep();
+
   // evict all items from cache
   Cache::iterator it = m_cache.begin();
   while (it != m_cache.end()) {
@@ -120,11 +131,14 @@ InMemoryStorage::setCapacity(size_t capacity)
 {
   size_t oldCapacity = m_capacity;
   m_capacity = capacity;
+  if (m_capacity != oldCapacity) {
+    m_counters.resized();
+  }
 
   if (size() > m_capacity) {
     ssize_t nAllowedFailures = size() - m_capacity;
     while (size() > m_capacity) {
-      if (!evictItem() && --nAllowedFailures < 0) {
+      if (!evict(InMemoryStorageCounters::EVICTION_CAPACITY) && --nAllowedFailures < 0) {
         throw Error();
       }
     }
@@ -145,13 +159,41 @@ InMemoryStorage::setCapacity(size_t capacity)
   BOOST_ASSERT(size() + m_freeEntries.size() == m_capacity);
 }
 
+void
+InMemoryStorage::setByteLimit(size_t nMaxBytes)
+{
+  m_byteLimit = nMaxBytes;
+  evictBytes(0);
+}
+
+void
+InMemoryStorage::evictBytes(size_t nBytesNeeded)
+{
+  while (size() > 0 && getNBytes() + nBytesNeeded > m_byteLimit) {
+    if (!evict(InMemoryStorageCounters::EVICTION_BYTE_LIMIT))
+      break;
+  }
+}
+
+bool
+InMemoryStorage::evict(InMemoryStorageCounters::EvictionCause cause)
+{
+  if (!evictItem())
+    return false;
+
+  m_counters.evicted(cause);
+  return true;
+}
+
 void
 InMemoryStorage::insert(const Data& data)
 {
   //check if identical Data/Name already exists
-  Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>().find(data.getFullName());
-  if (it != m_cache.get<byFullName>().end())
+  Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>().find(data);
+  if (it != m_cache.get<byFullName>().end()) {
+    m_counters.duplicateInserted();
     return;
+  }
 
   //if full, double the capacity
   bool doesReachLimit = (getLimit() == getCapacity());
@@ -163,7 +205,7 @@ InMemoryStorage::insert(const Data& data)
 
   //if full and reach limitation of the capacity, employ replacement policy
   if (isFull() && doesReachLimit) {
-    evictItem();
+    evict(InMemoryStorageCounters::EVICTION_LIMIT);
   }
 
   //insert to cache
@@ -171,14 +213,101 @@ InMemoryStorage::insert(const Data& data)
   // take entry for the memory pool
   InMemoryStorageEntry* entry = m_freeEntries.top();
   m_freeEntries.pop();
-  m_nPackets++;
   entry->setData(data);
+
+  //if the packet does not fit into the byte limit, employ replacement policy
+  size_t nPayloadBytes = entry->getPayloadSize();
+  size_t nOverheadBytes = entry->getOverheadSize();
+  evictBytes(nPayloadBytes + nOverheadBytes);
+
+  m_nPackets++;
+  m_nPayloadBytes += nPayloadBytes;
+  m_nEntryOverheadBytes += nOverheadBytes;
   m_cache.insert(entry);
+  m_counters.inserted();
 
   //let derived class do something with the entry
   afterInsert(entry);
 }
 
+static bool
+compareFullNames(const Data* a, const Data* b)
+{
+  return InMemoryStorageEntry::compareFullNames(*a, *b) < 0;
+}
+
+void
+InMemoryStorage::insertBatchImpl(std::vector<const Data*>& datas)
+{
+  if (!std::is_sorted(datas.begin(), datas.end(), &compareFullNames)) {
+    std::sort(datas.begin(), datas.end(), &compareFullNames);
+  }
+
+  //grow the capacity once for the whole batch
+  size_t nMaxPackets = std::min(size() + datas.size(), getLimit());
+  if (nMaxPackets > getCapacity()) {
+    setCapacity(nMaxPackets);
+  }
+
+  // hint is the insertion position of the current packet (lower bound of its full name),
+  // which stays valid along a sorted run unless the cache has entries in between
+  // or packets are evicted
+  Cache::index<byFullName>::type& index = m_cache.get<byFullName>();
+  Cache::index<byFullName>::type::iterator hint = index.end();
+  const Data* previous = nullptr;
+  for (const Data* data : datas) {
+    //duplicates within the batch are adjacent
+    if (previous != nullptr && InMemoryStorageEntry::compareFullNames(*previous, *data) == 0) {
+      m_counters.duplicateInserted();
+      continue;
+    }
+    previous = data;
+
+    // after an insertion, the entry before hint is the previous packet, which precedes this one;
+    // so only the entry at hint needs checking, or the last entry when appending at the end
+    bool isHintLowerBound = hint != index.end() ?
+                            (*hint)->compareFullName(*data) >= 0 :
+                            index.empty() || (*std::prev(hint))->compareFullName(*data) < 0;
+    if (!isHintLowerBound) {
+      hint = index.lower_bound(*data);
+    }
+
+    //check if identical Data/Name already exists
+    if (hint != index.end() && (*hint)->compareFullName(*data) == 0) {
+      m_counters.duplicateInserted();
+      continue;
+    }
+
+    size_t nPackets = size();
+    //if full and reach limitation of the capacity, employ replacement policy
+    if (isFull()) {
+      evict(InMemoryStorageCounters::EVICTION_LIMIT);
+    }
+
+    InMemoryStorageEntry* entry = m_freeEntries.top();
+    m_freeEntries.pop();
+    entry->setData(*data);
+
+    size_t nPayloadBytes = entry->getPayloadSize();
+    size_t nOverheadBytes = entry->getOverheadSize();
+    evictBytes(nPayloadBytes + nOverheadBytes);
+
+    if (size() != nPackets) {
+      // an evicted packet may have been the hint
+      hint = index.lower_bound(*data);
+    }
+
+    m_nPackets++;
+    m_nPayloadBytes += nPayloadBytes;
+    m_nEntryOverheadBytes += nOverheadBytes;
+    hint = std::next(index.insert(hint, entry));
+    m_counters.inserted();
+
+    //let derived class do something with the entry
+    afterInsert(entry);
+  }
+}
+
 shared_ptr<const Data>
 InMemoryStorage::find(const Name& name)
 {
@@ -190,7 +319,7 @@ InMemoryStorage::find(const Name& name)
   }
 
   //if the given name is not the prefix of the lower_bound, return null
-  if (!name.isPrefixOf((*it)->getFullName())) {
+  if (!(*it)->hasFullNamePrefix(name)) {
     return shared_ptr<const Data>();
   }
 
@@ -200,6 +329,40 @@ InMemoryStorage::find(const Name& name)
 
 shared_ptr<const Data>
 InMemoryStorage::find(const Interest& interest)
+{
+  time::steady_clock::TimePoint startTime;
+  if (m_isLatencyHistogramEnabled) {
+    startTime = time::steady_clock::now();
+  }
+
+  shared_ptr<const Data> found;
+  InMemoryStorageEntry* ret = findEntry(interest);
+  countLookup(ret != 0);
+  if (ret != 0) {
+    //let derived class do something with the entry
+    afterAccess(ret);
+    found = ret->getData().shared_from_this();
+  }
+
+  if (m_isLatencyHistogramEnabled) {
+    m_counters.lookedUp(time::steady_clock::now() - startTime);
+  }
+  return found;
+}
+
+void
+InMemoryStorage::countLookup(bool isHit)
+{
+  if (isHit) {
+    m_counters.hit();
+  }
+  else {
+    m_counters.miss();
+  }
+}
+
+InMemoryStorageEntry*
+InMemoryStorage::findEntry(const Interest& interest) const
 {
   //if the interest contains implicit digest, it is possible to directly locate a packet.
   Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>()
@@ -207,7 +370,10 @@ InMemoryStorage::find(const Interest& interest)
 
   //if a packet is located by its full name, it must be the packet to return.
   if (it != m_cache.get<byFullName>().end()) {
-    return ((*it)->getData()).shared_from_this();
+    if (interest.getMustBeFresh() && !(*it)->isFresh(time::steady_clock::now())) {
+      return 0;
+    }
+    return *it;
   }
 
   //if the packet is not discovered by last step, either the packet is not in the storage or
@@ -215,7 +381,7 @@ InMemoryStorage::find(const Interest& interest)
   it = m_cache.get<byFullName>().lower_bound(interest.getName());
 
   if (it == m_cache.get<byFullName>().end()) {
-    return shared_ptr<const Data>();
+    return 0;
   }
 
 
@@ -223,15 +389,7 @@ InMemoryStorage::find(const Interest& interest)
   if (it != m_cache.get<byFullName>().begin())
     it--;
 
-  InMemoryStorageEntry* ret = selectChild(interest, it);
-  if (ret != 0) {
-    //let derived class do something with the entry
-    afterAccess(ret);
-    return ret->getData().shared_from_this();
-  }
-  else {
-    return shared_ptr<const Data>();
-  }
+  return selectChild(interest, it);
 }
 
 InMemoryStorageEntry*
@@ -242,15 +400,20 @@ InMemoryStorage::selectChild(const Interest& interest,
 
   if (startingPoint != m_cache.get<byFullName>().begin())
     {
-      BOOST_ASSERT((*startingPoint)->getFullName() < interest.getName());
+      BOOST_ASSERT((*startingPoint)->compareFullName(interest.getName()) < 0);
     }
 
+  time::steady_clock::TimePoint now;
+  if (interest.getMustBeFresh()) {
+    now = time::steady_clock::now();
+  }
+
   bool hasLeftmostSelector = (interest.getChildSelector() <= 0);
   bool hasRightmostSelector = !hasLeftmostSelector;
 
   if (hasLeftmostSelector)
     {
-      if (interest.matchesData((*startingPoint)->getData()))
+      if (canSatisfy(interest, **startingPoint, now))
         {
           return *startingPoint;
         }
@@ -271,12 +434,12 @@ InMemoryStorage::selectChild(const Interest& interest,
           bool isInPrefix = false;
           if (isInBoundaries)
             {
-              isInPrefix = interest.getName().isPrefixOf((*rightmostCandidate)->getFullName());
+              isInPrefix = (*rightmostCandidate)->hasFullNamePrefix(interest.getName());
             }
 
           if (isInPrefix)
             {
-              if (interest.matchesData((*rightmostCandidate)->getData()))
+              if (canSatisfy(interest, **rightmostCandidate, now))
                 {
                   if (hasLeftmostSelector)
                     {
@@ -285,9 +448,14 @@ InMemoryStorage::selectChild(const Interest& interest,
 
                   if (hasRightmostSelector)
                     {
-                      // get prefix which is one component longer than Interest name
-                      const Name& childPrefix = (*rightmostCandidate)->getFullName()
-                                                  .getPrefix(interest.getName().size() + 1);
+                      // get prefix which is one component longer than Interest name;
+                      // the implicit digest is needed only if it is that component
+                      size_t childPrefixLength = interest.getName().size() + 1;
+                      const Name& candidateName = (*rightmostCandidate)->getName();
+                      const Name& childPrefix = (childPrefixLength <= candidateName.size() ?
+                                                 candidateName :
+                                                 (*rightmostCandidate)->getFullName())
+                                                  .getPrefix(childPrefixLength);
 
                       if (currentChildPrefix.empty() || (childPrefix != currentChildPrefix))
                         {
@@ -309,7 +477,7 @@ InMemoryStorage::selectChild(const Interest& interest,
 
   if (hasRightmostSelector) // if rightmost was not found, try starting point
     {
-      if (interest.matchesData((*startingPoint)->getData()))
+      if (canSatisfy(interest, **startingPoint, now))
         {
           return *startingPoint;
         }
@@ -318,27 +486,62 @@ InMemoryStorage::selectChild(const Interest& interest,
   return 0;
 }
 
+bool
+InMemoryStorage::canSatisfy(const Interest& interest, const InMemoryStorageEntry& entry,
+                            const time::steady_clock::TimePoint& now)
+{
+  if (interest.getMustBeFresh() && !entry.isFresh(now)) {
+    return false;
+  }
+  return interest.matchesData(entry.getData());
+}
+
 InMemoryStorage::Cache::iterator
 InMemoryStorage::freeEntry(Cache::iterator it)
 {
+  releaseEntry(*it);
+  return m_cache.erase(it);
+}
+
+void
+InMemoryStorage::releaseEntry(InMemoryStorageEntry* entry)
+{
+  m_nPayloadBytes -= entry->getPayloadSize();
+  m_nEntryOverheadBytes -= entry->getOverheadSize();
+
   //push the *empty* entry into mem pool
-  (*it)->release();
-  m_freeEntries.push(*it);
+  entry->release();
+  m_freeEntries.push(entry);
   m_nPackets--;
-  return m_cache.erase(it);
 }
 
 void
 InMemoryStorage::erase(const Name& prefix, const bool isPrefix)
 {
   if (isPrefix) {
-    Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>().lower_bound(prefix);
+    // every Name under the prefix is less than the successor of the prefix
+    Cache::index<byFullName>::type& index = m_cache.get<byFullName>();
+    Cache::index<byFullName>::type::iterator first = index.lower_bound(prefix);
+    Cache::index<byFullName>::type::iterator last = prefix.empty() ?
+                                                    index.end() :
+                                                    index.lower_bound(prefix.getSuccessor());
+    if (first == last)
+      return;
 
-    while (it != m_cache.get<byFullName>().end() && prefix.isPrefixOf((*it)->getName())) {
+    std::vector<InMemoryStorageEntry*> entries;
+    for (Cache::index<byFullName>::type::iterator it = first; it != last; ++it) {
       //let derived class do something with the entry
       beforeErase(*it);
-      it = freeEntry(it);
+      entries.push_back(*it);
     }
+    index.erase(first, last);
+
+    for (InMemoryStorageEntry* entry : entries) {
+      releaseEntry(entry);
+      m_counters.erased();
+    }
+
+    shrinkCapacity();
   }
   else {
     Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>().find(prefix);
@@ -349,10 +552,86 @@ InMemoryStorage::erase(const Name& prefix, const bool isPrefix)
     //let derived class do something with the entry
     beforeErase(*it);
     freeEntry(it);
+    m_counters.erased();
+
+    if (m_freeEntries.size() > (2 * size()))
+      setCapacity(getCapacity() / 2);
   }
+}
+
+void
+InMemoryStorage::shrinkCapacity()
+{
+  if (m_freeEntries.size() <= 2 * size())
+    return;
 
-  if (m_freeEntries.size() > (2 * size()))
+  // halve the capacity until free entries are no more than twice the stored packets
+  size_t newCapacity = getCapacity();
+  while (newCapacity > 1 && newCapacity - size() > 2 * size()) {
+    newCapacity /= 2;
+  }
+  setCapacity(newCapacity);
+}
+
+bool
+InMemoryStorage::eraseExpired(const time::nanoseconds& maxAge, size_t nMaxPackets)
+{
+  time::steady_clock::TimePoint insertedBefore = time::steady_clock::now() - maxAge;
+
+  // packets are ordered by insertion time, so only expired packets are visited
+  Cache::index<byArrival>::type& arrivals = m_cache.get<byArrival>();
+  bool isComplete = true;
+  size_t nErased = 0;
+  while (!arrivals.empty() && arrivals.front()->getInsertionTime() <= insertedBefore) {
+    if (nErased == nMaxPackets) {
+      isComplete = false;
+      break;
+    }
+
+    //let derived class do something with the entry
+    beforeErase(arrivals.front());
+    freeEntry(m_cache.project<byFullName>(arrivals.begin()));
+    m_counters.evicted(InMemoryStorageCounters::EVICTION_EXPIRED);
+    ++nErased;
+  }
+
+  if (nErased > 0 && m_freeEntries.size() > (2 * size()))
     setCapacity(getCapacity() / 2);
+
+  return isComplete;
+}
+
+void
+InMemoryStorage::startSweep(Scheduler& scheduler, const time::nanoseconds& maxAge,
+                            const time::nanoseconds& sweepPeriod, size_t nMaxPacketsPerSweep)
+{
+  stopSweep();
+
+  m_scheduler = &scheduler;
+  m_maxAge = maxAge;
+  m_sweepPeriod = sweepPeriod;
+  m_nMaxPacketsPerSweep = nMaxPacketsPerSweep;
+  m_sweepEvent = m_scheduler->scheduleEvent(m_sweepPeriod, bind(&InMemoryStorage::sweep, this));
+}
+
+void
+InMemoryStorage::stopSweep()
+{
+  if (m_scheduler == nullptr)
+    return;
+
+  m_scheduler->cancelEvent(m_sweepEvent);
+  m_scheduler = nullptr;
+}
+
+void
+InMemoryStorage::sweep()
+{
+  bool isComplete = eraseExpired(m_maxAge, m_nMaxPacketsPerSweep);
+
+  // an incomplete sweep continues right after other pending events
+  time::nanoseconds delay = isComplete ? m_sweepPeriod : time::nanoseconds::zero();
+  m_sweepEvent = m_scheduler->scheduleEvent(delay, bind(&InMemoryStorage::sweep, this));
 }
 
 void
@@ -366,6 +645,15 @@ InMemoryStorage::eraseImpl(const Name& name)
   freeEntry(it);
 }
 
+void
+InMemoryStorage::eraseImpl(InMemoryStorageEntry* entry)
+{
+  Cache::index<byFullName>::type::iterator it = m_cache.get<byFullName>().find(entry);
+  BOOST_ASSERT(it != m_cache.get<byFullName>().end());
+
+  freeEntry(it);
+}
+
 InMemoryStorage::const_iterator
 InMemoryStorage::begin() const
 {
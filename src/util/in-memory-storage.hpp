@@ -27,6 +27,8 @@
 #include "../data.hpp"
 
 #include "in-memory-storage-entry.hpp"
+#include "in-memory-storage-counters.hpp"
+#include "scheduler.hpp"
 
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index_container.hpp>
@@ -46,8 +48,48 @@ namespace util {
 class InMemoryStorage : noncopyable
 {
 public:
+  /** @brief Orders entries by full name, computing implicit digests only when needed
+   *
+   *  Entries can be looked up by a Name, which may or may not end with an implicit digest,
+   *  or by a Data packet.
+   */
+  class FullNameCompare
+  {
+  public:
+    bool
+    operator()(const InMemoryStorageEntry* lhs, const InMemoryStorageEntry* rhs) const
+    {
+      return lhs->compareFullName(rhs->getData()) < 0;
+    }
+
+    bool
+    operator()(const InMemoryStorageEntry* lhs, const Name& rhs) const
+    {
+      return lhs->compareFullName(rhs) < 0;
+    }
+
+    bool
+    operator()(const Name& lhs, const InMemoryStorageEntry* rhs) const
+    {
+      return rhs->compareFullName(lhs) > 0;
+    }
+
+    bool
+    operator()(const InMemoryStorageEntry* lhs, const Data& rhs) const
+    {
+      return lhs->compareFullName(rhs) < 0;
+    }
+
+    bool
+    operator()(const Data& lhs, const InMemoryStorageEntry* rhs) const
+    {
+      return rhs->compareFullName(lhs) > 0;
+    }
+  };
+
   //multi_index_container to implement storage
   class byFullName;
+  class byArrival;
 
   typedef boost::multi_index_container<
     InMemoryStorageEntry*,
@@ -56,9 +98,13 @@ public:
       // by Full Name
       boost::multi_index::ordered_unique<
         boost::multi_index::tag<byFullName>,
-        boost::multi_index::const_mem_fun<InMemoryStorageEntry, const Name&,
-                                          &InMemoryStorageEntry::getFullName>,
-        std::less<Name>
+        boost::multi_index::identity<InMemoryStorageEntry*>,
+        FullNameCompare
+      >,
+
+      // by insertion time
+      boost::multi_index::sequenced<
+        boost::multi_index::tag<byArrival>
       >
 
     >
@@ -119,6 +165,9 @@ public:
   ~InMemoryStorage();
 
   /** @brief Inserts a Data packet
+   *
+   *  The implicit digest of the packet is not computed, unless a stored packet has the same
+   *  name or an Interest needs it.
    *
    *  @note Packets are considered duplicate if the name with implicit digest matches.
    *  The new Data packet with the identical name, but a different payload
@@ -129,7 +178,32 @@ public:
   void
   insert(const Data& data);
 
+  /** @brief Inserts a range of Data packets
+   *
+   *  This is equivalent to inserting every packet with insert(const Data&), except for the
+   *  order in which packets are inserted, and thus evicted.  Packets are sorted by full name,
+   *  and the capacity is grown once for the whole batch.  A sorted run of packets that are
+   *  adjacent in the storage, such as the segments of an object, is inserted in amortized
+   *  constant time per packet after the first.
+   *
+   *  @tparam InputIterator iterator over (smart) pointers to Data
+   *  @note It will invoke afterInsert(shared_ptr<InMemoryStorageEntry>) for every packet.
+   */
+  template<typename InputIterator>
+  void
+  insertBatch(InputIterator first, InputIterator last)
+  {
+    std::vector<const Data*> datas;
+    for (; first != last; ++first) {
+      datas.push_back(&static_cast<const Data&>(**first));
+    }
+    insertBatchImpl(datas);
+  }
+
   /** @brief Finds the best match Data for an Interest
+   *
+   *  If the Interest has MustBeFresh, packets whose FreshnessPeriod has elapsed since
+   *  their insertion are not returned.
    *
    *  @note It will invoke afterAccess(shared_ptr<InMemoryStorageEntry>).
    *  As currently it is impossible to determine whether a Name contains implicit digest or not,
@@ -161,6 +235,9 @@ public:
    *  entry completely matched with the prefix according to canonical ordering.
    *  For this case, user should substitute the prefix with full name.
    *
+   *  If @p isPrefix is set, the subtree under @p prefix is removed from the index as one range,
+   *  and the capacity is reduced at most once.
+   *
    *  @note Please do not use this function directly in any derived class to erase
    *  entry in the cache, use eraseHelper instead.
    *  @note It will invoke beforeErase(shared_ptr<InMemoryStorageEntry>).
@@ -184,6 +261,100 @@ public:
     return m_nPackets;
   }
 
+  /** @brief sets maximum memory usage of in-memory storage (in bytes)
+   *
+   *  Packets are evicted according to the replacement policy until getNBytes() fits the limit,
+   *  here and upon every insertion.  A storage that does not evict (InMemoryStoragePersistent)
+   *  can exceed the limit.
+   */
+  void
+  setByteLimit(size_t nMaxBytes);
+
+  /** @return{ maximum memory usage of in-memory storage (in bytes) }
+   */
+  size_t
+  getByteLimit() const
+  {
+    return m_byteLimit;
+  }
+
+  /** @return{ total size of wire encodings of packets stored in in-memory storage }
+   */
+  size_t
+  getNPayloadBytes() const
+  {
+    return m_nPayloadBytes;
+  }
+
+  /** @return{ estimated memory used by in-memory storage in addition to wire encodings,
+   *           i.e. decoded packets, index nodes and the pool of entries }
+   */
+  size_t
+  getNOverheadBytes() const
+  {
+    return m_nEntryOverheadBytes + m_capacity * sizeof(InMemoryStorageEntry);
+  }
+
+  /** @return{ estimated memory used by in-memory storage (in bytes) }
+   */
+  size_t
+  getNBytes() const
+  {
+    return getNPayloadBytes() + getNOverheadBytes();
+  }
+
+  /** @brief Starts periodic removal of packets inserted more than @p maxAge ago
+   *
+   *  Every @p sweepPeriod, expired packets are removed in the order of their insertion, so that
+   *  a sweep visits only the packets it removes.  A sweep removes at most @p nMaxPacketsPerSweep
+   *  packets; if more are expired, the next sweep is scheduled immediately, which lets other
+   *  events on the io_service run in between.  Calling it again replaces the previous settings.
+   *
+   *  @param scheduler schedules sweeps; it must remain valid until stopSweep() is called or
+   *                   the in-memory storage is destroyed
+   *  @note It will invoke beforeErase(shared_ptr<InMemoryStorageEntry>).
+   */
+  void
+  startSweep(Scheduler& scheduler, const time::nanoseconds& maxAge,
+             const time::nanoseconds& sweepPeriod = DEFAULT_SWEEP_PERIOD,
+             size_t nMaxPacketsPerSweep = DEFAULT_MAX_PACKETS_PER_SWEEP);
+
+  /** @brief Stops periodic removal of expired packets
+   */
+  void
+  stopSweep();
+
+  /** @brief Removes at most @p nMaxPackets packets inserted more than @p maxAge ago
+   *  @return{ whether all expired packets have been removed }
+   *  @note It will invoke beforeErase(shared_ptr<InMemoryStorageEntry>).
+   */
+  bool
+  eraseExpired(const time::nanoseconds& maxAge,
+               size_t nMaxPackets = std::numeric_limits<size_t>::max());
+
+  static const time::nanoseconds DEFAULT_SWEEP_PERIOD;
+  static const size_t DEFAULT_MAX_PACKETS_PER_SWEEP;
+
+  /** @brief Returns the counters of in-memory storage operations
+   *
+   *  Hits and misses count invocations of find(const Interest&).
+   *  The counters can be read from any thread.
+   */
+  const InMemoryStorageCounters&
+  getCounters() const
+  {
+    return m_counters;
+  }
+
+  /** @brief Enables or disables recording the latency of find(const Interest&) into
+   *  the histogram of the counters
+   */
+  void
+  enableLatencyHistogram(bool isEnabled = true)
+  {
+    m_isLatencyHistogramEnabled = isEnabled;
+  }
+
   /** @brief Returns begin iterator of the in-memory storage ordering by
    *  name with digest
    *
@@ -254,6 +425,18 @@ NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PROTECTED:
     return size() >= m_capacity;
   }
 
+  /** @brief evicts packets according to the replacement policy until
+   *  @p nBytesNeeded more bytes fit into the byte limit, or nothing can be evicted
+   */
+  void
+  evictBytes(size_t nBytesNeeded);
+
+  /** @brief evicts a packet according to the replacement policy, and counts the eviction
+   *  @return{ whether a packet was evicted }
+   */
+  bool
+  evict(InMemoryStorageCounters::EvictionCause cause);
+
   /** @brief deletes in-memory storage entries by the Name with implicit digest.
    *
    *  This is the function one should use to erase entry in the cache
@@ -263,18 +446,53 @@ NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PROTECTED:
   void
   eraseImpl(const Name& name);
 
+  /** @brief deletes an in-memory storage entry
+   *
+   *  Unlike eraseImpl(const Name&), it does not compute the implicit digest of the entry.
+   *  It won't invoke beforeErase(shared_ptr<Entry>).
+   */
+  void
+  eraseImpl(InMemoryStorageEntry* entry);
+
   /** @brief Prints contents of the in-memory storage
    */
   void
   printCache(std::ostream& os) const;
 
 NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  void
+  insertBatchImpl(std::vector<const Data*>& datas);
+
+  /** @brief reduces the capacity after packets are removed, until the pool of free entries
+   *  is no larger than twice the number of stored packets
+   */
+  void
+  shrinkCapacity();
+
+  /** @brief Finds the best match entry for an Interest without invoking afterAccess
+   *  @return{ the best match, if any; otherwise 0 }
+   */
+  InMemoryStorageEntry*
+  findEntry(const Interest& interest) const;
+
+  /** @brief counts a hit or a miss of find(const Interest&)
+   *
+   *  InMemoryStorageSharded also counts lookups that it makes across shards with findEntry.
+   */
+  void
+  countLookup(bool isHit);
+
   /** @brief free in-memory storage entries by an iterator pointing to that entry.
       @return An iterator pointing to the element that followed the last element erased.
    */
   Cache::iterator
   freeEntry(Cache::iterator it);
 
+  /** @brief returns an entry to the pool without removing it from m_cache
+   */
+  void
+  releaseEntry(InMemoryStorageEntry* entry);
+
   /** @brief Implements child selector (leftmost, rightmost, undeclared).
    *  Operates on the first layer of a skip list.
    *
@@ -293,7 +511,19 @@ NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   selectChild(const Interest& interest,
               Cache::index<byFullName>::type::iterator startingPoint) const;
 
+  /** @brief Checks whether @p entry satisfies @p interest, including MustBeFresh
+   *  @param now current time, used only if the Interest has MustBeFresh
+   */
+  static bool
+  canSatisfy(const Interest& interest, const InMemoryStorageEntry& entry,
+             const time::steady_clock::TimePoint& now);
+
+  void
+  sweep();
+
 private:
+  friend class InMemoryStorageSharded;
+
   Cache m_cache;
   /// user defined maximum capacity of the in-memory storage in packets
   size_t m_limit;
@@ -301,8 +531,23 @@ private:
   size_t m_capacity;
   /// current number of packets in in-memory storage
   size_t m_nPackets;
+  /// user defined maximum memory usage of the in-memory storage in bytes
+  size_t m_byteLimit;
+  /// current size of wire encodings of packets in in-memory storage
+  size_t m_nPayloadBytes;
+  /// current estimated memory used by entries in addition to wire encodings
+  size_t m_nEntryOverheadBytes;
   /// memory pool
   std::stack<InMemoryStorageEntry*> m_freeEntries;
+
+  Scheduler* m_scheduler;
+  EventId m_sweepEvent;
+  time::nanoseconds m_maxAge;
+  time::nanoseconds m_sweepPeriod;
+  size_t m_nMaxPacketsPerSweep;
+
+  InMemoryStorageCounters m_counters;
+  bool m_isLatencyHistogramEnabled;
 };
 
 } // namespace util
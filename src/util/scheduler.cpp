@@ -23,22 +23,29 @@
 
 #include "scheduler.hpp"
 
+#include <algorithm>
+
 namespace ndn {
 namespace util {
 namespace scheduler {
 
 struct EventIdImpl
 {
-  EventIdImpl(const Scheduler::EventQueue::iterator& event)
+  explicit
+  EventIdImpl(const Scheduler::Event& event)
     : m_event(event)
     , m_isValid(true)
   {
   }
 
+  /**
+   * \brief Mark the event as fired or cancelled, and release the function
+   */
   void
   invalidate()
   {
     m_isValid = false;
+    m_event = nullptr;
   }
 
   bool
@@ -47,51 +54,128 @@ struct EventIdImpl
     return m_isValid;
   }
 
-  operator const Scheduler::EventQueue::iterator&() const
+  Scheduler::Event m_event;
+
+private:
+  bool m_isValid;
+};
+
+/**
+ * \brief Free list of memory blocks that hold an EventIdImpl and its reference count
+ *
+ * All blocks allocated by std::allocate_shared for an EventIdImpl have the same size,
+ * which is learned upon the first allocation.
+ */
+class Scheduler::EventPool : noncopyable
+{
+public:
+  EventPool()
+    : m_blockSize(0)
   {
-    return m_event;
+  }
+
+  ~EventPool()
+  {
+    for (void* block : m_freeBlocks) {
+      ::operator delete(block);
+    }
+  }
+
+  void*
+  allocate(size_t size)
+  {
+    if (m_blockSize == 0) {
+      m_blockSize = size;
+    }
+
+    if (size != m_blockSize || m_freeBlocks.empty()) {
+      return ::operator new(size);
+    }
+
+    void* block = m_freeBlocks.back();
+    m_freeBlocks.pop_back();
+    return block;
   }
 
   void
-  reset(const Scheduler::EventQueue::iterator& newIterator)
+  deallocate(void* block, size_t size)
   {
-    m_event = newIterator;
-    m_isValid = true;
+    if (size != m_blockSize || m_freeBlocks.size() >= MAX_FREE_BLOCKS) {
+      ::operator delete(block);
+      return;
+    }
+
+    m_freeBlocks.push_back(block);
   }
 
 private:
-  Scheduler::EventQueue::iterator m_event;
-  bool m_isValid;
+  static const size_t MAX_FREE_BLOCKS = 65536;
+
+  size_t m_blockSize;
+  std::vector<void*> m_freeBlocks;
 };
 
-Scheduler::EventInfo::EventInfo(const time::nanoseconds& after,
-                                const Event& event)
-  : m_scheduledTime(time::steady_clock::now() + after)
-  , m_event(event)
+/**
+ * \brief Allocator for std::allocate_shared that draws from an EventPool
+ *
+ * The allocator is stored alongside the reference count of each EventId, so the pool
+ * lives as long as the Scheduler or any EventId of its events.
+ */
+template<typename T>
+class Scheduler::EventAllocator
 {
-}
+public:
+  typedef T value_type;
 
-Scheduler::EventInfo::EventInfo(const time::steady_clock::TimePoint& when,
-                                const EventInfo& previousEvent)
-  : m_scheduledTime(when)
-  , m_event(previousEvent.m_event)
-  , m_eventId(previousEvent.m_eventId)
-{
-}
+  explicit
+  EventAllocator(const shared_ptr<EventPool>& pool)
+    : m_pool(pool)
+  {
+  }
 
-time::nanoseconds
-Scheduler::EventInfo::expiresFromNow() const
-{
-  time::steady_clock::TimePoint now = time::steady_clock::now();
-  if (now > m_scheduledTime)
-    return time::seconds(0); // event should be scheduled ASAP
-  else
-    return m_scheduledTime - now;
-}
+  template<typename U>
+  EventAllocator(const EventAllocator<U>& other)
+    : m_pool(other.m_pool)
+  {
+  }
 
+  T*
+  allocate(size_t n)
+  {
+    return static_cast<T*>(m_pool->allocate(n * sizeof(T)));
+  }
+
+  void
+  deallocate(T* p, size_t n)
+  {
+    m_pool->deallocate(p, n * sizeof(T));
+  }
+
+  template<typename U>
+  bool
+  operator==(const EventAllocator<U>& other) const
+  {
+    return m_pool == other.m_pool;
+  }
+
+  template<typename U>
+  bool
+  operator!=(const EventAllocator<U>& other) const
+  {
+    return m_pool != other.m_pool;
+  }
+
+private:
+  shared_ptr<EventPool> m_pool;
+
+  template<typename U>
+  friend class EventAllocator;
+};
 
 Scheduler::Scheduler(boost::asio::io_service& ioService)
-  : m_scheduledEvent(m_events.end())
+  : m_nCancelledEvents(0)
+  , m_nextSeqNo(0)
+  , m_pool(make_shared<EventPool>())
   , m_deadlineTimer(ioService)
   , m_isEventExecuting(false)
 {
@@ -101,24 +185,16 @@ EventId
 Scheduler::scheduleEvent(const time::nanoseconds& after,
                          const Event& event)
 {
-  EventQueue::iterator i = m_events.insert(EventInfo(after, event));
+  EventId eventId = std::allocate_shared<EventIdImpl>(EventAllocator<EventIdImpl>(m_pool), event);
+  pushEvent(EventInfo{time::steady_clock::now() + after, m_nextSeqNo++, eventId});
 
-  // On OSX 10.9, boost, and C++03 the following doesn't work without ndn::
-  // because the argument-dependent lookup prefers STL to boost
-  i->m_eventId = ndn::make_shared<EventIdImpl>(i);
-
-  if (!m_isEventExecuting)
-    {
-      if (m_scheduledEvent == m_events.end() ||
-          *i < *m_scheduledEvent)
-        {
-          m_deadlineTimer.expires_from_now(after);
-          m_deadlineTimer.async_wait(bind(&Scheduler::onEvent, this, _1));
-          m_scheduledEvent = i;
-        }
-    }
+  // a new earliest event requires the timer to be rearmed,
+  // unless onEvent is executing events and will rearm it afterwards
+  if (!m_isEventExecuting && m_events.front().m_eventId == eventId) {
+    scheduleNext();
+  }
 
-  return i->m_eventId;
+  return eventId;
 }
 
 void
@@ -127,35 +203,30 @@ Scheduler::cancelEvent(const EventId& eventId)
   if (!static_cast<bool>(eventId) || !eventId->isValid())
     return; // event already fired or cancelled
 
-  if (static_cast<EventQueue::iterator>(*eventId) != m_scheduledEvent) {
-    m_events.erase(*eventId);
-    eventId->invalidate();
-    return;
-  }
-
-  m_deadlineTimer.cancel();
-  m_events.erase(static_cast<EventQueue::iterator>(*eventId));
   eventId->invalidate();
-
-  if (!m_isEventExecuting)
-    {
-      if (!m_events.empty())
-        {
-          m_deadlineTimer.expires_from_now(m_events.begin()->expiresFromNow());
-          m_deadlineTimer.async_wait(bind(&Scheduler::onEvent, this, _1));
-          m_scheduledEvent = m_events.begin();
-        }
-      else
-        {
-          m_scheduledEvent = m_events.end();
-        }
+  ++m_nCancelledEvents;
+
+  if (m_events.front().m_eventId == eventId) {
+    popCancelledEvents();
+    // the next event is not earlier than the timer, which is rearmed by onEvent when it expires;
+    // it is cancelled only if no events are left, so that the io_service can run out of work
+    if (!m_isEventExecuting && m_events.empty()) {
+      m_deadlineTimer.cancel();
     }
+  }
+  else if (m_nCancelledEvents > m_events.size() / 2) {
+    removeCancelledEvents();
+  }
 }
 
 void
 Scheduler::cancelAllEvents()
 {
+  for (EventInfo& event : m_events) {
+    event.m_eventId->invalidate();
+  }
   m_events.clear();
+  m_nCancelledEvents = 0;
   m_deadlineTimer.cancel();
 }
 
@@ -171,31 +242,128 @@ Scheduler::onEvent(const boost::system::error_code& error)
 
   // process all expired events
   time::steady_clock::TimePoint now = time::steady_clock::now();
-  while(!m_events.empty() && m_events.begin()->m_scheduledTime <= now)
+  while (!m_events.empty() && m_events.front().m_scheduledTime <= now)
     {
-      EventQueue::iterator head = m_events.begin();
+      EventId eventId = std::move(m_events.front().m_eventId);
+      popEvent();
+
+      if (!eventId->isValid()) {
+        --m_nCancelledEvents;
+        continue;
+      }
 
-      Event event = head->m_event;
-      head->m_eventId->invalidate();
-      m_events.erase(head);
+      Event event = std::move(eventId->m_event);
+      eventId->invalidate();
 
       event();
     }
 
-  if (!m_events.empty())
-    {
-      m_deadlineTimer.expires_from_now(m_events.begin()->m_scheduledTime - now);
-      m_deadlineTimer.async_wait(bind(&Scheduler::onEvent, this, _1));
-      m_scheduledEvent = m_events.begin();
-    }
+  popCancelledEvents();
+  scheduleNext();
+
+  m_isEventExecuting = false;
+}
+
+void
+Scheduler::scheduleNext()
+{
+  if (m_events.empty()) {
+    m_deadlineTimer.cancel();
+    return;
+  }
+
+  time::steady_clock::TimePoint now = time::steady_clock::now();
+  time::steady_clock::TimePoint when = m_events.front().m_scheduledTime;
+  if (when > now)
+    m_deadlineTimer.expires_from_now(when - now);
   else
-    {
-      m_scheduledEvent = m_events.end();
+    m_deadlineTimer.expires_from_now(time::seconds(0)); // event should be scheduled ASAP
+  m_deadlineTimer.async_wait(bind(&Scheduler::onEvent, this, _1));
+}
+
+void
+Scheduler::pushEvent(EventInfo&& event)
+{
+  m_events.push_back(std::move(event));
+  siftUp(m_events.size() - 1);
+}
+
+void
+Scheduler::popEvent()
+{
+  if (m_events.size() > 1) {
+    m_events.front() = std::move(m_events.back());
+    m_events.pop_back();
+    siftDown(0);
+  }
+  else {
+    m_events.pop_back();
+  }
+}
+
+void
+Scheduler::siftUp(size_t index)
+{
+  EventInfo event = std::move(m_events[index]);
+  while (index > 0) {
+    size_t parent = (index - 1) / 4;
+    if (!(event < m_events[parent]))
+      break;
+    m_events[index] = std::move(m_events[parent]);
+    index = parent;
+  }
+  m_events[index] = std::move(event);
+}
+
+void
+Scheduler::siftDown(size_t index)
+{
+  size_t size = m_events.size();
+  EventInfo event = std::move(m_events[index]);
+  while (true) {
+    size_t first = 4 * index + 1;
+    if (first >= size)
+      break;
+
+    size_t last = std::min(first + 4, size);
+    size_t child = first;
+    for (size_t i = first + 1; i < last; ++i) {
+      if (m_events[i] < m_events[child])
+        child = i;
     }
 
-  m_isEventExecuting = false;
+    if (!(m_events[child] < event))
+      break;
+    m_events[index] = std::move(m_events[child]);
+    index = child;
+  }
+  m_events[index] = std::move(event);
+}
+
+void
+Scheduler::popCancelledEvents()
+{
+  while (!m_events.empty() && !m_events.front().m_eventId->isValid()) {
+    popEvent();
+    --m_nCancelledEvents;
+  }
 }
 
+void
+Scheduler::removeCancelledEvents()
+{
+  m_events.erase(std::remove_if(m_events.begin(), m_events.end(),
+                                [] (const EventInfo& event) {
+                                  return !event.m_eventId->isValid();
+                                }),
+                 m_events.end());
+  m_nCancelledEvents = 0;
+
+  for (size_t i = m_events.size() / 4 + 1; i > 0; --i) {
+    if (i - 1 < m_events.size())
+      siftDown(i - 1);
+  }
+}
 
 } // namespace scheduler
 } // namespace util
@@ -24,8 +24,9 @@
 
 #include "../common.hpp"
 #include "monotonic_deadline_timer.hpp"
+#include "small-function.hpp"
 
-#include <set>
+#include <vector>
 
 namespace ndn {
 namespace util {
@@ -39,11 +40,24 @@ typedef shared_ptr<EventIdImpl> EventId;
 
 /**
  * \brief Generic scheduler
+ *
+ * Events are kept in a 4-ary min-heap ordered by scheduled time, and events scheduled for
+ * the same time are executed in the order they were scheduled.  The EventId of an event is
+ * allocated together with the event from a pool of recycled nodes, and the event callback
+ * is stored inline unless it is larger than a SmallFunction, so that scheduling an event
+ * does not allocate memory in the steady state.
+ *
+ * Cancelling an event takes constant time: the event is only marked as cancelled, and
+ * cancelled events are dropped when they reach the top of the heap, or all at once when
+ * they outnumber pending events.
+ *
+ * \note Scheduler is not thread-safe. An EventId must be released on the thread that
+ *       operates the Scheduler, because its memory is returned to the pool.
  */
 class Scheduler
 {
 public:
-  typedef function<void()> Event;
+  typedef SmallFunction<void()> Event;
 
   Scheduler(boost::asio::io_service& ioService);
 
@@ -70,38 +84,67 @@ private:
   void
   onEvent(const boost::system::error_code& code);
 
+  /**
+   * \brief Arm the deadline timer for the earliest event, or cancel it if there is none
+   */
+  void
+  scheduleNext();
+
 private:
   struct EventInfo
   {
-    EventInfo(const time::nanoseconds& after, const Event& event);
-
-    EventInfo(const time::steady_clock::TimePoint& when, const EventInfo& previousEvent);
-
-    bool
-    operator <=(const EventInfo& other) const
-    {
-      return this->m_scheduledTime <= other.m_scheduledTime;
-    }
-
     bool
     operator <(const EventInfo& other) const
     {
-      return this->m_scheduledTime < other.m_scheduledTime;
+      return m_scheduledTime < other.m_scheduledTime ||
+             (m_scheduledTime == other.m_scheduledTime && m_seqNo < other.m_seqNo);
     }
 
-    time::nanoseconds
-    expiresFromNow() const;
-
     time::steady_clock::TimePoint m_scheduledTime;
-    Event m_event;
-    mutable EventId m_eventId;
+    uint64_t m_seqNo;
+    EventId m_eventId;
   };
 
-  typedef std::multiset<EventInfo> EventQueue;
-  friend struct EventIdImpl;
+  /**
+   * \brief 4-ary min-heap of events
+   *
+   * Compared to a binary heap, it is half as deep and the children of a node share
+   * a cache line, which makes sifting cheaper.
+   */
+  typedef std::vector<EventInfo> EventQueue;
+
+  void
+  pushEvent(EventInfo&& event);
+
+  void
+  popEvent();
+
+  void
+  siftUp(size_t index);
+
+  void
+  siftDown(size_t index);
+
+  /**
+   * \brief Pop cancelled events from the top of the heap
+   */
+  void
+  popCancelledEvents();
+
+  /**
+   * \brief Remove all cancelled events and rebuild the heap
+   */
+  void
+  removeCancelledEvents();
+
+  class EventPool;
+  template<typename T>
+  class EventAllocator;
 
   EventQueue m_events;
-  EventQueue::iterator m_scheduledEvent;
+  size_t m_nCancelledEvents;
+  uint64_t m_nextSeqNo;
+  shared_ptr<EventPool> m_pool;
   monotonic_deadline_timer m_deadlineTimer;
 
   bool m_isEventExecuting;
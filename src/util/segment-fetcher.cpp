@@ -26,16 +26,45 @@
 namespace ndn {
 namespace util {
 
+SegmentFetcher::Options::Options()
+  : nVerifyThreads(0)
+{
+}
+
 SegmentFetcher::SegmentFetcher(Face& face,
                                const VerifySegment& verifySegment,
-                               const CompleteCallback& completeCallback,
-                               const ErrorCallback& errorCallback)
+                               const SegmentCallback& segmentCallback,
+                               const StreamCompleteCallback& completeCallback,
+                               const ErrorCallback& errorCallback,
+                               const Options& options)
   : m_face(face)
   , m_verifySegment(verifySegment)
+  , m_segmentCallback(segmentCallback)
   , m_completeCallback(completeCallback)
   , m_errorCallback(errorCallback)
-  , m_buffer(make_shared<OBufferStream>())
+  , m_options(options)
+  , m_nFirstSegmentRetries(0)
+  , m_isStopped(false)
+  , m_hasFinalSegmentNo(false)
+  , m_finalSegmentNo(0)
+  , m_nextSegmentToDeliver(0)
+  , m_nDeliveredBytes(0)
+{
+  if (options.nVerifyThreads > 0) {
+    m_verifyWork.reset(new boost::asio::io_service::work(m_verifyService));
+    for (size_t i = 0; i < options.nVerifyThreads; ++i) {
+      m_verifyThreads.emplace_back([this] { m_verifyService.run(); });
+    }
+  }
+}
+
+SegmentFetcher::~SegmentFetcher()
 {
+  // verification tasks hold references to this SegmentFetcher, so none is pending
+  m_verifyWork.reset();
+  for (std::thread& thread : m_verifyThreads) {
+    thread.join();
+  }
 }
 
 void
@@ -44,10 +73,46 @@ SegmentFetcher::fetch(Face& face,
                       const VerifySegment& verifySegment,
                       const CompleteCallback& completeCallback,
                       const ErrorCallback& errorCallback)
+{
+  // one Interest at a time, and any timeout aborts the fetching
+  Options options;
+  options.initCwnd = 1.0;
+  options.maxCwnd = 1.0;
+  options.maxRetries = 0;
+
+  fetch(face, baseInterest, verifySegment, completeCallback, errorCallback, options);
+}
+
+void
+SegmentFetcher::fetch(Face& face,
+                      const Interest& baseInterest,
+                      const VerifySegment& verifySegment,
+                      const CompleteCallback& completeCallback,
+                      const ErrorCallback& errorCallback,
+                      const Options& options)
+{
+  shared_ptr<OBufferStream> buffer = make_shared<OBufferStream>();
+
+  fetchStream(face, baseInterest, verifySegment,
+              [buffer] (uint64_t offset, const Block& content) {
+                buffer->write(reinterpret_cast<const char*>(content.value()), content.value_size());
+              },
+              [buffer, completeCallback] { completeCallback(buffer->buf()); },
+              errorCallback, options);
+}
+
+void
+SegmentFetcher::fetchStream(Face& face,
+                            const Interest& baseInterest,
+                            const VerifySegment& verifySegment,
+                            const SegmentCallback& segmentCallback,
+                            const StreamCompleteCallback& completeCallback,
+                            const ErrorCallback& errorCallback,
+                            const Options& options)
 {
   shared_ptr<SegmentFetcher> fetcher =
-    shared_ptr<SegmentFetcher>(new SegmentFetcher(face, verifySegment,
-                                                  completeCallback, errorCallback));
+    shared_ptr<SegmentFetcher>(new SegmentFetcher(face, verifySegment, segmentCallback,
+                                                  completeCallback, errorCallback, options));
 
   fetcher->fetchFirstSegment(baseInterest, fetcher);
 }
@@ -59,61 +124,196 @@ SegmentFetcher::fetchFirstSegment(const Interest& baseInterest,
   Interest interest(baseInterest);
   interest.setChildSelector(1);
   interest.setMustBeFresh(true);
+  if (m_nFirstSegmentRetries > 0) {
+    interest.refreshNonce();
+  }
+
+  m_segmentInterest = baseInterest; // to preserve any special selectors
+  m_segmentInterest.setChildSelector(0);
+  m_segmentInterest.setMustBeFresh(false);
 
+  m_firstSegmentSendTime = time::steady_clock::now();
   m_face.expressInterest(interest,
-                         bind(&SegmentFetcher::onSegmentReceived, this, _1, _2, true, self),
-                         bind(m_errorCallback, INTEREST_TIMEOUT, "Timeout"));
+                         bind(&SegmentFetcher::onFirstSegmentReceived, this, _1, _2, self),
+                         bind(&SegmentFetcher::onFirstSegmentTimeout, this, _1, self));
 }
 
 void
-SegmentFetcher::fetchNextSegment(const Interest& origInterest, const Name& dataName,
-                                 uint64_t segmentNo,
-                                 const shared_ptr<SegmentFetcher>& self)
+SegmentFetcher::onFirstSegmentReceived(const Interest& interest, const Data& data,
+                                       const shared_ptr<SegmentFetcher>& self)
 {
-  Interest interest(origInterest); // to preserve any special selectors
-  interest.refreshNonce();
-  interest.setChildSelector(0);
-  interest.setMustBeFresh(false);
-  interest.setName(dataName.getPrefix(-1).appendSegment(segmentNo));
-  m_face.expressInterest(interest,
-                         bind(&SegmentFetcher::onSegmentReceived, this, _1, _2, false, self),
-                         bind(m_errorCallback, INTEREST_TIMEOUT, "Timeout"));
+  if (!m_verifySegment(data)) {
+    return fail(SEGMENT_VERIFICATION_FAIL, "Segment validation fail");
+  }
+
+  time::nanoseconds rtt = time::steady_clock::now() - m_firstSegmentSendTime;
+
+  uint64_t currentSegment = 0;
+  try {
+    currentSegment = data.getName().get(-1).toSegment();
+    m_versionedName = data.getName().getPrefix(-1);
+
+    const name::Component& finalBlockId = data.getMetaInfo().getFinalBlockId();
+    if (!finalBlockId.empty()) {
+      m_hasFinalSegmentNo = true;
+      m_finalSegmentNo = finalBlockId.toSegment();
+    }
+  }
+  catch (const tlv::Error& e) {
+    return fail(DATA_HAS_NO_SEGMENT, std::string("Error while decoding segment: ") + e.what());
+  }
+
+  // a segment other than the first one only reveals the version
+  if (currentSegment == 0) {
+    processSegment(0, data);
+    if (m_isStopped) {
+      return;
+    }
+  }
+
+  m_pipeline =
+    SegmentPipeline::create(m_face, m_segmentInterest, m_versionedName, m_options,
+                            bind(&SegmentFetcher::onSegmentReceived, this, _1, _2, self),
+                            nullptr,
+                            [this, self] (uint64_t) { fail(INTEREST_TIMEOUT, "Timeout"); });
+  if (m_nFirstSegmentRetries == 0) {
+    m_pipeline->addRttSample(rtt);
+  }
+  if (m_hasFinalSegmentNo) {
+    m_pipeline->setFinalSegmentNo(m_finalSegmentNo);
+  }
+  if (currentSegment == 0) {
+    m_pipeline->increaseWindow();
+  }
+  m_pipeline->start(m_nextSegmentToDeliver);
 }
 
 void
-SegmentFetcher::onSegmentReceived(const Interest& origInterest,
-                                  const Data& data, bool isSegmentZeroExpected,
-                                  const shared_ptr<SegmentFetcher>& self)
+SegmentFetcher::onFirstSegmentTimeout(const Interest& interest,
+                                      const shared_ptr<SegmentFetcher>& self)
 {
-  if (!m_verifySegment(data)) {
-    return m_errorCallback(SEGMENT_VERIFICATION_FAIL, "Segment validation fail");
+  if (m_nFirstSegmentRetries >= m_options.maxRetries) {
+    return fail(INTEREST_TIMEOUT, "Timeout");
   }
 
+  ++m_nFirstSegmentRetries;
+  fetchFirstSegment(interest, self);
+}
+
+void
+SegmentFetcher::onSegmentReceived(const SegmentPipeline::SegmentInfo& info, const Data& data,
+                                  const shared_ptr<SegmentFetcher>& self)
+{
   try {
-    uint64_t currentSegment = data.getName().get(-1).toSegment();
+    data.getName().get(-1).toSegment();
 
-    if (isSegmentZeroExpected && currentSegment != 0) {
-      fetchNextSegment(origInterest, data.getName(), 0, self);
+    const name::Component& finalBlockId = data.getMetaInfo().getFinalBlockId();
+    if (!finalBlockId.empty() && !m_hasFinalSegmentNo) {
+      m_hasFinalSegmentNo = true;
+      m_finalSegmentNo = finalBlockId.toSegment();
+      m_pipeline->setFinalSegmentNo(m_finalSegmentNo);
     }
-    else {
-      m_buffer->write(reinterpret_cast<const char*>(data.getContent().value()),
-                      data.getContent().value_size());
-
-      const name::Component& finalBlockId = data.getMetaInfo().getFinalBlockId();
-      if (finalBlockId.empty() ||
-          finalBlockId.toSegment() > currentSegment)
-        {
-          fetchNextSegment(origInterest, data.getName(), currentSegment + 1, self);
-        }
-      else {
-        return m_completeCallback(m_buffer->buf());
+  }
+  catch (const tlv::Error& e) {
+    return fail(DATA_HAS_NO_SEGMENT, std::string("Error while decoding segment: ") + e.what());
+  }
+
+  verifySegment(info.segmentNo, data, self);
+}
+
+void
+SegmentFetcher::verifySegment(uint64_t segmentNo, const Data& data,
+                              const shared_ptr<SegmentFetcher>& self)
+{
+  if (m_verifyThreads.empty()) {
+    if (!m_verifySegment(data)) {
+      return fail(SEGMENT_VERIFICATION_FAIL, "Segment validation fail");
+    }
+    return processSegment(segmentNo, data);
+  }
+
+  shared_ptr<const Data> segment = make_shared<Data>(data);
+  shared_ptr<SegmentFetcher> fetcher = self;
+  m_verifyService.post([this, segmentNo, segment, fetcher] () mutable {
+      bool isValid = false;
+      try {
+        isValid = m_verifySegment(*segment);
+      }
+      catch (const std::exception&) {
+        // an exception must not escape the verification thread; the segment is invalid
       }
+      // the reference is moved, so that this SegmentFetcher is never destroyed on its own thread
+      m_face.getIoService().post(bind(&SegmentFetcher::onSegmentVerified, this,
+                                      segmentNo, segment, isValid, std::move(fetcher)));
+    });
+}
+
+void
+SegmentFetcher::onSegmentVerified(uint64_t segmentNo, const shared_ptr<const Data>& data,
+                                  bool isValid, const shared_ptr<SegmentFetcher>& self)
+{
+  if (m_isStopped) {
+    return;
+  }
+
+  if (!isValid) {
+    return fail(SEGMENT_VERIFICATION_FAIL, "Segment validation fail");
+  }
+
+  processSegment(segmentNo, *data);
+}
+
+void
+SegmentFetcher::processSegment(uint64_t segmentNo, const Data& data)
+{
+  if (segmentNo == m_nextSegmentToDeliver) {
+    m_segmentCallback(m_nDeliveredBytes, data.getContent());
+    m_nDeliveredBytes += data.getContent().value_size();
+    ++m_nextSegmentToDeliver;
+
+    for (auto it = m_outOfOrderContents.begin();
+         it != m_outOfOrderContents.end() && it->first == m_nextSegmentToDeliver;
+         it = m_outOfOrderContents.erase(it)) {
+      m_segmentCallback(m_nDeliveredBytes, it->second);
+      m_nDeliveredBytes += it->second.value_size();
+      ++m_nextSegmentToDeliver;
     }
   }
-  catch (const tlv::Error& e) {
-    m_errorCallback(DATA_HAS_NO_SEGMENT, std::string("Error while decoding segment: ") + e.what());
+  else if (segmentNo > m_nextSegmentToDeliver) {
+    m_outOfOrderContents.insert(std::make_pair(segmentNo, data.getContent()));
+  }
+
+  if (m_hasFinalSegmentNo && m_nextSegmentToDeliver > m_finalSegmentNo) {
+    stop();
+    m_completeCallback();
+  }
+  else if (m_pipeline != nullptr) {
+    m_pipeline->setNextSegmentToDeliver(m_nextSegmentToDeliver);
   }
 }
 
+void
+SegmentFetcher::stop()
+{
+  m_isStopped = true;
+
+  // the pipeline holds references to this SegmentFetcher
+  if (m_pipeline != nullptr) {
+    m_pipeline->stop();
+    m_pipeline.reset();
+  }
+  m_outOfOrderContents.clear();
+
+  // verification threads exit after the queued segments are verified
+  m_verifyWork.reset();
+}
+
+void
+SegmentFetcher::fail(uint32_t code, const std::string& msg)
+{
+  stop();
+  m_errorCallback(code, msg);
+}
+
 } // util
 } // ndn
@@ -24,10 +24,14 @@
 
 #include "../common.hpp"
 #include "../face.hpp"
+#include "segment-pipeline.hpp"
 
-namespace ndn {
+#include <boost/asio/io_service.hpp>
+
+#include <map>
+#include <thread>
 
-class OBufferStream;
+namespace ndn {
 
 namespace util {
 
@@ -76,10 +80,31 @@ public:
  * 6. Fire onCompletion callback with memory block that combines content part from all
  *    segmented objects.
  *
+ * Alternatively, fetchStream delivers the content of each segment in order as soon as it is
+ * available, instead of combining all segments in memory.  Segments received out of order
+ * are held until the preceding segments arrive; Interests are not expressed for segments
+ * more than Options::maxCwnd segments ahead of the next segment to be delivered, so that
+ * held segments take memory proportional to the window rather than the object size.
+ *
+ * In the pipelined mode (fetch with Options), step 5 is performed by a SegmentPipeline, which
+ * keeps a window of Interests for consecutive segments in flight, controlled with AIMD, and
+ * retransmits lost segments up to Options::maxRetries times.  The RTT of the first Interest
+ * is the first sample of the pipeline's retransmission timeout.  Segments received out of
+ * order are reassembled before the completion callback is fired.
+ *
+ * Signature verification can dominate the time of fetching a large object.  When
+ * Options::nVerifyThreads is positive, each segment after the first one is verified on one of
+ * that many threads owned by the SegmentFetcher, while the Face's thread continues to express
+ * Interests and receive Data.  Verified segments are delivered in order on the Face's thread,
+ * and Interests are not expressed for segments more than Options::maxCwnd segments ahead of
+ * the next segment to be delivered, including segments being verified.  In this mode, the
+ * VerifySegment callback is invoked concurrently from several threads and must be thread-safe;
+ * an exception thrown by it is treated as a verification failure.
+ *
  * If an error occurs during the fetching process, an error callback is fired
  * with a proper error code.  The following errors are possible:
  *
- * - `INTEREST_TIMEOUT`: if any of the Interests times out
+ * - `INTEREST_TIMEOUT`: if any of the Interests times out after all retransmissions
  * - `DATA_HAS_NO_SEGMENT`: if any of the retrieved Data packets don't have segment
  *   as a last component of the name (not counting implicit digest)
  * - `SEGMENT_VERIFICATION_FAIL`: if any retrieved segment fails user-provided validation
@@ -108,6 +133,15 @@ public:
  *                           bind(&onComplete, this, _1),
  *                           bind(&onError, this, _1, _2));
  *
+ *     // pipelined
+ *     SegmentFetcher::Options options;
+ *     options.maxRetries = 5;
+ *     SegmentFetcher::fetch(face, Interest("/data/prefix", time::seconds(4)),
+ *                           DontVerifySegment(),
+ *                           bind(&onComplete, this, _1),
+ *                           bind(&onError, this, _1, _2),
+ *                           options);
+ *
  */
 class SegmentFetcher : noncopyable
 {
@@ -116,6 +150,14 @@ public:
   typedef function<bool (const Data& data)> VerifySegment;
   typedef function<void (uint32_t code, const std::string& msg)> ErrorCallback;
 
+  /**
+   * @brief Callback to receive the content of a segment
+   * @param offset position of the content in the fetched object, in octets
+   * @param content Content element of the segment Data
+   */
+  typedef function<void (uint64_t offset, const Block& content)> SegmentCallback;
+  typedef function<void ()> StreamCompleteCallback;
+
   /**
    * @brief Error codes that can be passed to ErrorCallback
    */
@@ -125,6 +167,29 @@ public:
     SEGMENT_VERIFICATION_FAIL = 3
   };
 
+  /**
+   * @brief Options for pipelined fetching
+   *
+   * When an Interest is not retransmitted anymore, the fetching is aborted with
+   * INTEREST_TIMEOUT error after its InterestLifetime.
+   */
+  struct Options : public SegmentPipeline::Options
+  {
+    /**
+     * @brief Create options with a pipeline that starts with one Interest in flight
+     */
+    Options();
+
+    /**
+     * @brief number of threads that verify segments
+     *
+     * If zero, segments are verified on the Face's thread upon arrival.  The first Data,
+     * which reveals the version to be fetched, is always verified before other Interests
+     * are expressed.
+     */
+    size_t nVerifyThreads;
+  };
+
   /**
    * @brief Initiate segment fetching
    *
@@ -149,31 +214,117 @@ public:
         const CompleteCallback& completeCallback,
         const ErrorCallback& errorCallback);
 
+  /**
+   * @brief Initiate pipelined segment fetching
+   *
+   * Parameters are the same as in the fetch method above, and @p options controls the
+   * window and retransmissions.
+   */
+  static
+  void
+  fetch(Face& face,
+        const Interest& baseInterest,
+        const VerifySegment& verifySegment,
+        const CompleteCallback& completeCallback,
+        const ErrorCallback& errorCallback,
+        const Options& options);
+
+  /**
+   * @brief Initiate pipelined segment fetching with in-order delivery of each segment
+   *
+   * @param segmentCallback  Callback to be fired with the content of each segment, in order
+   * @param completeCallback Callback to be fired after the content of the last segment is
+   *                         delivered
+   *
+   * Other parameters are the same as in the fetch methods above.
+   */
+  static
+  void
+  fetchStream(Face& face,
+              const Interest& baseInterest,
+              const VerifySegment& verifySegment,
+              const SegmentCallback& segmentCallback,
+              const StreamCompleteCallback& completeCallback,
+              const ErrorCallback& errorCallback,
+              const Options& options = Options());
+
+  ~SegmentFetcher();
+
 private:
   SegmentFetcher(Face& face,
                  const VerifySegment& verifySegment,
-                 const CompleteCallback& completeCallback,
-                 const ErrorCallback& errorCallback);
+                 const SegmentCallback& segmentCallback,
+                 const StreamCompleteCallback& completeCallback,
+                 const ErrorCallback& errorCallback,
+                 const Options& options);
 
   void
   fetchFirstSegment(const Interest& baseInterest, const shared_ptr<SegmentFetcher>& self);
 
   void
-  fetchNextSegment(const Interest& origInterest, const Name& dataName, uint64_t segmentNo,
-                   const shared_ptr<SegmentFetcher>& self);
+  onFirstSegmentReceived(const Interest& interest, const Data& data,
+                         const shared_ptr<SegmentFetcher>& self);
+
+  void
+  onFirstSegmentTimeout(const Interest& interest, const shared_ptr<SegmentFetcher>& self);
+
+  void
+  onSegmentReceived(const SegmentPipeline::SegmentInfo& info, const Data& data,
+                    const shared_ptr<SegmentFetcher>& self);
+
+  /**
+   * @brief Verify a received segment, either in place or on a verification thread
+   */
+  void
+  verifySegment(uint64_t segmentNo, const Data& data, const shared_ptr<SegmentFetcher>& self);
 
   void
-  onSegmentReceived(const Interest& origInterest,
-                    const Data& data, bool isSegmentZeroExpected,
+  onSegmentVerified(uint64_t segmentNo, const shared_ptr<const Data>& data, bool isValid,
                     const shared_ptr<SegmentFetcher>& self);
 
+  /**
+   * @brief Deliver a verified segment in order, and complete the fetching after the last segment
+   */
+  void
+  processSegment(uint64_t segmentNo, const Data& data);
+
+  void
+  stop();
+
+  void
+  fail(uint32_t code, const std::string& msg);
+
 private:
   Face& m_face;
   VerifySegment m_verifySegment;
-  CompleteCallback m_completeCallback;
+  SegmentCallback m_segmentCallback;
+  StreamCompleteCallback m_completeCallback;
   ErrorCallback m_errorCallback;
+  Options m_options;
+
+  Interest m_segmentInterest; ///< template for Interests of segments
+  Name m_versionedName;
+  time::steady_clock::TimePoint m_firstSegmentSendTime;
+  int m_nFirstSegmentRetries;
+  bool m_isStopped;
+
+  bool m_hasFinalSegmentNo;
+  uint64_t m_finalSegmentNo;
+
+  /**
+   * @brief fetches segments after the first one
+   *
+   * Its callbacks hold references to this SegmentFetcher, so it is released in stop().
+   */
+  shared_ptr<SegmentPipeline> m_pipeline;
+
+  uint64_t m_nextSegmentToDeliver;
+  uint64_t m_nDeliveredBytes;
+  std::map<uint64_t, Block> m_outOfOrderContents;
 
-  shared_ptr<OBufferStream> m_buffer;
+  boost::asio::io_service m_verifyService;
+  unique_ptr<boost::asio::io_service::work> m_verifyWork;
+  std::vector<std::thread> m_verifyThreads;
 };
 
 } // util
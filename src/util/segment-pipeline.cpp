@@ -0,0 +1,309 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "segment-pipeline.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+namespace util {
+
+SegmentPipeline::Options::Options()
+  : initCwnd(1.0)
+  , initSsthresh(std::numeric_limits<double>::max())
+  , maxCwnd(1024.0)
+  , minSsthresh(2.0)
+  , aiStep(1.0)
+  , mdCoef(0.5)
+  , initRto(time::seconds(1))
+  , minRto(time::milliseconds(200))
+  , maxRto(time::seconds(4))
+  , maxRetries(3)
+{
+}
+
+SegmentPipeline::SegmentPipeline(Face& face,
+                                 const Interest& interestTemplate,
+                                 const Name& prefix,
+                                 const Options& options,
+                                 const DataCallback& dataCallback,
+                                 const LossCallback& lossCallback,
+                                 const TimeoutCallback& timeoutCallback)
+  : m_face(face)
+  , m_scheduler(face.getIoService())
+  , m_interestTemplate(interestTemplate)
+  , m_prefix(prefix)
+  , m_options(options)
+  , m_dataCallback(dataCallback)
+  , m_lossCallback(lossCallback)
+  , m_timeoutCallback(timeoutCallback)
+  , m_isStopped(false)
+  , m_nextSegmentNo(0)
+  , m_nextSegmentToDeliver(0)
+  , m_hasFinalSegmentNo(false)
+  , m_finalSegmentNo(0)
+  , m_nInFlight(0)
+  , m_nRetransmissions(0)
+  , m_cwnd(std::min(options.initCwnd, options.maxCwnd))
+  , m_ssthresh(options.initSsthresh)
+  , m_lastDecrease(time::steady_clock::TimePoint::min())
+  , m_hasRttSample(false)
+  , m_srtt(0)
+  , m_rttVar(0)
+  , m_rto(options.initRto)
+{
+}
+
+shared_ptr<SegmentPipeline>
+SegmentPipeline::create(Face& face,
+                        const Interest& interestTemplate,
+                        const Name& prefix,
+                        const Options& options,
+                        const DataCallback& dataCallback,
+                        const LossCallback& lossCallback,
+                        const TimeoutCallback& timeoutCallback)
+{
+  return shared_ptr<SegmentPipeline>(new SegmentPipeline(face, interestTemplate, prefix, options,
+                                                         dataCallback, lossCallback,
+                                                         timeoutCallback));
+}
+
+void
+SegmentPipeline::start(uint64_t segmentNo)
+{
+  m_nextSegmentNo = segmentNo;
+  m_nextSegmentToDeliver = std::max(m_nextSegmentToDeliver, segmentNo);
+  fetchSegments();
+}
+
+void
+SegmentPipeline::stop()
+{
+  m_isStopped = true;
+
+  for (const auto& segment : m_segments) {
+    if (segment.second.isInFlight) {
+      m_face.removePendingInterest(segment.second.pendingInterestId);
+    }
+  }
+  m_segments.clear();
+  m_nInFlight = 0;
+
+  // scheduled events hold references to this SegmentPipeline
+  m_scheduler.cancelAllEvents();
+}
+
+void
+SegmentPipeline::setFinalSegmentNo(uint64_t segmentNo)
+{
+  if (m_hasFinalSegmentNo) {
+    return;
+  }
+  m_hasFinalSegmentNo = true;
+  m_finalSegmentNo = segmentNo;
+
+  // Interests beyond the last segment will not be satisfied
+  for (auto it = m_segments.upper_bound(m_finalSegmentNo); it != m_segments.end();) {
+    if (it->second.isInFlight) {
+      m_face.removePendingInterest(it->second.pendingInterestId);
+      m_scheduler.cancelEvent(it->second.rtoEvent);
+      --m_nInFlight;
+    }
+    it = m_segments.erase(it);
+  }
+}
+
+void
+SegmentPipeline::setNextSegmentToDeliver(uint64_t segmentNo)
+{
+  m_nextSegmentToDeliver = segmentNo;
+  fetchSegments();
+}
+
+void
+SegmentPipeline::addRttSample(const time::nanoseconds& rtt)
+{
+  if (!m_hasRttSample) {
+    m_hasRttSample = true;
+    m_srtt = rtt;
+    m_rttVar = rtt / 2;
+  }
+  else {
+    time::nanoseconds delta = m_srtt > rtt ? m_srtt - rtt : rtt - m_srtt;
+    m_rttVar = (m_rttVar * 3 + delta) / 4;
+    m_srtt = (m_srtt * 7 + rtt) / 8;
+  }
+
+  m_rto = m_srtt + m_rttVar * 4;
+  m_rto = std::max<time::nanoseconds>(m_rto, m_options.minRto);
+  m_rto = std::min<time::nanoseconds>(m_rto, m_options.maxRto);
+}
+
+void
+SegmentPipeline::increaseWindow()
+{
+  if (m_cwnd < m_ssthresh) {
+    m_cwnd += 1.0;
+  }
+  else {
+    m_cwnd += m_options.aiStep / m_cwnd;
+  }
+  m_cwnd = std::min(m_cwnd, m_options.maxCwnd);
+}
+
+void
+SegmentPipeline::fetchSegments()
+{
+  while (!m_isStopped && m_nInFlight < std::max<size_t>(1, static_cast<size_t>(m_cwnd))) {
+    if (!m_retxQueue.empty()) {
+      uint64_t segmentNo = m_retxQueue.front();
+      m_retxQueue.pop();
+      if (m_segments.count(segmentNo) > 0) {
+        ++m_nRetransmissions;
+        fetchSegment(segmentNo);
+      }
+      continue;
+    }
+
+    if (m_hasFinalSegmentNo && m_nextSegmentNo > m_finalSegmentNo) {
+      break;
+    }
+
+    // bound the number of segments held by the owner for in-order delivery
+    if (m_nextSegmentNo - m_nextSegmentToDeliver >= std::max(1.0, m_options.maxCwnd)) {
+      break;
+    }
+
+    uint64_t segmentNo = m_nextSegmentNo++;
+    SegmentState& state = m_segments[segmentNo];
+    state.isInFlight = false;
+    state.pendingInterestId = nullptr;
+    state.nRetries = 0;
+    fetchSegment(segmentNo);
+  }
+}
+
+void
+SegmentPipeline::fetchSegment(uint64_t segmentNo)
+{
+  SegmentState& state = m_segments[segmentNo];
+  shared_ptr<SegmentPipeline> self = shared_from_this();
+
+  Interest interest(m_interestTemplate);
+  interest.setName(Name(m_prefix).appendSegment(segmentNo));
+  interest.refreshNonce();
+
+  state.pendingInterestId =
+    m_face.expressInterest(interest,
+                           bind(&SegmentPipeline::onData, this, segmentNo, _2, self),
+                           bind(&SegmentPipeline::onLoss, this, segmentNo, true, self));
+  state.isInFlight = true;
+  state.sendTime = time::steady_clock::now();
+  ++m_nInFlight;
+
+  // without retransmissions left, wait for the Interest to time out
+  if (state.nRetries < m_options.maxRetries) {
+    state.rtoEvent = m_scheduler.scheduleEvent(m_rto, bind(&SegmentPipeline::onLoss, this,
+                                                           segmentNo, false, self));
+  }
+}
+
+void
+SegmentPipeline::onData(uint64_t segmentNo, const Data& data,
+                        const shared_ptr<SegmentPipeline>& self)
+{
+  if (m_isStopped) {
+    return;
+  }
+
+  auto it = m_segments.find(segmentNo);
+  if (it == m_segments.end()) {
+    return; // duplicate
+  }
+
+  SegmentInfo info;
+  info.segmentNo = segmentNo;
+  info.nRetries = it->second.nRetries;
+  info.rtt = time::steady_clock::now() - it->second.sendTime;
+
+  // a segment waiting for retransmission is accepted if its original Interest is satisfied
+  if (it->second.isInFlight) {
+    m_scheduler.cancelEvent(it->second.rtoEvent);
+    --m_nInFlight;
+    if (it->second.nRetries == 0) {
+      addRttSample(info.rtt);
+    }
+  }
+  m_segments.erase(it);
+
+  increaseWindow();
+
+  m_dataCallback(info, data);
+  fetchSegments();
+}
+
+void
+SegmentPipeline::onLoss(uint64_t segmentNo, bool isInterestTimeout,
+                        const shared_ptr<SegmentPipeline>& self)
+{
+  if (m_isStopped) {
+    return;
+  }
+
+  auto it = m_segments.find(segmentNo);
+  if (it == m_segments.end() || !it->second.isInFlight) {
+    return;
+  }
+  SegmentState& state = it->second;
+
+  if (state.nRetries >= m_options.maxRetries) {
+    stop();
+    return m_timeoutCallback(segmentNo);
+  }
+
+  if (isInterestTimeout) {
+    m_scheduler.cancelEvent(state.rtoEvent);
+  }
+  else {
+    m_face.removePendingInterest(state.pendingInterestId);
+  }
+  state.isInFlight = false;
+  --m_nInFlight;
+  ++state.nRetries;
+
+  // react to at most one loss per window of Interests
+  if (state.sendTime > m_lastDecrease) {
+    m_ssthresh = std::max(m_options.minSsthresh, m_cwnd * m_options.mdCoef);
+    m_cwnd = std::min(m_ssthresh, m_options.maxCwnd);
+    m_rto = std::min<time::nanoseconds>(m_rto * 2, m_options.maxRto);
+    m_lastDecrease = time::steady_clock::now();
+  }
+
+  if (m_lossCallback) {
+    m_lossCallback(segmentNo, isInterestTimeout);
+  }
+
+  m_retxQueue.push(segmentNo);
+  fetchSegments();
+}
+
+} // util
+} // ndn
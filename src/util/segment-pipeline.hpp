@@ -0,0 +1,280 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_SEGMENT_PIPELINE_HPP
+#define NDN_UTIL_SEGMENT_PIPELINE_HPP
+
+#include "../common.hpp"
+#include "../face.hpp"
+#include "scheduler.hpp"
+
+#include <map>
+#include <queue>
+
+namespace ndn {
+
+namespace util {
+
+/**
+ * @brief Fetches consecutive segments /<prefix>/<segment> with a window of Interests in flight
+ *
+ * The window is controlled with AIMD: it grows by one segment per received segment in slow
+ * start and by Options::aiStep per RTT afterwards, and is multiplied by Options::mdCoef at
+ * most once per RTT when a segment is lost.  A segment is considered lost when it is not
+ * received within the retransmission timeout (RTO), which is estimated from RTT samples of
+ * segments that were not retransmitted (RFC 6298) and doubled after each loss, or when its
+ * Interest times out.  A lost segment is retransmitted up to Options::maxRetries times.
+ *
+ * SegmentPipeline neither discovers the version nor reassembles the content: segments are
+ * passed to DataCallback in the order they arrive, together with their statistics.  The owner
+ * sets the last segment with setFinalSegmentNo when it is learned, e.g., from FinalBlockId,
+ * and reports in-order consumption with setNextSegmentToDeliver, so that Interests are not
+ * expressed for segments more than Options::maxCwnd segments ahead of the next segment to be
+ * delivered.
+ *
+ * Pending Interests and retransmission timers hold references to the pipeline, which is
+ * released after it is stopped, either by stop() or when a segment is not received after all
+ * retransmissions.
+ */
+class SegmentPipeline : noncopyable, public enable_shared_from_this<SegmentPipeline>
+{
+public:
+  /**
+   * @brief Options of the window and retransmissions
+   */
+  struct Options
+  {
+    /**
+     * @brief Create options with a pipeline that starts with one Interest in flight
+     */
+    Options();
+
+    double initCwnd;     ///< initial window size, in segments
+    double initSsthresh; ///< initial slow start threshold, in segments
+    double maxCwnd;      ///< maximum window size, in segments
+    double minSsthresh;  ///< the window is not decreased below this size
+    double aiStep;       ///< additive increase of the window per RTT, in segments
+    double mdCoef;       ///< multiplicative decrease coefficient upon a loss
+
+    time::milliseconds initRto; ///< RTO before the first RTT sample
+    time::milliseconds minRto;  ///< lower bound of RTO
+    time::milliseconds maxRto;  ///< upper bound of RTO after backoff
+
+    /**
+     * @brief maximum number of retransmissions of each Interest
+     *
+     * When an Interest is not retransmitted anymore, the pipeline waits for its
+     * InterestLifetime before it reports the segment as timed out.
+     */
+    int maxRetries;
+  };
+
+  /**
+   * @brief Statistics of a received segment
+   */
+  struct SegmentInfo
+  {
+    uint64_t segmentNo;
+    int nRetries;          ///< number of retransmissions of the Interest for the segment
+    time::nanoseconds rtt; ///< time since the last Interest for the segment was expressed
+  };
+
+  /**
+   * @brief Callback to receive a segment
+   *
+   * The window has already been increased when the callback is invoked.
+   */
+  typedef function<void (const SegmentInfo& info, const Data& data)> DataCallback;
+
+  /**
+   * @brief Callback fired when a segment is lost and will be retransmitted
+   * @param isInterestTimeout true if the Interest timed out, false if RTO expired
+   *
+   * The window has already been decreased when the callback is invoked.
+   */
+  typedef function<void (uint64_t segmentNo, bool isInterestTimeout)> LossCallback;
+
+  /**
+   * @brief Callback fired when a segment is not received after all retransmissions
+   *
+   * The pipeline is stopped before the callback is invoked.
+   */
+  typedef function<void (uint64_t segmentNo)> TimeoutCallback;
+
+  /**
+   * @brief Create a pipeline
+   *
+   * @param face             Face used to express Interests
+   * @param interestTemplate template of Interests, whose name is replaced with
+   *                         /<prefix>/<segment> and whose Nonce is refreshed
+   * @param prefix           name of segments without the segment number
+   * @param dataCallback     callback fired for each received segment
+   * @param lossCallback     callback fired for each lost segment, may be empty
+   * @param timeoutCallback  callback fired when the fetching fails
+   */
+  static shared_ptr<SegmentPipeline>
+  create(Face& face,
+         const Interest& interestTemplate,
+         const Name& prefix,
+         const Options& options,
+         const DataCallback& dataCallback,
+         const LossCallback& lossCallback,
+         const TimeoutCallback& timeoutCallback);
+
+  /**
+   * @brief Start expressing Interests, from segment @p segmentNo
+   */
+  void
+  start(uint64_t segmentNo);
+
+  /**
+   * @brief Stop the pipeline, and cancel pending Interests and timers
+   */
+  void
+  stop();
+
+  /**
+   * @brief Set the last segment, and cancel Interests for segments beyond it
+   *
+   * Has no effect if the last segment is already set.
+   */
+  void
+  setFinalSegmentNo(uint64_t segmentNo);
+
+  bool
+  hasFinalSegmentNo() const
+  {
+    return m_hasFinalSegmentNo;
+  }
+
+  /**
+   * @brief Allow Interests for segments up to Options::maxCwnd segments ahead of @p segmentNo
+   */
+  void
+  setNextSegmentToDeliver(uint64_t segmentNo);
+
+  /**
+   * @brief Update RTO with an RTT measured outside the pipeline, e.g., during version discovery
+   */
+  void
+  addRttSample(const time::nanoseconds& rtt);
+
+  /**
+   * @brief Increase the window as if a segment were received outside the pipeline
+   */
+  void
+  increaseWindow();
+
+  double
+  getCwnd() const
+  {
+    return m_cwnd;
+  }
+
+  time::nanoseconds
+  getRto() const
+  {
+    return m_rto;
+  }
+
+  /**
+   * @return number of Interests that were retransmitted
+   */
+  uint64_t
+  getNRetransmissions() const
+  {
+    return m_nRetransmissions;
+  }
+
+private:
+  SegmentPipeline(Face& face,
+                  const Interest& interestTemplate,
+                  const Name& prefix,
+                  const Options& options,
+                  const DataCallback& dataCallback,
+                  const LossCallback& lossCallback,
+                  const TimeoutCallback& timeoutCallback);
+
+  /**
+   * @brief Express Interests while the window has room
+   */
+  void
+  fetchSegments();
+
+  void
+  fetchSegment(uint64_t segmentNo);
+
+  void
+  onData(uint64_t segmentNo, const Data& data, const shared_ptr<SegmentPipeline>& self);
+
+  /**
+   * @brief Handle a segment that was not received
+   * @param isInterestTimeout true if the Interest timed out, false if RTO expired
+   */
+  void
+  onLoss(uint64_t segmentNo, bool isInterestTimeout, const shared_ptr<SegmentPipeline>& self);
+
+private:
+  /**
+   * @brief State of a segment that has not been received
+   */
+  struct SegmentState
+  {
+    bool isInFlight;
+    const PendingInterestId* pendingInterestId;
+    scheduler::EventId rtoEvent;
+    time::steady_clock::TimePoint sendTime;
+    int nRetries;
+  };
+
+  Face& m_face;
+  scheduler::Scheduler m_scheduler;
+  Interest m_interestTemplate;
+  Name m_prefix;
+  Options m_options;
+  DataCallback m_dataCallback;
+  LossCallback m_lossCallback;
+  TimeoutCallback m_timeoutCallback;
+  bool m_isStopped;
+
+  uint64_t m_nextSegmentNo; ///< next segment that has not been requested
+  uint64_t m_nextSegmentToDeliver;
+  bool m_hasFinalSegmentNo;
+  uint64_t m_finalSegmentNo;
+  std::map<uint64_t, SegmentState> m_segments;
+  std::queue<uint64_t> m_retxQueue;
+  size_t m_nInFlight;
+  uint64_t m_nRetransmissions;
+
+  double m_cwnd;
+  double m_ssthresh;
+  time::steady_clock::TimePoint m_lastDecrease;
+
+  bool m_hasRttSample;
+  time::nanoseconds m_srtt;
+  time::nanoseconds m_rttVar;
+  time::nanoseconds m_rto;
+};
+
+} // util
+} // ndn
+
+#endif // NDN_UTIL_SEGMENT_PIPELINE_HPP
@@ -0,0 +1,404 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_SMALL_FUNCTION_HPP
+#define NDN_UTIL_SMALL_FUNCTION_HPP
+
+#include "../common.hpp"
+
+namespace ndn {
+namespace util {
+
+/** \brief default inline capacity of SmallFunction, in bytes
+ *
+ *  This is large enough for a std::function, a lambda capturing up to three shared_ptrs,
+ *  or a bind expression of a member function, an object pointer, placeholders, and two
+ *  shared_ptrs; and makes a SmallFunction exactly 64 bytes on LP64 platforms.
+ */
+static const size_t SMALL_FUNCTION_DEFAULT_CAPACITY = 7 * sizeof(void*);
+
+template<typename Signature, size_t Capacity = SMALL_FUNCTION_DEFAULT_CAPACITY>
+class SmallFunction;
+
+/** \brief a polymorphic function wrapper with inline storage
+ *
+ *  SmallFunction can be used in place of std::function with the same signature.
+ *  A callable object that fits in \p Capacity bytes and is nothrow-move-constructible
+ *  is stored inside the SmallFunction, so that constructing, copying, and moving
+ *  the wrapper does not allocate memory beyond what copying the target itself does.
+ *  Other callable objects are stored on the heap.
+ *
+ *  \tparam R return type
+ *  \tparam Args argument types
+ *  \tparam Capacity size of inline storage, in bytes
+ */
+template<typename R, typename... Args, size_t Capacity>
+class SmallFunction<R(Args...), Capacity>
+{
+private:
+  typedef typename std::aligned_storage<Capacity, alignof(void*)>::type Storage;
+
+  template<typename F, typename = void>
+  struct IsCompatible : std::false_type
+  {
+  };
+
+  template<typename F>
+  struct IsCompatible<F, typename std::enable_if<
+                           !std::is_same<typename std::decay<F>::type, SmallFunction>::value &&
+                           (std::is_void<R>::value ||
+                            std::is_convertible<decltype(std::declval<typename std::decay<F>::type&>()(
+                                                  std::declval<Args>()...)), R>::value)>::type>
+    : std::true_type
+  {
+  };
+
+  template<typename F>
+  using IsStoredInline = std::integral_constant<bool,
+    sizeof(F) <= sizeof(Storage) &&
+    alignof(Storage) % alignof(F) == 0 &&
+    std::is_nothrow_move_constructible<F>::value>;
+
+public:
+  typedef R result_type;
+
+  SmallFunction() noexcept
+    : m_ops(nullptr)
+  {
+  }
+
+  SmallFunction(std::nullptr_t) noexcept
+    : m_ops(nullptr)
+  {
+  }
+
+  /** \brief wraps a callable object
+   *
+   *  If \p f is a null function pointer or an empty std::function, the SmallFunction is empty.
+   */
+  template<typename F, typename = typename std::enable_if<IsCompatible<F>::value>::type>
+  SmallFunction(F&& f)
+    : m_ops(nullptr)
+  {
+    typedef typename std::decay<F>::type Target;
+    if (isEmptyTarget(f))
+      return;
+
+    Handler<Target, IsStoredInline<Target>::value>::create(&m_storage, std::forward<F>(f));
+    m_ops = &Handler<Target, IsStoredInline<Target>::value>::ops;
+  }
+
+  SmallFunction(const SmallFunction& other)
+    : m_ops(nullptr)
+  {
+    if (other.m_ops != nullptr) {
+      other.m_ops->copy(&m_storage, &other.m_storage);
+      m_ops = other.m_ops;
+    }
+  }
+
+  SmallFunction(SmallFunction&& other) noexcept
+    : m_ops(other.m_ops)
+  {
+    if (m_ops != nullptr) {
+      m_ops->move(&m_storage, &other.m_storage);
+      other.m_ops = nullptr;
+    }
+  }
+
+  ~SmallFunction()
+  {
+    reset();
+  }
+
+  SmallFunction&
+  operator=(const SmallFunction& other)
+  {
+    if (this != &other) {
+      SmallFunction(other).swap(*this);
+    }
+    return *this;
+  }
+
+  SmallFunction&
+  operator=(SmallFunction&& other) noexcept
+  {
+    if (this != &other) {
+      reset();
+      if (other.m_ops != nullptr) {
+        other.m_ops->move(&m_storage, &other.m_storage);
+        m_ops = other.m_ops;
+        other.m_ops = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  SmallFunction&
+  operator=(std::nullptr_t) noexcept
+  {
+    reset();
+    return *this;
+  }
+
+  template<typename F, typename = typename std::enable_if<IsCompatible<F>::value>::type>
+  SmallFunction&
+  operator=(F&& f)
+  {
+    return *this = SmallFunction(std::forward<F>(f));
+  }
+
+  void
+  swap(SmallFunction& other) noexcept
+  {
+    SmallFunction tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  explicit
+  operator bool() const noexcept
+  {
+    return m_ops != nullptr;
+  }
+
+  /** \return whether a target of type \p F is stored inline, so that wrapping it does not
+   *          allocate memory
+   */
+  template<typename F>
+  static constexpr bool
+  isStoredInline()
+  {
+    return IsStoredInline<typename std::decay<F>::type>::value;
+  }
+
+  /** \brief invokes the target
+   *  \throw std::bad_function_call the SmallFunction is empty
+   */
+  R
+  operator()(Args... args) const
+  {
+    if (m_ops == nullptr)
+      throw std::bad_function_call();
+
+    return m_ops->invoke(const_cast<Storage*>(&m_storage), std::forward<Args>(args)...);
+  }
+
+private:
+  void
+  reset() noexcept
+  {
+    if (m_ops != nullptr) {
+      m_ops->destroy(&m_storage);
+      m_ops = nullptr;
+    }
+  }
+
+  template<typename F>
+  static bool
+  isEmptyTarget(const F&)
+  {
+    return false;
+  }
+
+  template<typename FR, typename... FArgs>
+  static bool
+  isEmptyTarget(FR (* const& f)(FArgs...))
+  {
+    return f == nullptr;
+  }
+
+  template<typename Signature>
+  static bool
+  isEmptyTarget(const std::function<Signature>& f)
+  {
+    return !f;
+  }
+
+  template<typename Signature, size_t OtherCapacity>
+  static bool
+  isEmptyTarget(const SmallFunction<Signature, OtherCapacity>& f)
+  {
+    return !f;
+  }
+
+  /** \brief type-erased operations on the target
+   */
+  struct Ops
+  {
+    R (*invoke)(Storage* storage, Args&&... args);
+    void (*copy)(Storage* dst, const Storage* src);
+    void (*move)(Storage* dst, Storage* src);
+    void (*destroy)(Storage* storage);
+  };
+
+  template<typename F, bool isInline>
+  struct Handler;
+
+  /** \brief target constructed inside the storage
+   */
+  template<typename F>
+  struct Handler<F, true>
+  {
+    template<typename G>
+    static void
+    create(Storage* storage, G&& f)
+    {
+      new (storage) F(std::forward<G>(f));
+    }
+
+    static F&
+    get(Storage* storage)
+    {
+      return *reinterpret_cast<F*>(storage);
+    }
+
+    static R
+    invoke(Storage* storage, Args&&... args)
+    {
+      return get(storage)(std::forward<Args>(args)...);
+    }
+
+    static void
+    copy(Storage* dst, const Storage* src)
+    {
+      new (dst) F(get(const_cast<Storage*>(src)));
+    }
+
+    static void
+    move(Storage* dst, Storage* src) noexcept
+    {
+      new (dst) F(std::move(get(src)));
+      get(src).~F();
+    }
+
+    static void
+    destroy(Storage* storage) noexcept
+    {
+      get(storage).~F();
+    }
+
+    static const Ops ops;
+  };
+
+  /** \brief target allocated on the heap, with its pointer in the storage
+   */
+  template<typename F>
+  struct Handler<F, false>
+  {
+    template<typename G>
+    static void
+    create(Storage* storage, G&& f)
+    {
+      get(storage) = new F(std::forward<G>(f));
+    }
+
+    static F*&
+    get(Storage* storage)
+    {
+      return *reinterpret_cast<F**>(storage);
+    }
+
+    static R
+    invoke(Storage* storage, Args&&... args)
+    {
+      return (*get(storage))(std::forward<Args>(args)...);
+    }
+
+    static void
+    copy(Storage* dst, const Storage* src)
+    {
+      get(dst) = new F(*get(const_cast<Storage*>(src)));
+    }
+
+    static void
+    move(Storage* dst, Storage* src) noexcept
+    {
+      get(dst) = get(src);
+    }
+
+    static void
+    destroy(Storage* storage) noexcept
+    {
+      delete get(storage);
+    }
+
+    static const Ops ops;
+  };
+
+private:
+  Storage m_storage;
+  const Ops* m_ops;
+};
+
+template<typename R, typename... Args, size_t Capacity>
+template<typename F>
+const typename SmallFunction<R(Args...), Capacity>::Ops
+SmallFunction<R(Args...), Capacity>::Handler<F, true>::ops = {
+  &invoke, &copy, &move, &destroy
+};
+
+template<typename R, typename... Args, size_t Capacity>
+template<typename F>
+const typename SmallFunction<R(Args...), Capacity>::Ops
+SmallFunction<R(Args...), Capacity>::Handler<F, false>::ops = {
+  &invoke, &copy, &move, &destroy
+};
+
+template<typename Signature, size_t Capacity>
+inline void
+swap(SmallFunction<Signature, Capacity>& lhs, SmallFunction<Signature, Capacity>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+template<typename Signature, size_t Capacity>
+inline bool
+operator==(const SmallFunction<Signature, Capacity>& f, std::nullptr_t) noexcept
+{
+  return !f;
+}
+
+template<typename Signature, size_t Capacity>
+inline bool
+operator==(std::nullptr_t, const SmallFunction<Signature, Capacity>& f) noexcept
+{
+  return !f;
+}
+
+template<typename Signature, size_t Capacity>
+inline bool
+operator!=(const SmallFunction<Signature, Capacity>& f, std::nullptr_t) noexcept
+{
+  return static_cast<bool>(f);
+}
+
+template<typename Signature, size_t Capacity>
+inline bool
+operator!=(std::nullptr_t, const SmallFunction<Signature, Capacity>& f) noexcept
+{
+  return static_cast<bool>(f);
+}
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_SMALL_FUNCTION_HPP
@@ -0,0 +1,248 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MAIN 1
+#define BOOST_TEST_DYN_LINK 1
+#define BOOST_TEST_MODULE ndn-cxx Benchmarks (Encoding)
+
+#include "encoding/block.hpp"
+#include "data.hpp"
+#include "interest.hpp"
+#include "security/key-chain.hpp"
+
+#include "boost-test.hpp"
+#include "identity-management-fixture.hpp"
+#include "timed-execute.hpp"
+#include "unit-tests/make-interest-data.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+static size_t g_nAllocations = 0;
+
+void*
+operator new(std::size_t size)
+{
+  ++g_nAllocations;
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void
+operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+namespace ndn {
+namespace tests {
+
+/** \brief count heap allocations made by \p f
+ */
+template<typename F>
+size_t
+countAllocations(const F& f)
+{
+  size_t before = g_nAllocations;
+  f();
+  return g_nAllocations - before;
+}
+
+/** \return a Block with a private copy of \p wire and no parsed sub-elements
+ */
+static Block
+makeUnparsed(const Block& wire)
+{
+  return Block(wire.wire(), wire.size());
+}
+
+static Name
+makeName(size_t nComponents)
+{
+  Name name;
+  for (size_t i = 0; i < nComponents; ++i) {
+    name.append("component");
+  }
+  return name;
+}
+
+BOOST_AUTO_TEST_SUITE(BenchmarkEncoding)
+
+BOOST_AUTO_TEST_CASE(ParseAllocations)
+{
+  for (size_t nComponents : {1, 10, 100}) {
+    Block wire = makeUnparsed(makeName(nComponents).wireEncode());
+
+    size_t nAllocations = countAllocations([&] { wire.parse(); });
+    BOOST_CHECK_EQUAL(wire.elements_size(), nComponents);
+    BOOST_CHECK_EQUAL(nAllocations, 1);
+    std::cout << "Block::parse " << nComponents << " elements "
+              << nAllocations << " allocations" << std::endl;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DecodeAllocations)
+{
+  Name name = makeName(10);
+
+  Interest interest(name);
+  interest.setNonce(1);
+  Block interestWire = interest.wireEncode();
+
+  Block dataWire = util::makeData(name)->wireEncode();
+
+  Interest decodedInterest;
+  Block unparsedInterest = makeUnparsed(interestWire);
+  size_t nInterestAllocations = countAllocations([&] {
+    decodedInterest.wireDecode(unparsedInterest);
+  });
+  BOOST_CHECK_EQUAL(decodedInterest.getName(), name);
+
+  Data decodedData;
+  Block unparsedData = makeUnparsed(dataWire);
+  size_t nDataAllocations = countAllocations([&] {
+    decodedData.wireDecode(unparsedData);
+  });
+  BOOST_CHECK_EQUAL(decodedData.getName(), name);
+
+  std::cout << "Interest::wireDecode " << nInterestAllocations << " allocations" << std::endl;
+  std::cout << "Data::wireDecode " << nDataAllocations << " allocations" << std::endl;
+}
+
+/** \brief measure \p nIterations of decoding \p wire into a fresh Packet and reading its Name
+ */
+template<typename Packet, typename Decode>
+static time::nanoseconds
+timeDecodeAndGetName(const Block& wire, size_t nIterations, const Decode& decode)
+{
+  Block unparsed = makeUnparsed(wire);
+  size_t nameSizes = 0;
+  time::nanoseconds d = timedExecute([&] {
+    for (size_t i = 0; i < nIterations; ++i) {
+      Packet packet;
+      decode(packet, unparsed);
+      nameSizes += packet.getName().size();
+    }
+  });
+  BOOST_CHECK_GT(nameSizes, 0);
+  return d;
+}
+
+BOOST_AUTO_TEST_CASE(LazyDecodeGetName)
+{
+  const size_t N_ITERATIONS = 100000;
+  Name name = makeName(10);
+
+  Interest interest(name);
+  interest.setNonce(1);
+  interest.setMustBeFresh(true);
+  interest.setChildSelector(1);
+  interest.setExclude(Exclude().excludeOne(name::Component("excluded1"))
+                               .excludeOne(name::Component("excluded2")));
+  Block interestWire = interest.wireEncode();
+
+  Block dataWire = util::makeData(name)->wireEncode();
+
+  time::nanoseconds interestFull = timeDecodeAndGetName<Interest>(interestWire, N_ITERATIONS,
+    [] (Interest& i, const Block& wire) { i.wireDecode(wire); });
+  time::nanoseconds interestLazy = timeDecodeAndGetName<Interest>(interestWire, N_ITERATIONS,
+    [] (Interest& i, const Block& wire) { i.wireDecodeLazily(wire); });
+  time::nanoseconds dataFull = timeDecodeAndGetName<Data>(dataWire, N_ITERATIONS,
+    [] (Data& d, const Block& wire) { d.wireDecode(wire); });
+  time::nanoseconds dataLazy = timeDecodeAndGetName<Data>(dataWire, N_ITERATIONS,
+    [] (Data& d, const Block& wire) { d.wireDecodeLazily(wire); });
+
+  std::cout << "Interest decode+getName: full " << interestFull / N_ITERATIONS
+            << ", lazy " << interestLazy / N_ITERATIONS << " per packet" << std::endl;
+  std::cout << "Data decode+getName: full " << dataFull / N_ITERATIONS
+            << ", lazy " << dataLazy / N_ITERATIONS << " per packet" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(SignedDataEncode)
+{
+  const size_t N_ITERATIONS = 100000;
+  const std::vector<uint8_t> content(1024, 0xbb);
+  Name name = makeName(10);
+  KeyChain keyChain;
+
+  size_t nBytes = 0;
+  size_t nAllocations = 0;
+  time::nanoseconds d = timedExecute([&] {
+    for (size_t i = 0; i < N_ITERATIONS; ++i) {
+      Data data(name);
+      data.setFreshnessPeriod(time::seconds(1));
+      data.setContent(content.data(), content.size());
+      nAllocations += countAllocations([&] {
+        keyChain.signWithSha256(data);
+        nBytes += data.wireEncode().size();
+      });
+    }
+  });
+  BOOST_CHECK_GT(nBytes, N_ITERATIONS * content.size());
+
+  std::cout << "1KB Data signWithSha256+wireEncode: " << d / N_ITERATIONS << " per packet, "
+            << static_cast<double>(nAllocations) / N_ITERATIONS << " allocations per packet, "
+            << N_ITERATIONS * 1e9 / d.count() << " packets/s" << std::endl;
+}
+
+BOOST_FIXTURE_TEST_CASE(RsaSignedDataEncode, security::IdentityManagementFixture)
+{
+  // RSA signing dominates the time per packet, so fewer iterations are enough
+  const size_t N_ITERATIONS = 1000;
+  const std::vector<uint8_t> content(1024, 0xbb);
+  Name name = makeName(10);
+  Name identity("/benchmark/encoding/rsa");
+  BOOST_REQUIRE(addIdentity(identity, RsaKeyParams()));
+
+  size_t nBytes = 0;
+  size_t nAllocations = 0;
+  time::nanoseconds d = timedExecute([&] {
+    for (size_t i = 0; i < N_ITERATIONS; ++i) {
+      Data data(name);
+      data.setFreshnessPeriod(time::seconds(1));
+      data.setContent(content.data(), content.size());
+      nAllocations += countAllocations([&] {
+        m_keyChain.signByIdentity(data, identity);
+        nBytes += data.wireEncode().size();
+      });
+    }
+  });
+  BOOST_CHECK_GT(nBytes, N_ITERATIONS * content.size());
+
+  // allocations include those made by the TPM while computing the RSA signature
+  std::cout << "1KB Data RSA sign+wireEncode: " << d / N_ITERATIONS << " per packet, "
+            << static_cast<double>(nAllocations) / N_ITERATIONS << " allocations per packet, "
+            << N_ITERATIONS * 1e9 / d.count() << " packets/s" << std::endl;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
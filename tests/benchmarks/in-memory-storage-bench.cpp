@@ -0,0 +1,406 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MAIN 1
+#define BOOST_TEST_DYN_LINK 1
+#define BOOST_TEST_MODULE ndn-cxx Benchmarks (In-Memory Storage)
+
+#include "util/in-memory-storage-sharded.hpp"
+#include "util/in-memory-storage-lru.hpp"
+#include "util/in-memory-storage-lfu.hpp"
+#include "util/in-memory-storage-fifo.hpp"
+#include "util/in-memory-storage-clock.hpp"
+#include "util/in-memory-storage-slru.hpp"
+#include "security/signature-sha256-with-rsa.hpp"
+
+#include "boost-test.hpp"
+#include "timed-execute.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(BenchmarkInMemoryStorage)
+
+using util::InMemoryStorage;
+using util::InMemoryStorageLru;
+using util::InMemoryStorageLfu;
+using util::InMemoryStorageFifo;
+using util::InMemoryStorageClock;
+using util::InMemoryStorageSlru;
+using util::InMemoryStorageSharded;
+
+static const size_t N_DATA_PER_THREAD = 20000;
+static const size_t N_FINDS_PER_INSERT = 4;
+
+struct ThreadWorkload
+{
+  std::vector<shared_ptr<Data>> datas;
+  std::vector<Interest> interests;
+};
+
+static shared_ptr<Data>
+makeData(const Name& name)
+{
+  SignatureSha256WithRsa fakeSignature;
+  fakeSignature.setValue(dataBlock(tlv::SignatureValue, static_cast<const uint8_t*>(nullptr), 0));
+
+  shared_ptr<Data> data = make_shared<Data>(name);
+  data->setSignature(fakeSignature);
+  data->wireEncode();
+  // full name is computed upfront, so that SHA-256 is not measured
+  data->getFullName();
+  return data;
+}
+
+static std::vector<ThreadWorkload>
+makeWorkloads(size_t nThreads)
+{
+  std::vector<ThreadWorkload> workloads(nThreads);
+  for (size_t t = 0; t < nThreads; ++t) {
+    for (size_t i = 0; i < N_DATA_PER_THREAD; ++i) {
+      Name name("/benchmark/ims");
+      name.appendNumber(t).appendNumber(i / 100).appendSegment(i % 100);
+      workloads[t].datas.push_back(makeData(name));
+      // Interests received from the network have their Name wire encoding
+      name.wireEncode();
+      workloads[t].interests.push_back(Interest(name));
+    }
+  }
+  return workloads;
+}
+
+/** @brief runs the workload of every thread concurrently
+ *  @return number of operations per second
+ */
+template<typename Insert, typename Find>
+static double
+runWorkloads(const std::vector<ThreadWorkload>& workloads, const Insert& insert, const Find& find)
+{
+  time::nanoseconds d = timedExecute([&] {
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < workloads.size(); ++t) {
+      threads.emplace_back([&, t] {
+        const ThreadWorkload& workload = workloads[t];
+        for (size_t i = 0; i < N_DATA_PER_THREAD; ++i) {
+          insert(*workload.datas[i]);
+          for (size_t j = 0; j < N_FINDS_PER_INSERT; ++j) {
+            // look up recently inserted Data, some of which may have been evicted already
+            const Interest& interest = workload.interests[(i * 7 + j * 131) % (i + 1)];
+            find(interest);
+          }
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  });
+
+  size_t nOps = workloads.size() * N_DATA_PER_THREAD * (1 + N_FINDS_PER_INSERT);
+  return nOps / (d.count() / 1e9);
+}
+
+BOOST_AUTO_TEST_CASE(Scaling)
+{
+  for (size_t nThreads : {1, 2, 4, 8, 16}) {
+    std::vector<ThreadWorkload> workloads = makeWorkloads(nThreads);
+    size_t limit = nThreads * N_DATA_PER_THREAD / 2;
+
+    InMemoryStorageLru single(limit);
+    std::mutex mutex;
+    double globalLock = runWorkloads(workloads,
+      [&] (const Data& data) {
+        std::lock_guard<std::mutex> lock(mutex);
+        single.insert(data);
+      },
+      [&] (const Interest& interest) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return single.find(interest);
+      });
+
+    InMemoryStorageSharded sharded([] (size_t shardLimit) {
+                                     return unique_ptr<InMemoryStorage>(
+                                       new InMemoryStorageLru(shardLimit));
+                                   },
+                                   64, 4, limit);
+    double shards = runWorkloads(workloads,
+      [&] (const Data& data) { sharded.insert(data); },
+      [&] (const Interest& interest) { return sharded.find(interest); });
+
+    std::cout << "threads=" << nThreads << " "
+              << "global-lock=" << static_cast<size_t>(globalLock) << "ops/s "
+              << "sharded=" << static_cast<size_t>(shards) << "ops/s" << std::endl;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ShardedInsertDigest)
+{
+  const size_t nPackets = 20000;
+
+  for (size_t contentSize : {100, 8000}) {
+    // packets are received from the network, so their full names have not been computed
+    std::vector<uint8_t> content(contentSize);
+    std::vector<Block> wires;
+    for (size_t i = 0; i < nPackets; ++i) {
+      Data data(Name("/benchmark/ims/digest").appendSegment(i));
+      data.setContent(content.data(), content.size());
+      SignatureSha256WithRsa fakeSignature;
+      fakeSignature.setValue(dataBlock(tlv::SignatureValue,
+                                       static_cast<const uint8_t*>(nullptr), 0));
+      data.setSignature(fakeSignature);
+      wires.push_back(data.wireEncode());
+    }
+
+    // InMemoryStorage computes the implicit digest only when needed, while
+    // InMemoryStorageSharded computes it for every packet before taking the shard lock
+    std::vector<shared_ptr<Data>> datas;
+    for (const Block& wire : wires) {
+      datas.push_back(make_shared<Data>(wire));
+    }
+    InMemoryStorageLru single;
+    time::nanoseconds dSingle = timedExecute([&] {
+      for (const shared_ptr<Data>& data : datas) {
+        single.insert(*data);
+      }
+    });
+
+    datas.clear();
+    for (const Block& wire : wires) {
+      datas.push_back(make_shared<Data>(wire));
+    }
+    InMemoryStorageSharded sharded([] (size_t shardLimit) {
+                                     return unique_ptr<InMemoryStorage>(
+                                       new InMemoryStorageLru(shardLimit));
+                                   },
+                                   64, 4);
+    time::nanoseconds dSharded = timedExecute([&] {
+      for (const shared_ptr<Data>& data : datas) {
+        sharded.insert(*data);
+      }
+    });
+
+    std::cout << "content=" << contentSize << "B "
+              << "single=" << (dSingle.count() / nPackets) << "ns/packet "
+              << "sharded=" << (dSharded.count() / nPackets) << "ns/packet" << std::endl;
+  }
+}
+
+static const size_t N_CATALOG = 50000;
+static const size_t N_CACHED = 2500;
+static const size_t N_REQUESTS = 200000;
+
+/** @brief a request trace, as indices into the catalog of Data
+ *
+ *  Requests follow a Zipf distribution over the catalog.  Every @p scanPeriod -th request,
+ *  if nonzero, is replaced by a request for a Data outside the catalog that is never
+ *  requested again, which models a sequential scan.
+ */
+static std::vector<size_t>
+makeTrace(double zipfExponent, size_t scanPeriod)
+{
+  std::vector<double> cdf(N_CATALOG);
+  double sum = 0;
+  for (size_t i = 0; i < N_CATALOG; ++i) {
+    sum += 1.0 / std::pow(i + 1, zipfExponent);
+    cdf[i] = sum;
+  }
+
+  std::mt19937 rng(2015);
+  std::uniform_real_distribution<double> uniform(0, sum);
+  std::vector<size_t> trace;
+  for (size_t i = 0; i < N_REQUESTS; ++i) {
+    if (scanPeriod > 0 && i % scanPeriod == 0) {
+      trace.push_back(N_CATALOG + i);
+    }
+    else {
+      trace.push_back(std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin());
+    }
+  }
+  return trace;
+}
+
+/** @brief replays @p trace, inserting every Data upon a miss
+ */
+template<typename Policy>
+static void
+replayTrace(const char* policyName, const std::vector<size_t>& trace,
+            const std::vector<shared_ptr<Data>>& datas, const std::vector<Interest>& interests)
+{
+  Policy ims(N_CACHED);
+
+  size_t nHits = 0;
+  time::nanoseconds d = timedExecute([&] {
+    for (size_t index : trace) {
+      if (ims.find(interests[index]) != nullptr) {
+        ++nHits;
+      }
+      else {
+        ims.insert(*datas[index]);
+      }
+    }
+  });
+
+  std::cout << "policy=" << policyName << " "
+            << "hit-ratio=" << (100.0 * nHits / trace.size()) << "% "
+            << (d.count() / trace.size()) << "ns/request" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(ReplacementPolicies)
+{
+  std::vector<shared_ptr<Data>> datas;
+  std::vector<Interest> interests;
+  for (size_t i = 0; i < N_CATALOG + N_REQUESTS; ++i) {
+    Name name("/benchmark/ims/policy");
+    name.appendNumber(i);
+    datas.push_back(makeData(name));
+    name.wireEncode();
+    interests.push_back(Interest(name));
+  }
+
+  for (size_t scanPeriod : {0, 3}) {
+    std::vector<size_t> trace = makeTrace(0.8, scanPeriod);
+    std::cout << "trace=" << (scanPeriod == 0 ? "zipf" : "zipf+scan") << std::endl;
+
+    replayTrace<InMemoryStorageFifo>("FIFO", trace, datas, interests);
+    replayTrace<InMemoryStorageLru>("LRU", trace, datas, interests);
+    replayTrace<InMemoryStorageLfu>("LFU", trace, datas, interests);
+    replayTrace<InMemoryStorageClock>("CLOCK", trace, datas, interests);
+    replayTrace<InMemoryStorageSlru>("SLRU", trace, datas, interests);
+  }
+}
+
+static const size_t N_SEGMENTS = 100000;
+
+static std::vector<shared_ptr<Data>>
+makeObject(const Name& prefix)
+{
+  std::vector<shared_ptr<Data>> segments;
+  for (size_t i = 0; i < N_SEGMENTS; ++i) {
+    segments.push_back(makeData(Name(prefix).appendSegment(i)));
+  }
+  return segments;
+}
+
+BOOST_AUTO_TEST_CASE(BulkInsertErase)
+{
+  // the storage already holds an object on each side of the one being published
+  std::vector<shared_ptr<Data>> before = makeObject("/benchmark/ims/bulk/a");
+  std::vector<shared_ptr<Data>> after = makeObject("/benchmark/ims/bulk/c");
+  std::vector<shared_ptr<Data>> segments = makeObject("/benchmark/ims/bulk/b");
+
+  InMemoryStorageLru ims(std::numeric_limits<size_t>::max());
+  ims.insertBatch(before.begin(), before.end());
+  ims.insertBatch(after.begin(), after.end());
+
+  time::nanoseconds d = timedExecute([&] {
+    for (const shared_ptr<Data>& data : segments) {
+      ims.insert(*data);
+    }
+  });
+  std::cout << "insert " << (d.count() / N_SEGMENTS) << "ns/packet" << std::endl;
+
+  d = timedExecute([&] {
+    for (const shared_ptr<Data>& data : segments) {
+      ims.erase(data->getFullName(), false);
+    }
+  });
+  std::cout << "erase-each " << (d.count() / N_SEGMENTS) << "ns/packet" << std::endl;
+
+  d = timedExecute([&] {
+    ims.insertBatch(segments.begin(), segments.end());
+  });
+  std::cout << "insertBatch " << (d.count() / N_SEGMENTS) << "ns/packet" << std::endl;
+
+  d = timedExecute([&] {
+    ims.erase("/benchmark/ims/bulk/b");
+  });
+  std::cout << "erase-prefix " << (d.count() / N_SEGMENTS) << "ns/packet" << std::endl;
+
+  BOOST_CHECK_EQUAL(ims.size(), 2 * N_SEGMENTS);
+}
+
+BOOST_AUTO_TEST_CASE(BulkInsertAppend)
+{
+  // the object being published sorts after every packet in the storage, so each of its
+  // segments is appended at the end
+  std::vector<shared_ptr<Data>> before = makeObject("/benchmark/ims/append/a");
+  std::vector<shared_ptr<Data>> segments = makeObject("/benchmark/ims/append/b");
+
+  InMemoryStorageLru ims(std::numeric_limits<size_t>::max());
+  ims.insertBatch(before.begin(), before.end());
+
+  time::nanoseconds d = timedExecute([&] {
+    for (const shared_ptr<Data>& data : segments) {
+      ims.insert(*data);
+    }
+  });
+  std::cout << "append insert " << (d.count() / N_SEGMENTS) << "ns/packet" << std::endl;
+
+  ims.erase("/benchmark/ims/append/b");
+  BOOST_REQUIRE_EQUAL(ims.size(), N_SEGMENTS);
+
+  d = timedExecute([&] {
+    ims.insertBatch(segments.begin(), segments.end());
+  });
+  std::cout << "append insertBatch " << (d.count() / N_SEGMENTS) << "ns/packet" << std::endl;
+
+  BOOST_CHECK_EQUAL(ims.size(), 2 * N_SEGMENTS);
+}
+
+BOOST_AUTO_TEST_CASE(InsertLargeSegments)
+{
+  const size_t nSegments = 20000;
+  const size_t segmentSize = 8192;
+
+  // packets are received from the network, so their full names have not been computed
+  std::vector<shared_ptr<Data>> segments;
+  std::vector<uint8_t> content(segmentSize);
+  for (size_t i = 0; i < nSegments; ++i) {
+    shared_ptr<Data> data = make_shared<Data>(Name("/benchmark/ims/large").appendSegment(i));
+    data->setContent(content.data(), content.size());
+    SignatureSha256WithRsa fakeSignature;
+    fakeSignature.setValue(dataBlock(tlv::SignatureValue, static_cast<const uint8_t*>(nullptr), 0));
+    data->setSignature(fakeSignature);
+    segments.push_back(make_shared<Data>(data->wireEncode()));
+  }
+
+  InMemoryStorageLru ims(std::numeric_limits<size_t>::max());
+  time::nanoseconds d = timedExecute([&] {
+    for (const shared_ptr<Data>& data : segments) {
+      ims.insert(*data);
+    }
+  });
+
+  std::cout << "insert " << (d.count() / nSegments) << "ns/packet "
+            << static_cast<size_t>(nSegments * segmentSize / (d.count() / 1e9) / 1e6) << "MB/s"
+            << std::endl;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
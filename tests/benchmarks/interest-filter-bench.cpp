@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MAIN 1
+#define BOOST_TEST_DYN_LINK 1
+#define BOOST_TEST_MODULE ndn-cxx Benchmarks (Interest Filter Table)
+
+#include "detail/interest-filter-table.hpp"
+#include "util/random.hpp"
+
+#include "boost-test.hpp"
+#include "timed-execute.hpp"
+
+#include <iostream>
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(BenchmarkInterestFilterTable)
+
+BOOST_AUTO_TEST_CASE(Dispatch)
+{
+  const size_t N_INTERESTS = 20000;
+  const size_t REGEX_EVERY = 10; // one filter out of REGEX_EVERY has a regular expression
+
+  for (size_t nFilters : {10, 1000, 50000}) {
+    size_t nDispatched = 0;
+    auto onInterest = [&nDispatched] (const InterestFilter&, const Interest&) { ++nDispatched; };
+
+    InterestFilterTable table;
+    for (size_t i = 0; i < nFilters; ++i) {
+      Name prefix("/benchmark/filter");
+      prefix.appendNumber(i);
+      if (i % REGEX_EVERY == 0) {
+        table.insert(make_shared<InterestFilterRecord>(InterestFilter(prefix, "<v><>"),
+                                                       onInterest));
+      }
+      else {
+        table.insert(make_shared<InterestFilterRecord>(prefix, onInterest));
+      }
+    }
+
+    std::vector<Interest> interests;
+    for (size_t i = 0; i < N_INTERESTS; ++i) {
+      Name name("/benchmark/filter");
+      name.appendNumber(random::generateWord32() % nFilters).append("v").appendSegment(0);
+      interests.push_back(Interest(name));
+    }
+
+    time::nanoseconds d = timedExecute([&] {
+      for (const Interest& interest : interests) {
+        std::vector<shared_ptr<InterestFilterRecord>> matches =
+          table.findMatching(interest.getName());
+        for (const shared_ptr<InterestFilterRecord>& record : matches) {
+          (*record)(interest);
+        }
+      }
+    });
+
+    BOOST_CHECK_EQUAL(nDispatched, N_INTERESTS);
+    std::cout << "filters=" << nFilters << " "
+              << (d.count() / N_INTERESTS) << "ns/Interest" << std::endl;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
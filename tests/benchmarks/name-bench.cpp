@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MAIN 1
+#define BOOST_TEST_DYN_LINK 1
+#define BOOST_TEST_MODULE ndn-cxx Benchmarks (Name)
+
+#include "name.hpp"
+
+#include "boost-test.hpp"
+#include "timed-execute.hpp"
+
+#include <iostream>
+
+namespace ndn {
+namespace tests {
+
+/** \return a decoded Name of \p nComponents components, which therefore has wire encoding
+ */
+static Name
+makeDecodedName(size_t nComponents, const std::string& lastComponent = "last")
+{
+  Name name;
+  for (size_t i = 1; i < nComponents; ++i) {
+    name.append("component" + std::to_string(i));
+  }
+  name.append(lastComponent);
+  return Name(name.wireEncode());
+}
+
+/** \brief run \p f \p nIterations times and print time per call
+ */
+template<typename F>
+static void
+benchmark(const std::string& what, size_t nComponents, const F& f)
+{
+  const size_t N_ITERATIONS = 1000000;
+  size_t nTrue = 0;
+  time::nanoseconds d = timedExecute([&] {
+    for (size_t i = 0; i < N_ITERATIONS; ++i) {
+      nTrue += f();
+    }
+  });
+  std::cout << what << " " << nComponents << " components: "
+            << d / N_ITERATIONS << " per call (" << nTrue << " true)" << std::endl;
+}
+
+BOOST_AUTO_TEST_SUITE(BenchmarkName)
+
+BOOST_AUTO_TEST_CASE(Compare)
+{
+  for (size_t nComponents : {4, 10, 30}) {
+    Name name = makeDecodedName(nComponents);
+    Name sameName = makeDecodedName(nComponents);
+    Name otherName = makeDecodedName(nComponents, "other");
+    Name prefix = makeDecodedName(nComponents).getPrefix(-1);
+    prefix.wireEncode();
+    BOOST_REQUIRE(name.hasWire() && sameName.hasWire() && otherName.hasWire() && prefix.hasWire());
+
+    benchmark("isPrefixOf (prefix)", nComponents, [&] { return prefix.isPrefixOf(name); });
+    benchmark("isPrefixOf (same)", nComponents, [&] { return sameName.isPrefixOf(name); });
+    benchmark("isPrefixOf (last differs)", nComponents, [&] { return otherName.isPrefixOf(name); });
+    benchmark("equals (same)", nComponents, [&] { return sameName == name; });
+    benchmark("compare (same)", nComponents, [&] { return sameName.compare(name) == 0; });
+    benchmark("compare (last differs)", nComponents, [&] { return otherName.compare(name) < 0; });
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Copy)
+{
+  for (size_t nComponents : {4, 10, 30}) {
+    Name name = makeDecodedName(nComponents);
+    name.getPrefixHash(nComponents); // the cached prefix hashes are not copied
+    Name assigned;
+
+    benchmark("copy-construct (hashed)", nComponents, [&] {
+      Name copy(name);
+      return copy.size() == nComponents;
+    });
+    benchmark("copy-assign (hashed)", nComponents, [&] {
+      assigned = name;
+      return assigned.size() == nComponents;
+    });
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
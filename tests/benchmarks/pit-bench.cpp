@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MAIN 1
+#define BOOST_TEST_DYN_LINK 1
+#define BOOST_TEST_MODULE ndn-cxx Benchmarks (Pending Interest Table)
+
+#include "detail/pending-interest-table.hpp"
+#include "util/random.hpp"
+
+#include "boost-test.hpp"
+#include "timed-execute.hpp"
+
+#include <iostream>
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(BenchmarkPendingInterestTable)
+
+static shared_ptr<PendingInterest>
+makePendingInterest(const Name& name)
+{
+  return make_shared<PendingInterest>(make_shared<Interest>(name),
+                                      PendingInterest::OnData(), PendingInterest::OnTimeout());
+}
+
+BOOST_AUTO_TEST_CASE(SatisfyPerData)
+{
+  const size_t N_DATA = 20000;
+
+  for (size_t nPending : {10, 100, 1000, 10000, 100000}) {
+    PendingInterestTable pit;
+    for (size_t i = 0; i < nPending; ++i) {
+      pit.insert(makePendingInterest(Name("/benchmark/pit").appendNumber(i)));
+    }
+
+    std::vector<shared_ptr<Data>> datas;
+    for (size_t i = 0; i < N_DATA; ++i) {
+      Name dataName("/benchmark/pit");
+      dataName.appendNumber(random::generateWord32() % nPending).appendSegment(0);
+      datas.push_back(make_shared<Data>(dataName));
+    }
+
+    size_t nSatisfied = 0;
+    time::nanoseconds d = timedExecute([&] {
+      for (const shared_ptr<Data>& data : datas) {
+        std::vector<shared_ptr<PendingInterest>> satisfied = pit.extractMatching(*data);
+        nSatisfied += satisfied.size();
+        // keep the table size constant by re-expressing the satisfied Interests
+        for (const shared_ptr<PendingInterest>& pi : satisfied) {
+          pit.insert(makePendingInterest(pi->getInterest()->getName()));
+        }
+      }
+    });
+
+    BOOST_CHECK_EQUAL(nSatisfied, N_DATA);
+    BOOST_CHECK_EQUAL(pit.size(), nPending);
+    std::cout << "pending=" << nPending << " "
+              << (d.count() / N_DATA) << "ns/Data" << std::endl;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(RemoveById)
+{
+  const size_t N_PENDING = 100000;
+
+  PendingInterestTable pit;
+  std::vector<const PendingInterestId*> ids;
+  for (size_t i = 0; i < N_PENDING; ++i) {
+    ids.push_back(pit.insert(makePendingInterest(Name("/benchmark/pit").appendNumber(i))));
+  }
+
+  time::nanoseconds d = timedExecute([&] {
+    for (const PendingInterestId* id : ids) {
+      pit.erase(id);
+    }
+  });
+
+  BOOST_CHECK(pit.empty());
+  std::cout << "pending=" << N_PENDING << " "
+            << (d.count() / N_PENDING) << "ns/removal" << std::endl;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MAIN 1
+#define BOOST_TEST_DYN_LINK 1
+#define BOOST_TEST_MODULE ndn-cxx Benchmarks (Scheduler)
+
+#include "util/scheduler.hpp"
+
+#include "boost-test.hpp"
+#include "timed-execute.hpp"
+
+#include <boost/asio/io_service.hpp>
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(BenchmarkScheduler)
+
+static const size_t N_EVENTS = 200000;
+
+static std::vector<time::nanoseconds>
+makeDelays(size_t nEvents)
+{
+  std::mt19937 rng(2015);
+  std::uniform_int_distribution<int> dist(1000, 10000);
+  std::vector<time::nanoseconds> delays;
+  for (size_t i = 0; i < nEvents; ++i) {
+    delays.push_back(time::milliseconds(dist(rng)));
+  }
+  return delays;
+}
+
+BOOST_AUTO_TEST_CASE(ScheduleCancel)
+{
+  boost::asio::io_service io;
+  Scheduler scheduler(io);
+  std::vector<time::nanoseconds> delays = makeDelays(N_EVENTS);
+  std::vector<EventId> eventIds(N_EVENTS);
+
+  time::nanoseconds d = timedExecute([&] {
+    for (size_t i = 0; i < N_EVENTS; ++i) {
+      eventIds[i] = scheduler.scheduleEvent(delays[i], [] {});
+    }
+  });
+  std::cout << "schedule " << (d.count() / N_EVENTS) << "ns/event" << std::endl;
+
+  std::shuffle(eventIds.begin(), eventIds.end(), std::mt19937(2015));
+  d = timedExecute([&] {
+    for (const EventId& eventId : eventIds) {
+      scheduler.cancelEvent(eventId);
+    }
+  });
+  std::cout << "cancel " << (d.count() / N_EVENTS) << "ns/event" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(Fire)
+{
+  boost::asio::io_service io;
+  Scheduler scheduler(io);
+
+  size_t nFired = 0;
+  for (size_t i = 0; i < N_EVENTS; ++i) {
+    scheduler.scheduleEvent(time::nanoseconds(0), [&nFired] { ++nFired; });
+  }
+
+  time::nanoseconds d = timedExecute([&] {
+    io.run();
+  });
+
+  BOOST_CHECK_EQUAL(nFired, N_EVENTS);
+  std::cout << "fire " << (d.count() / N_EVENTS) << "ns/event" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(Retransmission)
+{
+  // every Interest schedules a retransmission timer, which is cancelled when Data arrives
+  for (size_t nPending : {100, 10000, 100000}) {
+    boost::asio::io_service io;
+    Scheduler scheduler(io);
+    std::vector<time::nanoseconds> delays = makeDelays(N_EVENTS);
+
+    std::vector<EventId> pending(nPending);
+    for (size_t i = 0; i < nPending; ++i) {
+      pending[i] = scheduler.scheduleEvent(delays[i], [] {});
+    }
+
+    time::nanoseconds d = timedExecute([&] {
+      for (size_t i = 0; i < N_EVENTS; ++i) {
+        EventId& eventId = pending[i % nPending];
+        scheduler.cancelEvent(eventId);
+        eventId = scheduler.scheduleEvent(delays[i], [] {});
+      }
+    });
+
+    std::cout << "pending=" << nPending << " "
+              << (d.count() / N_EVENTS) << "ns/cancel+schedule" << std::endl;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MAIN 1
+#define BOOST_TEST_DYN_LINK 1
+#define BOOST_TEST_MODULE ndn-cxx Benchmarks (SmallFunction)
+
+#include "util/small-function.hpp"
+#include "util/scheduler.hpp"
+#include "face.hpp"
+#include "detail/pending-interest.hpp"
+
+#include "boost-test.hpp"
+#include "unit-tests/unit-test-time-fixture.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// allocations are counted by replacing the global operator new, which is why these checks are
+// not part of the unit-tests program
+static std::atomic<size_t> g_nAllocations(0);
+
+void*
+operator new(std::size_t size)
+{
+  g_nAllocations.fetch_add(1, std::memory_order_relaxed);
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void
+operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+namespace ndn {
+namespace tests {
+
+/** \brief counts memory allocations made during its lifetime
+ */
+class AllocationCounter
+{
+public:
+  AllocationCounter()
+    : m_start(g_nAllocations.load())
+  {
+  }
+
+  size_t
+  get() const
+  {
+    return g_nAllocations.load() - m_start;
+  }
+
+private:
+  size_t m_start;
+};
+
+class Consumer
+{
+public:
+  void
+  onData(const Interest&, Data&, const shared_ptr<Consumer>&)
+  {
+    ++nData;
+  }
+
+  void
+  onTimeout(const Interest&, const shared_ptr<Consumer>&)
+  {
+    ++nTimeouts;
+  }
+
+  void
+  onEvent(const shared_ptr<Consumer>&)
+  {
+    ++nEvents;
+  }
+
+public:
+  size_t nData = 0;
+  size_t nTimeouts = 0;
+  size_t nEvents = 0;
+};
+
+BOOST_AUTO_TEST_SUITE(BenchmarkSmallFunction)
+
+BOOST_AUTO_TEST_CASE(NoAllocation)
+{
+  auto consumer = make_shared<Consumer>();
+  Interest interest("/A");
+  Data data("/A");
+
+  AllocationCounter counter;
+  {
+    OnData onData = bind(&Consumer::onData, consumer.get(), _1, _2, consumer);
+    OnTimeout onTimeout = bind(&Consumer::onTimeout, consumer.get(), _1, consumer);
+    OnInterest onInterest = [consumer] (const InterestFilter&, const Interest&) {};
+
+    OnData onData2 = onData;
+    OnData onData3 = std::move(onData);
+    onData2(interest, data);
+    onData3(interest, data);
+    onTimeout(interest);
+  }
+  BOOST_CHECK_EQUAL(counter.get(), 0);
+  BOOST_CHECK_EQUAL(consumer->nData, 2);
+  BOOST_CHECK_EQUAL(consumer->nTimeouts, 1);
+  BOOST_CHECK_EQUAL(consumer.use_count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(PendingInterestNoAllocation)
+{
+  auto consumer = make_shared<Consumer>();
+  auto interest = make_shared<Interest>("/A");
+  OnData onData = bind(&Consumer::onData, consumer.get(), _1, _2, consumer);
+  OnTimeout onTimeout = bind(&Consumer::onTimeout, consumer.get(), _1, consumer);
+
+  AllocationCounter counter;
+  {
+    PendingInterest pendingInterest(interest, onData, onTimeout);
+    pendingInterest.callTimeout();
+  }
+  BOOST_CHECK_EQUAL(counter.get(), 0);
+  BOOST_CHECK_EQUAL(consumer->nTimeouts, 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(SchedulerNoAllocation, UnitTestTimeFixture)
+{
+  static const size_t N_EVENTS = 100;
+
+  auto consumer = make_shared<Consumer>();
+  Scheduler scheduler(io);
+  std::vector<EventId> eventIds(N_EVENTS);
+
+  // the earliest event stays in place, so that the timer is not rearmed
+  scheduler.scheduleEvent(time::milliseconds(10), [] {});
+
+  // fill the event queue, the event pool, and its free list
+  for (size_t i = 0; i < N_EVENTS; ++i) {
+    eventIds[i] = scheduler.scheduleEvent(time::seconds(1),
+                                          bind(&Consumer::onEvent, consumer.get(), consumer));
+  }
+  for (int round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < N_EVENTS; ++i) {
+      scheduler.cancelEvent(eventIds[i]);
+      eventIds[i] = scheduler.scheduleEvent(time::seconds(1),
+                                            bind(&Consumer::onEvent, consumer.get(), consumer));
+    }
+  }
+
+  AllocationCounter counter;
+  for (size_t i = 0; i < N_EVENTS; ++i) {
+    scheduler.cancelEvent(eventIds[i]);
+    eventIds[i] = scheduler.scheduleEvent(time::seconds(1),
+                                          bind(&Consumer::onEvent, consumer.get(), consumer));
+  }
+  BOOST_CHECK_EQUAL(counter.get(), 0);
+
+  advanceClocks(time::milliseconds(100), 11);
+  BOOST_CHECK_EQUAL(consumer->nEvents, N_EVENTS);
+}
+
+BOOST_FIXTURE_TEST_CASE(SchedulerRearmAllocation, UnitTestTimeFixture)
+{
+  static const size_t N_WARMUP_ROUNDS = 3;
+  static const size_t N_ROUNDS = 100;
+
+  auto consumer = make_shared<Consumer>();
+  Scheduler scheduler(io);
+  scheduler.scheduleEvent(time::seconds(10), bind(&Consumer::onEvent, consumer.get(), consumer));
+
+  // applications schedule events from handlers, where Asio recycles the memory of handlers
+  size_t nAllocations = 0;
+  size_t nRounds = 0;
+  function<void()> runRound = [&] {
+    AllocationCounter counter;
+    // the event becomes the earliest one, so that scheduling it rearms the timer,
+    // while canceling it leaves the timer armed until it expires
+    EventId eventId = scheduler.scheduleEvent(time::seconds(1),
+                                              bind(&Consumer::onEvent, consumer.get(), consumer));
+    scheduler.cancelEvent(eventId);
+    if (nRounds >= N_WARMUP_ROUNDS)
+      nAllocations += counter.get();
+
+    if (++nRounds < N_WARMUP_ROUNDS + N_ROUNDS)
+      io.post(runRound);
+  };
+  io.post(runRound);
+  io.poll();
+
+  std::cout << "Scheduler rearm " << N_ROUNDS << " rounds "
+            << nAllocations << " allocations" << std::endl;
+  BOOST_CHECK_EQUAL(nRounds, N_WARMUP_ROUNDS + N_ROUNDS);
+  BOOST_CHECK_EQUAL(nAllocations, 0);
+
+  // the timer expires for the cancelled events, and is rearmed for the remaining one
+  advanceClocks(time::seconds(1), 9);
+  BOOST_CHECK_EQUAL(consumer->nEvents, 0);
+  advanceClocks(time::seconds(1));
+  BOOST_CHECK_EQUAL(consumer->nEvents, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
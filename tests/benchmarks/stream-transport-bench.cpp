@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MAIN 1
+#define BOOST_TEST_DYN_LINK 1
+#define BOOST_TEST_MODULE ndn-cxx Benchmarks (Stream Transport)
+
+#include "transport/stream-transport.hpp"
+#include "data.hpp"
+#include "interest.hpp"
+#include "security/signature-sha256-with-rsa.hpp"
+#include "encoding/buffer-stream.hpp"
+
+#include "boost-test.hpp"
+#include "timed-execute.hpp"
+
+#include <boost/filesystem.hpp>
+#include <iostream>
+
+namespace ndn {
+namespace tests {
+
+using boost::asio::local::stream_protocol;
+
+/** \brief a minimal Transport that exposes StreamTransportImpl statistics
+ */
+class BenchTransport : public Transport
+{
+public:
+  typedef StreamTransportImpl<BenchTransport, stream_protocol> Impl;
+  friend class StreamTransportImpl<BenchTransport, stream_protocol>;
+
+  explicit
+  BenchTransport(const std::string& path)
+    : m_path(path)
+  {
+  }
+
+  virtual void
+  connect(boost::asio::io_service& ioService, const ReceiveCallback& receiveCallback)
+  {
+    Transport::connect(ioService, receiveCallback);
+    m_impl = make_shared<Impl>(ref(*this), ref(ioService));
+    m_impl->connect(stream_protocol::endpoint(m_path));
+  }
+
+  virtual void
+  close()
+  {
+    m_impl->close();
+  }
+
+  virtual void
+  pause()
+  {
+    m_impl->pause();
+  }
+
+  virtual void
+  resume()
+  {
+    m_impl->resume();
+  }
+
+  virtual void
+  send(const Block& wire)
+  {
+    m_impl->send(wire);
+  }
+
+  virtual void
+  send(const Block& header, const Block& payload)
+  {
+    m_impl->send(header, payload);
+  }
+
+  uint64_t
+  getNReceiveCopiedBytes() const
+  {
+    return m_impl->getNReceiveCopiedBytes();
+  }
+
+private:
+  std::string m_path;
+  shared_ptr<Impl> m_impl;
+};
+
+static Block
+makeDataWire(size_t payloadSize)
+{
+  Data data("/benchmark/stream-transport/data");
+  std::vector<uint8_t> payload(payloadSize, 0xBB);
+  data.setContent(payload.data(), payload.size());
+
+  SignatureSha256WithRsa fakeSignature;
+  fakeSignature.setValue(dataBlock(tlv::SignatureValue, reinterpret_cast<const uint8_t*>(0), 0));
+  data.setSignature(fakeSignature);
+  return data.wireEncode();
+}
+
+static std::string
+makeSocketPath()
+{
+  // a unique path, as benchmarks may run concurrently
+  return (boost::filesystem::temp_directory_path() /
+          boost::filesystem::unique_path("ndn-cxx-stream-transport-bench-%%%%-%%%%-%%%%.sock"))
+         .string();
+}
+
+BOOST_AUTO_TEST_SUITE(BenchmarkStreamTransport)
+
+BOOST_AUTO_TEST_CASE(Receive8KData)
+{
+  const size_t N_PACKETS_PER_WRITE = 64;
+  const size_t N_WRITES = 200;
+  const size_t N_PACKETS = N_PACKETS_PER_WRITE * N_WRITES;
+
+  Block wire = makeDataWire(8000);
+  OBufferStream os;
+  for (size_t i = 0; i < N_PACKETS_PER_WRITE; ++i) {
+    os.write(reinterpret_cast<const char*>(wire.wire()), wire.size());
+  }
+  ConstBufferPtr writeBuffer = os.buf();
+
+  std::string path = makeSocketPath();
+
+  for (bool isZeroCopy : {false, true}) {
+    boost::filesystem::remove(path);
+
+    boost::asio::io_service io;
+    stream_protocol::acceptor acceptor(io, stream_protocol::endpoint(path));
+    stream_protocol::socket server(io);
+
+    size_t nWrites = 0;
+    function<void(const boost::system::error_code&)> writeNext =
+      [&] (const boost::system::error_code& error) {
+        if (error || nWrites == N_WRITES)
+          return;
+        ++nWrites;
+        boost::asio::async_write(server, boost::asio::buffer(*writeBuffer),
+                                 bind(writeNext, _1));
+      };
+    acceptor.async_accept(server, writeNext);
+
+    size_t nReceived = 0;
+    size_t nBytesReceived = 0;
+    BenchTransport transport(path);
+    transport.setZeroCopyReceive(isZeroCopy);
+
+    time::nanoseconds d = timedExecute([&] {
+      transport.connect(io, [&] (const Block& block) {
+          nBytesReceived += block.size();
+          if (++nReceived == N_PACKETS) {
+            io.stop();
+          }
+        });
+      io.run();
+    });
+
+    BOOST_CHECK_EQUAL(nReceived, N_PACKETS);
+    BOOST_CHECK_EQUAL(nBytesReceived, N_PACKETS * wire.size());
+
+    std::cout << (isZeroCopy ? "zero-copy" : "copying  ") << " "
+              << (nBytesReceived * 1000 / d.count()) << "MB/s "
+              << (transport.getNReceiveCopiedBytes() / N_PACKETS) << " copied bytes/packet"
+              << std::endl;
+
+    transport.close();
+  }
+
+  boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(SendSmallInterests)
+{
+  const size_t N_INTERESTS_PER_BURST = 1000;
+  const size_t N_BURSTS = 100;
+  const size_t N_INTERESTS = N_INTERESTS_PER_BURST * N_BURSTS;
+
+  Interest interest("/benchmark/stream-transport/interest");
+  interest.setNonce(1);
+  Block wire = interest.wireEncode();
+
+  std::string path = makeSocketPath();
+
+  // batch of one Block is the behavior without write coalescing
+  for (size_t maxBlocks : {1, 64, 1024}) {
+    boost::filesystem::remove(path);
+
+    boost::asio::io_service io;
+    stream_protocol::acceptor acceptor(io, stream_protocol::endpoint(path));
+    stream_protocol::socket server(io);
+
+    size_t nBytesRead = 0;
+    uint8_t readBuffer[65536];
+    function<void(const boost::system::error_code&, size_t)> readNext =
+      [&] (const boost::system::error_code& error, size_t nBytes) {
+        nBytesRead += nBytes;
+        if (error || nBytesRead == N_INTERESTS * wire.size()) {
+          io.stop();
+          return;
+        }
+        server.async_read_some(boost::asio::buffer(readBuffer), bind(readNext, _1, _2));
+      };
+    acceptor.async_accept(server, bind(readNext, _1, 0));
+
+    BenchTransport transport(path);
+    transport.setSendBatchLimits(maxBlocks, std::numeric_limits<size_t>::max());
+
+    size_t nBursts = 0;
+    function<void()> sendBurst = [&] {
+      for (size_t i = 0; i < N_INTERESTS_PER_BURST; ++i) {
+        transport.send(wire);
+      }
+      if (++nBursts < N_BURSTS) {
+        io.post(sendBurst);
+      }
+    };
+
+    time::nanoseconds d = timedExecute([&] {
+      transport.connect(io, [] (const Block&) {});
+      io.post(sendBurst);
+      io.run();
+    });
+
+    BOOST_CHECK_EQUAL(nBytesRead, N_INTERESTS * wire.size());
+    std::cout << "maxBlocks=" << maxBlocks << " "
+              << (N_INTERESTS * 1000000000 / d.count()) << " Interests/s" << std::endl;
+
+    transport.close();
+  }
+
+  boost::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
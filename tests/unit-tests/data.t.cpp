@@ -369,6 +369,39 @@ BOOST_FIXTURE_TEST_CASE(Decode, TestDataFixture)
   BOOST_REQUIRE_EQUAL(signatureVerified, true);
 }
 
+BOOST_AUTO_TEST_CASE(DecodeLazily)
+{
+  Block dataBlock(Data1, sizeof(Data1));
+
+  ndn::Data d;
+  BOOST_REQUIRE_NO_THROW(d.wireDecodeLazily(dataBlock));
+  BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char*>(d.getContent().value()),
+                                d.getContent().value_size()), "SUCCESS!");
+  BOOST_CHECK_EQUAL(d.getName().toUri(), "/local/ndn/prefix");
+  BOOST_CHECK_EQUAL(d.getFreshnessPeriod(), time::seconds(10));
+  BOOST_CHECK_EQUAL(d.getSignature().getType(), static_cast<uint32_t>(Signature::Sha256WithRsa));
+  BOOST_CHECK(d.wireEncode() == dataBlock);
+
+  ndn::Data eager(dataBlock);
+  BOOST_CHECK_EQUAL(d, eager);
+
+  // modification after lazy decoding keeps fields that have not been accessed yet
+  ndn::Data e;
+  e.wireDecodeLazily(dataBlock);
+  e.setFreshnessPeriod(time::seconds(5));
+  BOOST_CHECK_EQUAL(e.getName().toUri(), "/local/ndn/prefix");
+  BOOST_CHECK_EQUAL(e.getContentType(), static_cast<uint32_t>(tlv::ContentType_Blob));
+  BOOST_CHECK(e.getSignature() == eager.getSignature());
+  BOOST_CHECK_EQUAL(e.hasWire(), false);
+
+  // missing mandatory element is reported upfront
+  Block noMetaInfo = dataBlock;
+  noMetaInfo.parse();
+  noMetaInfo.remove(tlv::MetaInfo);
+  noMetaInfo.encode();
+  BOOST_CHECK_THROW(ndn::Data().wireDecodeLazily(noMetaInfo), tlv::Error);
+}
+
 BOOST_FIXTURE_TEST_CASE(Encode, TestDataFixture)
 {
   // manual data packet creation for now
@@ -437,6 +470,38 @@ BOOST_FIXTURE_TEST_CASE(Encode, TestDataFixture)
                     "Signature: (type: 1, value_length: 128)\n");
 }
 
+BOOST_AUTO_TEST_CASE(EncodeExactBuffer)
+{
+  const std::vector<uint8_t> content(1024, 0xbb);
+  const std::vector<uint8_t> value(32, 0x11);
+  Block signatureValue = dataBlock(tlv::SignatureValue, value.data(), value.size());
+
+  ndn::Data d("/local/ndn/prefix");
+  d.setContent(content.data(), content.size());
+  d.setSignature(DigestSha256());
+
+  // the default EncodingBuffer, as used by KeyChain, is much larger than the packet
+  EncodingBuffer encoder;
+  d.wireEncode(encoder, true);
+  const Block& wire = d.wireEncode(encoder, signatureValue);
+  BOOST_CHECK_EQUAL(wire.getBuffer()->size(), wire.size());
+  BOOST_CHECK(wire.getBuffer() != encoder.block(false).getBuffer());
+
+  // the Name refers to the wire encoding of the packet
+  BOOST_REQUIRE(d.getName().hasWire());
+  BOOST_CHECK_EQUAL(d.getName().wireEncode().getBuffer(), wire.getBuffer());
+  BOOST_CHECK_EQUAL(d.getName(), "/local/ndn/prefix");
+  BOOST_CHECK(d.getSignature().getValue() == signatureValue);
+  BOOST_CHECK_EQUAL(ndn::Data(wire), d);
+
+  // neither does the ENCODING_HEADROOM of wireEncode() stay with the packet
+  ndn::Data e(wire);
+  e.setFreshnessPeriod(time::seconds(1));
+  const Block& wire2 = e.wireEncode();
+  BOOST_CHECK_LE(wire2.getBuffer()->size() - wire2.size(), wire2.size() / 8);
+  BOOST_CHECK_EQUAL(e.getName().wireEncode().getBuffer(), wire2.getBuffer());
+}
+
 class DataIdentityFixture
 {
 public:
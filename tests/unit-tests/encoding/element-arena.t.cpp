@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "encoding/element-arena.hpp"
+#include "encoding/block.hpp"
+#include "data.hpp"
+#include "interest.hpp"
+
+#include "boost-test.hpp"
+#include "../make-interest-data.hpp"
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(EncodingElementArena)
+
+static Name
+makeName(size_t nComponents)
+{
+  Name name;
+  for (size_t i = 0; i < nComponents; ++i) {
+    name.appendNumber(i);
+  }
+  return name;
+}
+
+/** @return an unparsed copy of @p wire whose subblocks are allocated from an arena
+ *          of @p capacity octets
+ */
+static Block
+makeArenaWire(const Block& wire, size_t capacity)
+{
+  Block block(wire.wire(), wire.size());
+  block.useElementArena(capacity);
+  return block;
+}
+
+/** @brief decodes an Interest from @p wire and accesses all of its fields
+ */
+static void
+decodeInterest(const Block& wire)
+{
+  Interest interest(wire);
+  BOOST_CHECK_EQUAL(interest.getName().size(), 10);
+  BOOST_CHECK_EQUAL(interest.getNonce(), 1);
+  BOOST_CHECK_EQUAL(interest.getMustBeFresh(), true);
+  BOOST_CHECK_EQUAL(interest.getInterestLifetime(), time::seconds(2));
+}
+
+/** @brief decodes a Data from @p wire and accesses all of its fields
+ */
+static void
+decodeData(const Block& wire)
+{
+  Data data(wire);
+  BOOST_CHECK_EQUAL(data.getName().size(), 10);
+  BOOST_CHECK_EQUAL(data.getFreshnessPeriod(), time::seconds(1));
+  BOOST_CHECK_EQUAL(data.getContent().value_size(), 100);
+  BOOST_CHECK_EQUAL(data.getSignature().getType(), tlv::SignatureSha256WithRsa);
+}
+
+BOOST_AUTO_TEST_CASE(InterestDecode)
+{
+  Interest interest(makeName(10));
+  interest.setNonce(1);
+  interest.setMustBeFresh(true);
+  interest.setInterestLifetime(time::seconds(2));
+  const Block& wire = interest.wireEncode();
+
+  // an arena without capacity passes every allocation to the heap, where it is counted
+  Block heapWire = makeArenaWire(wire, 0);
+  decodeInterest(heapWire);
+  const ElementArena* heapArena = heapWire.getElementArena();
+  BOOST_REQUIRE(heapArena != nullptr);
+  BOOST_CHECK_EQUAL(heapArena->getNAllocations(), 0);
+  BOOST_CHECK_EQUAL(heapArena->getNHeapAllocations(), 3);
+
+  // Interest, Name, and Selectors are allocated from the arena, which is the only allocation
+  Block arenaWire = makeArenaWire(wire, ElementArena::DEFAULT_CAPACITY);
+  decodeInterest(arenaWire);
+  const ElementArena* arena = arenaWire.getElementArena();
+  BOOST_REQUIRE(arena != nullptr);
+  BOOST_CHECK_EQUAL(arena->getNAllocations(), 3);
+  BOOST_CHECK_EQUAL(arena->getNHeapAllocations(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(DataDecode)
+{
+  shared_ptr<Data> data = util::makeData(makeName(10));
+  data->setFreshnessPeriod(time::seconds(1));
+  std::vector<uint8_t> content(100, 0xbb);
+  data->setContent(content.data(), content.size());
+  util::signData(data);
+  const Block& wire = data->wireEncode();
+
+  Block heapWire = makeArenaWire(wire, 0);
+  decodeData(heapWire);
+  const ElementArena* heapArena = heapWire.getElementArena();
+  BOOST_REQUIRE(heapArena != nullptr);
+  BOOST_CHECK_EQUAL(heapArena->getNAllocations(), 0);
+  BOOST_CHECK_EQUAL(heapArena->getNHeapAllocations(), 4);
+
+  // Data, Name, MetaInfo, and SignatureInfo are allocated from the arena
+  Block arenaWire = makeArenaWire(wire, ElementArena::DEFAULT_CAPACITY);
+  decodeData(arenaWire);
+  const ElementArena* arena = arenaWire.getElementArena();
+  BOOST_REQUIRE(arena != nullptr);
+  BOOST_CHECK_EQUAL(arena->getNAllocations(), 4);
+  BOOST_CHECK_EQUAL(arena->getNHeapAllocations(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Overflow)
+{
+  const size_t CAPACITY = 4 * sizeof(Block);
+
+  // subblocks that do not fit are allocated from the heap
+  Block wire = makeArenaWire(makeName(10).wireEncode(), CAPACITY);
+  wire.parse();
+  BOOST_CHECK_EQUAL(wire.elements_size(), 10);
+  BOOST_CHECK_EQUAL(wire.getElementArena()->getNAllocations(), 0);
+  BOOST_CHECK_EQUAL(wire.getElementArena()->getNHeapAllocations(), 1);
+  BOOST_CHECK(wire.elements().back() == makeName(10).wireEncode().elements().back());
+
+  Block smallWire = makeArenaWire(makeName(2).wireEncode(), CAPACITY);
+  smallWire.parse();
+  BOOST_CHECK_EQUAL(smallWire.elements_size(), 2);
+  BOOST_CHECK_EQUAL(smallWire.getElementArena()->getNAllocations(), 1);
+  BOOST_CHECK_EQUAL(smallWire.getElementArena()->getNHeapAllocations(), 0);
+  BOOST_CHECK_LE(smallWire.getElementArena()->getUsedSize(), CAPACITY);
+}
+
+BOOST_AUTO_TEST_CASE(Lifetime)
+{
+  shared_ptr<Data> data = util::makeData(makeName(10));
+  Name name;
+  {
+    Data decoded(makeArenaWire(data->wireEncode(), ElementArena::DEFAULT_CAPACITY));
+    name = decoded.getName();
+  }
+
+  // the copy keeps the arena allocated after the packet is destroyed
+  BOOST_REQUIRE(name.wireEncode().getElementArena() != nullptr);
+  BOOST_CHECK_EQUAL(name, makeName(10));
+
+  // a Name that was not parsed before the packet was destroyed is parsed in the same arena
+  Block nameWire;
+  {
+    Block wire = makeArenaWire(data->wireEncode(), ElementArena::DEFAULT_CAPACITY);
+    wire.parse();
+    nameWire = wire.get(tlv::Name);
+  }
+  size_t nAllocations = nameWire.getElementArena()->getNAllocations();
+  nameWire.parse();
+  BOOST_CHECK_EQUAL(nameWire.elements_size(), 10);
+  BOOST_CHECK_EQUAL(nameWire.getElementArena()->getNAllocations(), nAllocations + 1);
+}
+
+BOOST_AUTO_TEST_CASE(HeapByDefault)
+{
+  Block wire = makeName(10).wireEncode();
+  wire.parse();
+  BOOST_CHECK(wire.getElementArena() == nullptr);
+  BOOST_CHECK(wire.elements().front().getElementArena() == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
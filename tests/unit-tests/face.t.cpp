@@ -23,11 +23,16 @@
 #include "util/scheduler.hpp"
 #include "security/key-chain.hpp"
 #include "util/dummy-client-face.hpp"
+#include "transport/unix-transport.hpp"
 
 #include "boost-test.hpp"
 #include "unit-test-time-fixture.hpp"
 #include "make-interest-data.hpp"
 
+#include <boost/filesystem.hpp>
+
+#include <thread>
+
 namespace ndn {
 namespace tests {
 
@@ -82,6 +87,55 @@ BOOST_AUTO_TEST_CASE(ExpressInterestData)
   BOOST_CHECK_EQUAL(face->sentDatas.size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(ExpressInterestMultipleMatches)
+{
+  std::vector<Name> satisfied;
+  auto onData = [&] (const Interest& i, const Data& d) { satisfied.push_back(i.getName()); };
+  auto onTimeout = bind([] { BOOST_FAIL("Unexpected timeout"); });
+
+  face->expressInterest(Interest("/Hello/World", time::milliseconds(50)), onData, onTimeout);
+  face->expressInterest(Interest("/Hello", time::milliseconds(50)), onData, onTimeout);
+  face->expressInterest(Interest("/Hello/World/!/extra", time::milliseconds(50)),
+                        bind([] { BOOST_FAIL("Unexpected data"); }),
+                        bind([] {}));
+  face->expressInterest(Interest("/", time::milliseconds(50)), onData, onTimeout);
+  advanceClocks(time::milliseconds(10));
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 4);
+
+  face->receive(*util::makeData("/Hello/World/!"));
+  advanceClocks(time::milliseconds(10));
+
+  // callbacks are invoked in the order Interests were expressed
+  BOOST_REQUIRE_EQUAL(satisfied.size(), 3);
+  BOOST_CHECK_EQUAL(satisfied[0], Name("/Hello/World"));
+  BOOST_CHECK_EQUAL(satisfied[1], Name("/Hello"));
+  BOOST_CHECK_EQUAL(satisfied[2], Name("/"));
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 1);
+
+  advanceClocks(time::milliseconds(10), 10);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ExpressInterestImplicitDigest)
+{
+  shared_ptr<Data> data = util::makeData("/Hello/World/!");
+
+  size_t nData = 0;
+  face->expressInterest(Interest(data->getFullName(), time::milliseconds(50)),
+                        bind([&nData] { ++nData; }),
+                        bind([] { BOOST_FAIL("Unexpected timeout"); }));
+  advanceClocks(time::milliseconds(10));
+
+  face->receive(*util::makeData("/Hello/World/?"));
+  advanceClocks(time::milliseconds(10));
+  BOOST_CHECK_EQUAL(nData, 0);
+
+  face->receive(*data);
+  advanceClocks(time::milliseconds(10));
+  BOOST_CHECK_EQUAL(nData, 1);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+}
+
 BOOST_AUTO_TEST_CASE(ExpressInterestTimeout)
 {
   size_t nTimeouts = 0;
@@ -100,6 +154,34 @@ BOOST_AUTO_TEST_CASE(ExpressInterestTimeout)
   BOOST_CHECK_EQUAL(face->sentDatas.size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(ExpressInterestTimeoutPrecision)
+{
+  std::vector<Name> timedOut;
+  auto onData = bind([] { BOOST_FAIL("Unexpected data"); });
+  auto onTimeout = [&] (const Interest& i) { timedOut.push_back(i.getName()); };
+
+  face->expressInterest(Interest("/A", time::milliseconds(30)), onData, onTimeout);
+  face->expressInterest(Interest("/B", time::milliseconds(10)), onData, onTimeout);
+  face->expressInterest(Interest("/C", time::milliseconds(20)), onData, onTimeout);
+  advanceClocks(time::milliseconds(1)); // Interests are expressed during this poll
+
+  advanceClocks(time::milliseconds(1), 9);
+  BOOST_CHECK_EQUAL(timedOut.size(), 0);
+
+  advanceClocks(time::milliseconds(1));
+  BOOST_REQUIRE_EQUAL(timedOut.size(), 1);
+  BOOST_CHECK_EQUAL(timedOut[0], Name("/B"));
+
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(timedOut.size(), 2);
+  BOOST_CHECK_EQUAL(timedOut[1], Name("/C"));
+
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(timedOut.size(), 3);
+  BOOST_CHECK_EQUAL(timedOut[2], Name("/A"));
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+}
+
 BOOST_AUTO_TEST_CASE(RemovePendingInterest)
 {
   const PendingInterestId* interestId =
@@ -257,6 +339,41 @@ BOOST_AUTO_TEST_CASE(SimilarFilters)
   BOOST_CHECK_EQUAL(nInInterests3, 0);
 }
 
+BOOST_FIXTURE_TEST_CASE(FilterDispatchOrder, FacesNoRegistrationReplyFixture)
+{
+  std::vector<Name> dispatched;
+  auto onInterest = [&] (const InterestFilter& filter, const Interest&) {
+    dispatched.push_back(filter.getPrefix());
+  };
+
+  face->setInterestFilter("/Hello/World/!", onInterest);
+  face->setInterestFilter("/", onInterest);
+  const InterestFilterId* filterId = face->setInterestFilter("/Hello", onInterest);
+  face->setInterestFilter(InterestFilter("/Hello", "<World><>"), onInterest);
+  face->setInterestFilter(InterestFilter("/Hello", "<Bye><>"), onInterest);
+  advanceClocks(time::milliseconds(10));
+
+  face->receive(Interest("/Hello/World/!"));
+  advanceClocks(time::milliseconds(10));
+
+  // filters are dispatched in the order they were set
+  BOOST_REQUIRE_EQUAL(dispatched.size(), 4);
+  BOOST_CHECK_EQUAL(dispatched[0], Name("/Hello/World/!"));
+  BOOST_CHECK_EQUAL(dispatched[1], Name("/"));
+  BOOST_CHECK_EQUAL(dispatched[2], Name("/Hello"));
+  BOOST_CHECK_EQUAL(dispatched[3], Name("/Hello"));
+
+  face->unsetInterestFilter(filterId);
+  advanceClocks(time::milliseconds(10));
+  dispatched.clear();
+
+  face->receive(Interest("/Hello/World/?"));
+  advanceClocks(time::milliseconds(10));
+  BOOST_REQUIRE_EQUAL(dispatched.size(), 2);
+  BOOST_CHECK_EQUAL(dispatched[0], Name("/"));
+  BOOST_CHECK_EQUAL(dispatched[1], Name("/Hello"));
+}
+
 BOOST_AUTO_TEST_CASE(SetRegexFilterError)
 {
   face->setInterestFilter(InterestFilter("/Hello/World", "<><b><c>?"),
@@ -452,6 +569,96 @@ BOOST_AUTO_TEST_CASE(ReceiveDataWithLocalControlHeader)
   advanceClocks(time::milliseconds(10), 100);
 }
 
+/** \brief a forwarder at the other end of a Unix stream socket, which replies to one Interest
+ *         with Data of the same Name
+ */
+class UnixSocketPeerFixture
+{
+public:
+  UnixSocketPeerFixture()
+    : path((boost::filesystem::temp_directory_path() /
+            boost::filesystem::unique_path("ndn-cxx-face-test-%%%%-%%%%-%%%%.sock")).string())
+    , acceptor(peerIo, boost::asio::local::stream_protocol::endpoint(path))
+    , peerSocket(peerIo)
+  {
+  }
+
+  ~UnixSocketPeerFixture()
+  {
+    boost::filesystem::remove(path);
+  }
+
+  /** \brief express one Interest on a Face connected to the peer, and process events
+   *  \return whether Data was received, and the time processEvents() took to return
+   */
+  std::pair<bool, time::nanoseconds>
+  expressOneInterest(bool isZeroCopy)
+  {
+    // the peer connection stays open until the fixture is destroyed
+    std::thread peer([this] {
+        acceptor.accept(peerSocket);
+
+        uint8_t buffer[MAX_NDN_PACKET_SIZE];
+        size_t nBytes = 0;
+        bool isOk = false;
+        Block wire;
+        while (!isOk) {
+          nBytes += peerSocket.read_some(boost::asio::buffer(buffer + nBytes,
+                                                             sizeof(buffer) - nBytes));
+          std::tie(isOk, wire) = Block::fromBuffer(buffer, nBytes);
+        }
+
+        Block data = util::makeData(Interest(wire).getName())->wireEncode();
+        boost::asio::write(peerSocket, boost::asio::buffer(data.wire(), data.size()));
+      });
+
+    shared_ptr<UnixTransport> transport = make_shared<UnixTransport>(path);
+    transport->setZeroCopyReceive(isZeroCopy);
+    Face face(transport);
+
+    bool hasData = false;
+    face.expressInterest(Interest("/Hello/World", time::seconds(10)),
+                         bind([&hasData] { hasData = true; }),
+                         bind([] {}));
+
+    time::steady_clock::TimePoint start = time::steady_clock::now();
+    face.processEvents(time::seconds(10));
+    time::nanoseconds duration = time::steady_clock::now() - start;
+
+    peer.join();
+    return std::make_pair(hasData, duration);
+  }
+
+public:
+  std::string path;
+  boost::asio::io_service peerIo;
+  boost::asio::local::stream_protocol::acceptor acceptor;
+  boost::asio::local::stream_protocol::socket peerSocket;
+};
+
+// processEvents() returns as soon as the last Data empties PIT, because the transport is
+// paused outside of its receive handler
+
+BOOST_FIXTURE_TEST_CASE(ProcessEventsReturnsAfterLastData, UnixSocketPeerFixture)
+{
+  bool hasData = false;
+  time::nanoseconds duration;
+  std::tie(hasData, duration) = expressOneInterest(false);
+
+  BOOST_CHECK(hasData);
+  BOOST_CHECK_LT(duration, time::seconds(10));
+}
+
+BOOST_FIXTURE_TEST_CASE(ProcessEventsReturnsAfterLastDataZeroCopy, UnixSocketPeerFixture)
+{
+  bool hasData = false;
+  time::nanoseconds duration;
+  std::tie(hasData, duration) = expressOneInterest(true);
+
+  BOOST_CHECK(hasData);
+  BOOST_CHECK_LT(duration, time::seconds(10));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // tests
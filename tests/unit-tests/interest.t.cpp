@@ -905,6 +905,38 @@ BOOST_AUTO_TEST_CASE(Decode)
   BOOST_CHECK_EQUAL(i.getNonce(), 1U);
 }
 
+BOOST_AUTO_TEST_CASE(DecodeLazily)
+{
+  Block interestBlock(Interest1, sizeof(Interest1));
+
+  ndn::Interest i;
+  BOOST_REQUIRE_NO_THROW(i.wireDecodeLazily(interestBlock));
+  BOOST_CHECK_EQUAL(i.getNonce(), 1U);
+  BOOST_CHECK_EQUAL(i.getName().toUri(), "/local/ndn/prefix");
+  BOOST_CHECK_EQUAL(i.getMinSuffixComponents(), 1);
+  BOOST_CHECK_EQUAL(i.getExclude().toUri(), "alex,xxxx,*,yyyy");
+  BOOST_CHECK(i.wireEncode() == interestBlock);
+
+  // modification after lazy decoding keeps fields that have not been accessed yet
+  ndn::Interest j;
+  j.wireDecodeLazily(interestBlock);
+  j.setScope(2);
+  BOOST_CHECK_EQUAL(j.getName().toUri(), "/local/ndn/prefix");
+  BOOST_CHECK_EQUAL(j.getChildSelector(), 1);
+  BOOST_CHECK_EQUAL(j.getScope(), 2);
+
+  // malformed Name is reported on access
+  Block malformed = interestBlock;
+  malformed.parse();
+  malformed.remove(tlv::Name);
+  static const uint8_t truncatedComponent[] = {0x08, 0x05, 0x01};
+  malformed.push_back(dataBlock(tlv::Name, truncatedComponent, sizeof(truncatedComponent)));
+  malformed.encode();
+  ndn::Interest k;
+  BOOST_REQUIRE_NO_THROW(k.wireDecodeLazily(malformed));
+  BOOST_CHECK_THROW(k.getName(), tlv::Error);
+}
+
 BOOST_AUTO_TEST_CASE(DecodeFromStream)
 {
   boost::iostreams::stream<boost::iostreams::array_source> is(
@@ -24,6 +24,7 @@
 #include "boost-test.hpp"
 #include <boost/tuple/tuple.hpp>
 #include <boost/mpl/vector.hpp>
+#include <thread>
 #include <unordered_map>
 
 namespace ndn {
@@ -347,6 +348,58 @@ BOOST_AUTO_TEST_CASE(UnorderedMap)
   BOOST_CHECK_EQUAL(map[name3], 3);
 }
 
+BOOST_AUTO_TEST_CASE(PrefixHash)
+{
+  std::hash<Name> hash;
+  Name name("/A/B/C");
+  for (size_t i = 0; i <= name.size(); ++i) {
+    BOOST_CHECK_EQUAL(name.getPrefixHash(i), hash(name.getPrefix(i)));
+  }
+  BOOST_CHECK_NE(name.getPrefixHash(2), name.getPrefixHash(3));
+
+  // copies compute their own hashes, so that modification of a copy does not affect them
+  Name copy = name;
+  copy.append("D");
+  BOOST_CHECK_EQUAL(copy.getPrefixHash(3), name.getPrefixHash(3));
+  BOOST_CHECK_EQUAL(copy.getPrefixHash(4), hash(Name("/A/B/C/D")));
+  BOOST_CHECK_EQUAL(name.getPrefixHash(3), hash(Name("/A/B/C")));
+
+  // assignment discards the hashes of the previous value
+  copy = name;
+  BOOST_CHECK_EQUAL(copy.size(), 3);
+  BOOST_CHECK_EQUAL(copy.getPrefixHash(3), hash(Name("/A/B/C")));
+
+  name.clear();
+  BOOST_CHECK_EQUAL(name.getPrefixHash(0), hash(Name()));
+}
+
+BOOST_AUTO_TEST_CASE(PrefixHashConcurrent)
+{
+  const Name name("/A/B/C/D/E/F/G/H");
+  const size_t expected = std::hash<Name>()(Name("/A/B/C/D/E/F/G/H"));
+  name.wireEncode(); // wire encoding is created lazily, which is not thread-safe
+
+  // the first hashing of a const Name, and copying it, may happen on several threads at once
+  std::vector<size_t> hashes(8);
+  std::vector<size_t> copyHashes(8);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    threads.emplace_back([&, i] {
+        hashes[i] = name.getPrefixHash(name.size());
+        Name copy = name;
+        copyHashes[i] = std::hash<Name>()(copy);
+      });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    BOOST_CHECK_EQUAL(hashes[i], expected);
+    BOOST_CHECK_EQUAL(copyHashes[i], expected);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(ImplicitSha256Digest)
 {
   Name n;
@@ -449,6 +502,49 @@ BOOST_AUTO_TEST_CASE(Compare)
   BOOST_CHECK_EQUAL( 1, Name("/Z/A/C/Y").compare(1, 2, Name("/X/A"),   1));
 }
 
+BOOST_AUTO_TEST_CASE(CompareOnWire)
+{
+  // decoded names have wire encoding and are compared on the wire up to the first difference
+  auto decode = [] (const std::string& uri) {
+    return Name(Name(uri).wireEncode());
+  };
+  BOOST_REQUIRE(decode("/A").hasWire());
+
+  BOOST_CHECK_EQUAL( 0, decode("/A/B/C").compare(decode("/A/B/C")));
+  BOOST_CHECK_EQUAL(-1, decode("/A/B/C").compare(decode("/A/B/D")));
+  BOOST_CHECK_EQUAL( 1, decode("/A/BB/C").compare(decode("/A/B/C")));
+  BOOST_CHECK_EQUAL(-1, decode("/A/B").compare(decode("/A/B/C")));
+  BOOST_CHECK_EQUAL( 1, decode("/A/B/C").compare(decode("/A/B")));
+  BOOST_CHECK_EQUAL(-1, decode("/A/B/C").compare(decode("/A/BB")));
+  BOOST_CHECK_EQUAL(-1, decode("/A/" + std::string(300, 'B')).compare(
+                          decode("/A/" + std::string(300, 'C'))));
+  BOOST_CHECK_EQUAL( 0, decode("/Z/A/Y").compare(1, 1, decode("/X/A/W"), 1, 1));
+
+  BOOST_CHECK(decode("/A/B").isPrefixOf(decode("/A/B/C")));
+  BOOST_CHECK(!decode("/A/B").isPrefixOf(decode("/A/BB/C")));
+  BOOST_CHECK(!decode("/A/BB").isPrefixOf(decode("/A/B")));
+  BOOST_CHECK(decode("/").isPrefixOf(decode("/A")));
+  BOOST_CHECK_EQUAL(decode("/A/B"), decode("/A/B"));
+  BOOST_CHECK_NE(decode("/A/B"), decode("/A/C"));
+
+  // name with wire encoding compared to name without
+  Name appended("/A");
+  appended.append("B");
+  BOOST_REQUIRE(!appended.hasWire());
+  BOOST_CHECK_EQUAL(appended, decode("/A/B"));
+  BOOST_CHECK(appended.isPrefixOf(decode("/A/B/C")));
+  BOOST_CHECK_EQUAL(-1, appended.compare(decode("/A/C")));
+
+  // components of different types with the same TLV-VALUE
+  uint8_t digest[32] = {};
+  Name generic("/A");
+  generic.append(digest, sizeof(digest));
+  Name implicit("/A");
+  implicit.appendImplicitSha256Digest(digest, sizeof(digest));
+  BOOST_CHECK_EQUAL(1, generic.compare(implicit));
+  BOOST_CHECK_EQUAL(1, Name(generic.wireEncode()).compare(Name(implicit.wireEncode())));
+}
+
 BOOST_AUTO_TEST_CASE(ZeroLengthComponentCompare)
 {
   name::Component comp0("");
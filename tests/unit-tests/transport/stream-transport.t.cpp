@@ -0,0 +1,527 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "transport/stream-transport.hpp"
+#include "encoding/block-helpers.hpp"
+
+#include "boost-test.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <set>
+#include <thread>
+
+namespace ndn {
+namespace tests {
+
+using boost::asio::local::stream_protocol;
+
+/** \brief a Transport over a local stream socket, exposing the state of StreamTransportImpl
+ */
+class StreamTestTransport : public Transport
+{
+public:
+  class Impl : public StreamTransportImpl<StreamTestTransport, stream_protocol>
+  {
+  public:
+    Impl(StreamTestTransport& transport, boost::asio::io_service& ioService)
+      : StreamTransportImpl<StreamTestTransport, stream_protocol>(transport, ioService)
+    {
+    }
+
+    const Buffer*
+    getChunk() const
+    {
+      return m_chunk.get();
+    }
+
+    size_t
+    getNPooledChunks() const
+    {
+      return m_chunkPool.size();
+    }
+
+    size_t
+    getNBlocksInFlight() const
+    {
+      return m_nBlocksInFlight;
+    }
+
+    size_t
+    getNBytesInFlight() const
+    {
+      return m_nBlocksInFlight == 0 ? 0 : boost::asio::buffer_size(m_writeBuffers);
+    }
+  };
+
+  friend class StreamTransportImpl<StreamTestTransport, stream_protocol>;
+
+  explicit
+  StreamTestTransport(const std::string& path)
+    : m_path(path)
+  {
+  }
+
+  virtual void
+  connect(boost::asio::io_service& ioService, const ReceiveCallback& receiveCallback)
+  {
+    Transport::connect(ioService, receiveCallback);
+    m_impl = make_shared<Impl>(ref(*this), ref(ioService));
+    m_impl->connect(stream_protocol::endpoint(m_path));
+  }
+
+  virtual void
+  close()
+  {
+    m_impl->close();
+  }
+
+  virtual void
+  pause()
+  {
+    m_impl->pause();
+  }
+
+  virtual void
+  resume()
+  {
+    m_impl->resume();
+  }
+
+  virtual void
+  send(const Block& wire)
+  {
+    m_impl->send(wire);
+  }
+
+  virtual void
+  send(const Block& header, const Block& payload)
+  {
+    m_impl->send(header, payload);
+  }
+
+  Impl&
+  getImpl()
+  {
+    return *m_impl;
+  }
+
+private:
+  std::string m_path;
+  shared_ptr<Impl> m_impl;
+};
+
+static std::string
+makeSocketPath()
+{
+  // a unique path, as test programs may run concurrently
+  boost::filesystem::path path = boost::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("ndn-cxx-stream-transport-test-%%%%-%%%%-%%%%.sock");
+  return path.string();
+}
+
+class StreamTransportFixture
+{
+public:
+  StreamTransportFixture()
+    : path(makeSocketPath())
+    , acceptor(io, stream_protocol::endpoint(path))
+    , server(io)
+    , transport(path)
+    , nWrittenPackets(0)
+    , isHoldingBlocks(false)
+    , isPausingOnReceive(false)
+    , maxBatchBlocks(0)
+    , maxBatchBytes(0)
+  {
+  }
+
+  ~StreamTransportFixture()
+  {
+    transport.close();
+    boost::filesystem::remove(path);
+  }
+
+  /** \brief connect the transport, and start receiving with or without zero-copy
+   */
+  void
+  connect(bool isZeroCopy)
+  {
+    bool isAccepted = false;
+    acceptor.async_accept(server, [&isAccepted] (const boost::system::error_code&) {
+        isAccepted = true;
+      });
+
+    transport.setZeroCopyReceive(isZeroCopy);
+    transport.connect(io, bind(&StreamTransportFixture::onReceive, this, _1));
+    pollUntil([&] { return isAccepted && transport.isConnected(); });
+    BOOST_REQUIRE(transport.isConnected());
+  }
+
+  /** \brief processes events until \p predicate holds, for at most a few seconds
+   */
+  void
+  pollUntil(const function<bool()>& predicate)
+  {
+    for (int i = 0; i < 5000 && !predicate(); ++i) {
+      io.poll();
+      io.reset();
+      if (!predicate()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+  }
+
+  /** \brief writes \p nPackets TLV elements with \p valueSize octets of value from the peer,
+   *         and waits until they are received
+   */
+  void
+  writePackets(size_t nPackets, size_t valueSize)
+  {
+    std::vector<uint8_t> bytes;
+    for (size_t i = 0; i < nPackets; ++i) {
+      std::vector<uint8_t> value(valueSize, static_cast<uint8_t>(nWrittenPackets++));
+      Block block = dataBlock(tlv::Content, value.data(), value.size());
+      bytes.insert(bytes.end(), block.begin(), block.end());
+    }
+    writtenBytes.insert(writtenBytes.end(), bytes.begin(), bytes.end());
+
+    boost::asio::write(server, boost::asio::buffer(bytes));
+    pollUntil([this] { return receivedBytes.size() == writtenBytes.size(); });
+  }
+
+  /** \brief reads from the peer until \p nBytes octets are received in total, while recording
+   *         the largest batch written by the transport
+   *
+   *  Handlers are executed one at a time, so that every batch is observed while in flight.
+   */
+  void
+  readAtPeer(size_t nBytes)
+  {
+    const StreamTestTransport::Impl& impl = transport.getImpl();
+    for (int i = 0; i < 50000 && peerBytes.size() < nBytes; ++i) {
+      maxBatchBlocks = std::max(maxBatchBlocks, impl.getNBlocksInFlight());
+      if (impl.getNBlocksInFlight() > 1) {
+        maxBatchBytes = std::max(maxBatchBytes, impl.getNBytesInFlight());
+      }
+
+      while (server.is_open() && server.available() > 0) {
+        std::vector<uint8_t> bytes(server.available());
+        boost::asio::read(server, boost::asio::buffer(bytes));
+        peerBytes.insert(peerBytes.end(), bytes.begin(), bytes.end());
+      }
+
+      if (io.poll_one() == 0) {
+        io.reset();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    }
+  }
+
+  /** \brief pause the transport from a receive callback, when there is no receive operation
+   *         for pause() to cancel, and check that no more data is received until it is resumed
+   */
+  void
+  checkPauseFromReceiveCallback()
+  {
+    isPausingOnReceive = true;
+    writePackets(1, 100);
+    BOOST_CHECK(!transport.isExpectingData());
+    isPausingOnReceive = false;
+
+    std::vector<uint8_t> value(100, 0xff);
+    Block block = dataBlock(tlv::Content, value.data(), value.size());
+    writtenBytes.insert(writtenBytes.end(), block.begin(), block.end());
+    boost::asio::write(server, boost::asio::buffer(block.wire(), block.size()));
+    for (int i = 0; i < 50; ++i) {
+      io.poll();
+      io.reset();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    BOOST_CHECK_EQUAL(receivedBytes.size(), writtenBytes.size() - block.size());
+
+    transport.resume();
+    pollUntil([this] { return receivedBytes.size() == writtenBytes.size(); });
+    BOOST_CHECK(receivedBytes == writtenBytes);
+  }
+
+  /** \return TLV elements received by the peer
+   */
+  std::vector<Block>
+  getPeerBlocks() const
+  {
+    std::vector<Block> blocks;
+    size_t offset = 0;
+    while (offset < peerBytes.size()) {
+      bool isOk = false;
+      Block block;
+      std::tie(isOk, block) = Block::fromBuffer(peerBytes.data() + offset,
+                                                peerBytes.size() - offset);
+      if (!isOk)
+        break;
+      blocks.push_back(block);
+      offset += block.size();
+    }
+    return blocks;
+  }
+
+  void
+  onReceive(const Block& block)
+  {
+    receivedBuffers.insert(block.getBuffer().get());
+    receivedBytes.insert(receivedBytes.end(), block.begin(), block.end());
+    if (isHoldingBlocks) {
+      heldBlocks.push_back(block);
+    }
+    if (isPausingOnReceive) {
+      transport.pause();
+    }
+  }
+
+  /** \return whether each held Block still has the value it was received with
+   */
+  bool
+  areHeldBlocksIntact() const
+  {
+    for (const Block& block : heldBlocks) {
+      if (block.value_size() == 0)
+        return false;
+      uint8_t expected = block.value()[0];
+      for (size_t i = 0; i < block.value_size(); ++i) {
+        if (block.value()[i] != expected)
+          return false;
+      }
+    }
+    return true;
+  }
+
+public:
+  boost::asio::io_service io;
+  std::string path;
+  stream_protocol::acceptor acceptor;
+  stream_protocol::socket server;
+  StreamTestTransport transport;
+
+  size_t nWrittenPackets;
+  std::vector<uint8_t> writtenBytes;
+  std::vector<uint8_t> receivedBytes;
+  std::set<const Buffer*> receivedBuffers;
+  bool isHoldingBlocks;
+  std::vector<Block> heldBlocks;
+  bool isPausingOnReceive;
+
+  std::vector<uint8_t> peerBytes;
+  size_t maxBatchBlocks;
+  size_t maxBatchBytes;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TransportStreamTransport, StreamTransportFixture)
+
+// element of 7994 octets: 1 octet of type, 3 octets of length, and 7990 octets of value
+static const size_t VALUE_SIZE = 7990;
+static const size_t ELEMENT_SIZE = 7994;
+
+BOOST_AUTO_TEST_CASE(ZeroCopySplitAcrossRefill)
+{
+  connect(true);
+
+  // nine elements do not fit in a chunk, so the ninth is completed after a refill
+  writePackets(9, VALUE_SIZE);
+
+  BOOST_CHECK_EQUAL(receivedBytes.size(), 9 * ELEMENT_SIZE);
+  BOOST_CHECK(receivedBytes == writtenBytes);
+  BOOST_CHECK_GT(transport.getImpl().getNReceiveCopiedBytes(), 0);
+  BOOST_CHECK_LT(transport.getImpl().getNReceiveCopiedBytes(), ELEMENT_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(ZeroCopyCompactInPlace)
+{
+  connect(true);
+  const Buffer* chunk = transport.getImpl().getChunk();
+
+  // received Blocks are not retained, so the chunk is reused in place upon every refill
+  for (int i = 0; i < 5; ++i) {
+    writePackets(8, VALUE_SIZE);
+  }
+
+  BOOST_CHECK(receivedBytes == writtenBytes);
+  BOOST_CHECK_EQUAL(receivedBuffers.size(), 1);
+  BOOST_CHECK(receivedBuffers.count(chunk) > 0);
+  BOOST_CHECK_EQUAL(transport.getImpl().getChunk(), chunk);
+  BOOST_CHECK_EQUAL(transport.getImpl().getNPooledChunks(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ZeroCopyCopyOutWhenHeld)
+{
+  connect(true);
+  const Buffer* chunk = transport.getImpl().getChunk();
+
+  isHoldingBlocks = true;
+  writePackets(9, VALUE_SIZE);
+
+  // the held chunk is not overwritten: the incomplete element is moved to another chunk
+  BOOST_CHECK(receivedBytes == writtenBytes);
+  BOOST_CHECK_EQUAL(heldBlocks.size(), 9);
+  BOOST_CHECK(areHeldBlocksIntact());
+  BOOST_CHECK_EQUAL(receivedBuffers.size(), 2);
+  BOOST_CHECK(transport.getImpl().getChunk() != chunk);
+  BOOST_CHECK_EQUAL(heldBlocks.front().getBuffer().get(), chunk);
+  BOOST_CHECK(heldBlocks.back().getBuffer().get() != chunk);
+  BOOST_CHECK_EQUAL(transport.getImpl().getNPooledChunks(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ZeroCopyPoolReuse)
+{
+  connect(true);
+  const Buffer* firstChunk = transport.getImpl().getChunk();
+
+  isHoldingBlocks = true;
+  writePackets(9, VALUE_SIZE);
+  const Buffer* secondChunk = transport.getImpl().getChunk();
+  BOOST_REQUIRE(secondChunk != firstChunk);
+
+  // after Blocks in the first chunk are released, it is taken from the pool upon next refill
+  heldBlocks.clear();
+  writePackets(8, VALUE_SIZE);
+
+  BOOST_CHECK(receivedBytes == writtenBytes);
+  BOOST_CHECK(areHeldBlocksIntact());
+  BOOST_CHECK_EQUAL(transport.getImpl().getChunk(), firstChunk);
+  BOOST_CHECK_EQUAL(heldBlocks.back().getBuffer().get(), firstChunk);
+  BOOST_CHECK_EQUAL(receivedBuffers.size(), 2);
+  BOOST_CHECK_EQUAL(transport.getImpl().getNPooledChunks(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ZeroCopyOversizeElement)
+{
+  connect(true);
+
+  // TLV-LENGTH of 9000 exceeds MAX_NDN_PACKET_SIZE; the complete element fits in a chunk
+  std::vector<uint8_t> bytes = {tlv::Content, 253, 0x23, 0x28};
+  bytes.resize(4 + 9000);
+  boost::asio::write(server, boost::asio::buffer(bytes));
+
+  BOOST_CHECK_THROW(pollUntil([] { return false; }), Transport::Error);
+  BOOST_CHECK(receivedBytes.empty());
+  BOOST_CHECK(!transport.isConnected());
+}
+
+BOOST_AUTO_TEST_CASE(PauseFromReceiveCallback)
+{
+  connect(false);
+  checkPauseFromReceiveCallback();
+}
+
+BOOST_AUTO_TEST_CASE(ZeroCopyPauseFromReceiveCallback)
+{
+  connect(true);
+  checkPauseFromReceiveCallback();
+}
+
+static Block
+makeSendBlock(size_t i)
+{
+  // every tenth Block alone exceeds the byte limit of a batch
+  std::vector<uint8_t> value(i % 10 == 0 ? 25000 : 100 + i * 37 % 3000, static_cast<uint8_t>(i));
+  return dataBlock(tlv::Content, value.data(), value.size());
+}
+
+BOOST_AUTO_TEST_CASE(GatherWriteBatches)
+{
+  const size_t MAX_BLOCKS = 4;
+  const size_t MAX_BYTES = 20000;
+
+  std::vector<Block> sent;
+  size_t nBytes = 0;
+  for (size_t i = 0; i < 100; ++i) {
+    sent.push_back(makeSendBlock(i));
+    nBytes += sent.back().size();
+  }
+
+  connect(false);
+  transport.setSendBatchLimits(MAX_BLOCKS, MAX_BYTES);
+
+  for (size_t i = 0; i < 50; ++i) {
+    transport.send(sent[i]);
+  }
+  // the first Block is being written, and the others are queued
+  BOOST_CHECK_EQUAL(transport.getImpl().getNBlocksInFlight(), 1);
+
+  // more Blocks are sent while batches are in flight
+  io.post([&] {
+      for (size_t i = 50; i < 90; ++i) {
+        transport.send(sent[i]);
+      }
+      for (size_t i = 90; i < 100; i += 2) {
+        transport.send(sent[i], sent[i + 1]);
+      }
+    });
+
+  readAtPeer(nBytes);
+
+  BOOST_CHECK_EQUAL(peerBytes.size(), nBytes);
+  std::vector<Block> received = getPeerBlocks();
+  BOOST_REQUIRE_EQUAL(received.size(), sent.size());
+  for (size_t i = 0; i < sent.size(); ++i) {
+    BOOST_CHECK(received[i] == sent[i]);
+  }
+
+  // Blocks were coalesced, within the limits
+  BOOST_CHECK_GT(maxBatchBlocks, 1);
+  BOOST_CHECK_LE(maxBatchBlocks, MAX_BLOCKS);
+  BOOST_CHECK_LE(maxBatchBytes, MAX_BYTES);
+  BOOST_CHECK_EQUAL(transport.getImpl().getNBlocksInFlight(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(GatherWriteBeforeConnect)
+{
+  std::vector<Block> sent;
+  size_t nBytes = 0;
+  for (size_t i = 1; i < 10; ++i) {
+    sent.push_back(makeSendBlock(i));
+    nBytes += sent.back().size();
+  }
+
+  // Blocks sent before the connection is established are written after it
+  bool isAccepted = false;
+  acceptor.async_accept(server, [&isAccepted] (const boost::system::error_code&) {
+      isAccepted = true;
+    });
+  transport.connect(io, bind(&StreamTransportFixture::onReceive, this, _1));
+  for (const Block& block : sent) {
+    transport.send(block);
+  }
+  BOOST_CHECK_EQUAL(transport.getImpl().getNBlocksInFlight(), 0);
+
+  readAtPeer(nBytes);
+
+  BOOST_CHECK(isAccepted);
+  std::vector<Block> received = getPeerBlocks();
+  BOOST_REQUIRE_EQUAL(received.size(), sent.size());
+  for (size_t i = 0; i < sent.size(); ++i) {
+    BOOST_CHECK(received[i] == sent[i]);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,402 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "util/disk-storage.hpp"
+
+#include "boost-test.hpp"
+#include "../make-interest-data.hpp"
+#include "../unit-test-time-fixture.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+class DiskStorageFixture : public ndn::tests::UnitTestTimeFixture
+{
+public:
+  DiskStorageFixture()
+    : dir(boost::filesystem::current_path() / "tmp-disk-storage")
+  {
+    boost::filesystem::remove_all(dir);
+  }
+
+  ~DiskStorageFixture()
+  {
+    boost::filesystem::remove_all(dir);
+  }
+
+  static shared_ptr<Data>
+  makeDataWithContent(const Name& name, size_t contentSize = 100)
+  {
+    shared_ptr<Data> data = make_shared<Data>(name);
+    std::vector<uint8_t> content(contentSize, static_cast<uint8_t>(name.size()));
+    data->setContent(content.data(), content.size());
+    return signData(data);
+  }
+
+  /** @brief makes the write with index @p nFailingWrite (counting from 0) write half of its
+   *         octets, and the next write fail
+   *  @param isReadOnly whether the file is also made read-only, so that it cannot be truncated
+   */
+  static void
+  injectFailure(DiskStorage& storage, size_t nFailingWrite, bool isReadOnly = false)
+  {
+    auto nWrites = make_shared<size_t>(0);
+    storage.m_write = [=] (int fd, const void* buffer, size_t size) -> ssize_t {
+      size_t i = (*nWrites)++;
+      if (i < nFailingWrite) {
+        return ::write(fd, buffer, size);
+      }
+      if (i == nFailingWrite) {
+        return ::write(fd, buffer, size / 2);
+      }
+
+      if (isReadOnly) {
+        int readOnlyFd = ::open("/dev/null", O_RDONLY);
+        ::dup2(readOnlyFd, fd);
+        ::close(readOnlyFd);
+      }
+      errno = ENOSPC;
+      return -1;
+    };
+  }
+
+public:
+  boost::filesystem::path dir;
+};
+
+BOOST_FIXTURE_TEST_SUITE(UtilDiskStorage, DiskStorageFixture)
+
+BOOST_AUTO_TEST_CASE(InsertFind)
+{
+  DiskStorage storage(dir);
+  BOOST_CHECK_EQUAL(storage.size(), 0);
+
+  shared_ptr<Data> data1 = makeDataWithContent("/A/1");
+  shared_ptr<Data> data2 = makeDataWithContent("/A/2/x");
+  shared_ptr<Data> data3 = makeDataWithContent("/A/2/y");
+  storage.insert(*data3);
+  storage.insert(*data1);
+  storage.insert(*data2);
+  storage.insert(*data1);
+  BOOST_CHECK_EQUAL(storage.size(), 3);
+
+  shared_ptr<Interest> interest = makeInterest("/A");
+  BOOST_REQUIRE(storage.find(*interest) != nullptr);
+  BOOST_CHECK_EQUAL(*storage.find(*interest), *data1);
+
+  interest->setChildSelector(1);
+  BOOST_REQUIRE(storage.find(*interest) != nullptr);
+  BOOST_CHECK_EQUAL(*storage.find(*interest), *data2);
+
+  BOOST_REQUIRE(storage.find(*makeInterest(data3->getFullName())) != nullptr);
+  BOOST_CHECK_EQUAL(*storage.find(*makeInterest(data3->getFullName())), *data3);
+  BOOST_REQUIRE(storage.find(Name("/A/2")) != nullptr);
+  BOOST_CHECK_EQUAL(*storage.find(Name("/A/2")), *data2);
+
+  BOOST_CHECK(storage.find(*makeInterest("/B")) == nullptr);
+  BOOST_CHECK(storage.find(Name("/A/3")) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Selectors)
+{
+  DiskStorage storage(dir);
+  storage.insert(*makeDataWithContent("/A/1"));
+  storage.insert(*makeDataWithContent("/A/2/x"));
+
+  shared_ptr<Interest> interest = makeInterest("/A");
+  interest->setMinSuffixComponents(3);
+  BOOST_REQUIRE(storage.find(*interest) != nullptr);
+  BOOST_CHECK_EQUAL(storage.find(*interest)->getName(), "/A/2/x");
+
+  interest = makeInterest("/A");
+  Exclude exclude;
+  exclude.excludeOne(name::Component("1"));
+  interest->setExclude(exclude);
+  BOOST_REQUIRE(storage.find(*interest) != nullptr);
+  BOOST_CHECK_EQUAL(storage.find(*interest)->getName(), "/A/2/x");
+}
+
+BOOST_AUTO_TEST_CASE(MustBeFresh)
+{
+  shared_ptr<Interest> interest = makeInterest("/A");
+  interest->setMustBeFresh(true);
+  {
+    DiskStorage storage(dir);
+
+    shared_ptr<Data> data1 = makeData("/A/1");
+    data1->setFreshnessPeriod(time::seconds(1));
+    signData(data1);
+    storage.insert(*data1);
+    storage.insert(*makeData("/A/2"));
+
+    BOOST_REQUIRE(storage.find(*interest) != nullptr);
+    BOOST_CHECK_EQUAL(storage.find(*interest)->getName(), "/A/1");
+
+    advanceClocks(time::milliseconds(1500));
+    BOOST_REQUIRE(storage.find(*interest) != nullptr);
+    BOOST_CHECK_EQUAL(storage.find(*interest)->getName(), "/A/2");
+  }
+
+  // freshness is kept across restarts
+  DiskStorage reopened(dir);
+  BOOST_REQUIRE(reopened.find(*interest) != nullptr);
+  BOOST_CHECK_EQUAL(reopened.find(*interest)->getName(), "/A/2");
+}
+
+BOOST_AUTO_TEST_CASE(Erase)
+{
+  DiskStorage storage(dir);
+  shared_ptr<Data> data1 = makeDataWithContent("/A/1");
+  storage.insert(*data1);
+  storage.insert(*makeDataWithContent("/A/2"));
+  storage.insert(*makeDataWithContent("/B/1"));
+  storage.insert(*makeDataWithContent("/B/2"));
+
+  storage.erase("/A/1", false);
+  BOOST_CHECK_EQUAL(storage.size(), 4);
+  storage.erase(data1->getFullName(), false);
+  BOOST_CHECK_EQUAL(storage.size(), 3);
+  BOOST_CHECK(storage.find(Name("/A/1")) == nullptr);
+
+  storage.erase("/B");
+  BOOST_CHECK_EQUAL(storage.size(), 1);
+  BOOST_CHECK(storage.find(Name("/B")) == nullptr);
+  BOOST_CHECK(storage.find(Name("/A/2")) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Reopen)
+{
+  std::vector<shared_ptr<Data>> datas;
+  {
+    DiskStorage storage(dir);
+    // enough packets to grow the mapping beyond its initial size
+    for (int i = 0; i < 500; ++i) {
+      datas.push_back(makeDataWithContent(Name("/R").appendSegment(i), 4000));
+      storage.insert(*datas.back());
+    }
+    storage.erase(Name("/R").appendSegment(7));
+    storage.flush();
+  }
+
+  DiskStorage storage(dir);
+  BOOST_CHECK_EQUAL(storage.size(), 499);
+  BOOST_CHECK(storage.find(Name("/R").appendSegment(7)) == nullptr);
+  for (int i = 0; i < 500; i += 37) {
+    if (i == 7)
+      continue;
+    shared_ptr<const Data> found = storage.find(*makeInterest(Name("/R").appendSegment(i)));
+    BOOST_REQUIRE(found != nullptr);
+    BOOST_CHECK_EQUAL(*found, *datas[i]);
+  }
+
+  storage.insert(*makeDataWithContent("/S"));
+  BOOST_CHECK_EQUAL(storage.size(), 500);
+  BOOST_CHECK_EQUAL(storage.getSegmentFileSize(), boost::filesystem::file_size(dir / "segments"));
+}
+
+BOOST_AUTO_TEST_CASE(CompactIndex)
+{
+  boost::filesystem::path indexPath = dir / "index";
+  uintmax_t liveIndexSize = 0;
+  {
+    DiskStorage storage(dir);
+    for (int i = 0; i < 10; ++i) {
+      storage.insert(*makeDataWithContent(Name("/C").appendSegment(i)));
+    }
+    liveIndexSize = boost::filesystem::file_size(indexPath);
+  }
+
+  {
+    // one record per stored packet is not compacted
+    DiskStorage storage(dir);
+    BOOST_CHECK_EQUAL(boost::filesystem::file_size(indexPath), liveIndexSize);
+
+    for (int i = 0; i < 10; ++i) {
+      storage.insert(*makeDataWithContent(Name("/E").appendSegment(i)));
+    }
+    storage.erase("/E");
+  }
+
+  {
+    DiskStorage storage(dir);
+    BOOST_CHECK_EQUAL(storage.size(), 10);
+    BOOST_CHECK_EQUAL(boost::filesystem::file_size(indexPath), liveIndexSize);
+    BOOST_CHECK(!boost::filesystem::exists(dir / "index.tmp"));
+    BOOST_CHECK(storage.find(Name("/E")) == nullptr);
+
+    // records are appended to the compacted index
+    storage.erase(Name("/C").appendSegment(3));
+  }
+
+  DiskStorage storage(dir);
+  BOOST_CHECK_EQUAL(storage.size(), 9);
+  BOOST_CHECK(storage.find(Name("/C").appendSegment(3)) == nullptr);
+  BOOST_REQUIRE(storage.find(Name("/C").appendSegment(4)) != nullptr);
+  BOOST_CHECK_EQUAL(storage.find(Name("/C").appendSegment(4))->getName(),
+                    Name("/C").appendSegment(4));
+}
+
+BOOST_AUTO_TEST_CASE(TruncatedIndex)
+{
+  {
+    DiskStorage storage(dir);
+    storage.insert(*makeDataWithContent("/A/1"));
+    storage.insert(*makeDataWithContent("/A/2"));
+  }
+
+  // a record that was being written when the process was terminated
+  boost::filesystem::path indexPath = dir / "index";
+  boost::filesystem::resize_file(indexPath, boost::filesystem::file_size(indexPath) - 3);
+
+  {
+    DiskStorage storage(dir);
+    BOOST_CHECK_EQUAL(storage.size(), 1);
+    BOOST_CHECK(storage.find(Name("/A/1")) != nullptr);
+    BOOST_CHECK(storage.find(Name("/A/2")) == nullptr);
+    storage.insert(*makeDataWithContent("/A/3"));
+  }
+
+  DiskStorage storage(dir);
+  BOOST_CHECK_EQUAL(storage.size(), 2);
+  BOOST_REQUIRE(storage.find(Name("/A/3")) != nullptr);
+  BOOST_CHECK_EQUAL(storage.find(Name("/A/3"))->getName(), "/A/3");
+}
+
+BOOST_AUTO_TEST_CASE(FailedPacketWrite)
+{
+  shared_ptr<Data> data1 = makeDataWithContent("/A/1");
+  shared_ptr<Data> data3 = makeDataWithContent("/A/3", 500);
+  {
+    DiskStorage storage(dir);
+    storage.insert(*data1);
+    size_t segmentFileSize = storage.getSegmentFileSize();
+
+    // the packet is written partially
+    injectFailure(storage, 0);
+    BOOST_CHECK_THROW(storage.insert(*makeDataWithContent("/A/2")), DiskStorage::Error);
+    BOOST_CHECK(!storage.isFailed());
+    BOOST_CHECK_EQUAL(storage.size(), 1);
+    BOOST_CHECK(storage.find(Name("/A/2")) == nullptr);
+    BOOST_CHECK_EQUAL(storage.getSegmentFileSize(), segmentFileSize);
+    BOOST_CHECK_EQUAL(boost::filesystem::file_size(dir / "segments"), segmentFileSize);
+
+    storage.m_write = &::write;
+    storage.insert(*data3);
+    BOOST_REQUIRE(storage.find(Name("/A/3")) != nullptr);
+    BOOST_CHECK_EQUAL(*storage.find(Name("/A/3")), *data3);
+  }
+
+  DiskStorage storage(dir);
+  BOOST_CHECK_EQUAL(storage.size(), 2);
+  BOOST_REQUIRE(storage.find(Name("/A/1")) != nullptr);
+  BOOST_CHECK_EQUAL(*storage.find(Name("/A/1")), *data1);
+  BOOST_REQUIRE(storage.find(Name("/A/3")) != nullptr);
+  BOOST_CHECK_EQUAL(*storage.find(Name("/A/3")), *data3);
+}
+
+BOOST_AUTO_TEST_CASE(FailedIndexWrite)
+{
+  shared_ptr<Data> data1 = makeDataWithContent("/A/1");
+  shared_ptr<Data> data3 = makeDataWithContent("/A/3");
+  {
+    DiskStorage storage(dir);
+    storage.insert(*data1);
+    size_t segmentFileSize = storage.getSegmentFileSize();
+    size_t indexFileSize = boost::filesystem::file_size(dir / "index");
+
+    // the packet is written, and its index record is written partially
+    injectFailure(storage, 1);
+    BOOST_CHECK_THROW(storage.insert(*makeDataWithContent("/A/2")), DiskStorage::Error);
+    BOOST_CHECK(!storage.isFailed());
+    BOOST_CHECK_EQUAL(storage.size(), 1);
+    BOOST_CHECK_EQUAL(storage.getSegmentFileSize(), segmentFileSize);
+    BOOST_CHECK_EQUAL(boost::filesystem::file_size(dir / "segments"), segmentFileSize);
+    BOOST_CHECK_EQUAL(boost::filesystem::file_size(dir / "index"), indexFileSize);
+
+    // the erasure record is written partially
+    injectFailure(storage, 0);
+    BOOST_CHECK_THROW(storage.erase("/A/1"), DiskStorage::Error);
+    BOOST_CHECK_EQUAL(storage.size(), 1);
+    BOOST_CHECK_EQUAL(boost::filesystem::file_size(dir / "index"), indexFileSize);
+
+    storage.m_write = &::write;
+    storage.insert(*data3);
+  }
+
+  // a torn record would hide the records after it
+  DiskStorage storage(dir);
+  BOOST_CHECK_EQUAL(storage.size(), 2);
+  BOOST_CHECK(storage.find(Name("/A/1")) != nullptr);
+  BOOST_CHECK(storage.find(Name("/A/2")) == nullptr);
+  BOOST_REQUIRE(storage.find(Name("/A/3")) != nullptr);
+  BOOST_CHECK_EQUAL(*storage.find(Name("/A/3")), *data3);
+}
+
+BOOST_AUTO_TEST_CASE(FailedRollBack)
+{
+  shared_ptr<Data> data1 = makeDataWithContent("/A/1");
+  {
+    DiskStorage storage(dir);
+    storage.insert(*data1);
+
+    // the partially written packet cannot be discarded
+    injectFailure(storage, 0, true);
+    BOOST_CHECK_THROW(storage.insert(*makeDataWithContent("/A/2")), DiskStorage::Error);
+    BOOST_CHECK(storage.isFailed());
+
+    storage.m_write = &::write;
+    BOOST_CHECK_THROW(storage.insert(*makeDataWithContent("/A/3")), DiskStorage::Error);
+    BOOST_CHECK_THROW(storage.erase("/A"), DiskStorage::Error);
+    BOOST_CHECK_EQUAL(storage.size(), 1);
+    BOOST_REQUIRE(storage.find(Name("/A/1")) != nullptr);
+    BOOST_CHECK_EQUAL(*storage.find(Name("/A/1")), *data1);
+  }
+
+  // the index does not refer to the partial packet
+  DiskStorage storage(dir);
+  BOOST_CHECK_EQUAL(storage.size(), 1);
+  BOOST_REQUIRE(storage.find(Name("/A/1")) != nullptr);
+  BOOST_CHECK_EQUAL(*storage.find(Name("/A/1")), *data1);
+}
+
+BOOST_AUTO_TEST_CASE(Lock)
+{
+  {
+    DiskStorage storage(dir);
+    BOOST_CHECK_THROW(DiskStorage another(dir), DiskStorage::Error);
+  }
+
+  BOOST_CHECK_NO_THROW(DiskStorage another(dir));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "util/in-memory-storage-counters.hpp"
+#include "util/in-memory-storage-lru.hpp"
+#include "util/in-memory-storage-persistent.hpp"
+
+#include "boost-test.hpp"
+#include "../make-interest-data.hpp"
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(UtilInMemoryStorage)
+BOOST_AUTO_TEST_SUITE(Counters)
+
+BOOST_AUTO_TEST_CASE(Operations)
+{
+  InMemoryStorageLru ims(3);
+  const InMemoryStorageCounters& counters = ims.getCounters();
+
+  ims.insert(*makeData("/1"));
+  ims.insert(*makeData("/2"));
+  ims.insert(*makeData("/2"));
+  ims.insert(*makeData("/3"));
+  ims.insert(*makeData("/4"));
+  BOOST_CHECK_EQUAL(counters.getNInserts(), 4);
+  BOOST_CHECK_EQUAL(counters.getNDuplicateInserts(), 1);
+  BOOST_CHECK_EQUAL(counters.getNEvictions(InMemoryStorageCounters::EVICTION_LIMIT), 1);
+
+  BOOST_CHECK(ims.find(*makeInterest("/2")) != nullptr);
+  BOOST_CHECK(ims.find(*makeInterest("/3")) != nullptr);
+  BOOST_CHECK(ims.find(*makeInterest("/1")) == nullptr);
+  BOOST_CHECK_EQUAL(counters.getNHits(), 2);
+  BOOST_CHECK_EQUAL(counters.getNMisses(), 1);
+
+  ims.setByteLimit(ims.getNBytes() - 1);
+  BOOST_CHECK_EQUAL(counters.getNEvictions(InMemoryStorageCounters::EVICTION_BYTE_LIMIT), 1);
+  ims.setByteLimit(std::numeric_limits<size_t>::max());
+
+  ims.setCapacity(1);
+  BOOST_CHECK_EQUAL(counters.getNEvictions(InMemoryStorageCounters::EVICTION_CAPACITY), 1);
+  BOOST_CHECK_EQUAL(counters.getNResizes(), 1);
+
+  ims.erase("/");
+  BOOST_CHECK_EQUAL(counters.getNErased(), 1);
+
+  ims.insert(*makeData("/5"));
+  ims.eraseExpired(time::seconds(-1));
+  BOOST_CHECK_EQUAL(counters.getNEvictions(InMemoryStorageCounters::EVICTION_EXPIRED), 1);
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(LatencyHistogram)
+{
+  InMemoryStoragePersistent ims;
+  ims.insert(*makeData("/A"));
+
+  ims.find(*makeInterest("/A"));
+  for (size_t i = 0; i < InMemoryStorageCounters::N_LATENCY_BUCKETS; ++i) {
+    BOOST_CHECK_EQUAL(ims.getCounters().getNLookups(i), 0);
+  }
+
+  ims.enableLatencyHistogram();
+  ims.find(*makeInterest("/A"));
+  ims.find(*makeInterest("/B"));
+  uint64_t nLookups = 0;
+  for (size_t i = 0; i < InMemoryStorageCounters::N_LATENCY_BUCKETS; ++i) {
+    nLookups += ims.getCounters().getNLookups(i);
+  }
+  BOOST_CHECK_EQUAL(nLookups, 2);
+}
+
+BOOST_AUTO_TEST_CASE(Buckets)
+{
+  InMemoryStorageCounters counters;
+  counters.lookedUp(time::nanoseconds(0));
+  counters.lookedUp(time::nanoseconds(1));
+  counters.lookedUp(time::nanoseconds(2));
+  counters.lookedUp(time::nanoseconds(3));
+  counters.lookedUp(time::nanoseconds(1000));
+  counters.lookedUp(time::hours(24));
+
+  BOOST_CHECK_EQUAL(counters.getNLookups(0), 2);
+  BOOST_CHECK_EQUAL(counters.getNLookups(1), 2);
+  BOOST_CHECK_EQUAL(counters.getNLookups(9), 1);
+  BOOST_CHECK_EQUAL(counters.getNLookups(InMemoryStorageCounters::N_LATENCY_BUCKETS - 1), 1);
+}
+
+BOOST_AUTO_TEST_CASE(EncodeDecode)
+{
+  InMemoryStorageCounters counters1;
+  counters1.hit();
+  counters1.hit();
+  counters1.miss();
+  counters1.inserted();
+  counters1.duplicateInserted();
+  counters1.evicted(InMemoryStorageCounters::EVICTION_BYTE_LIMIT);
+  counters1.erased();
+  counters1.resized();
+
+  Block wire = counters1.wireEncode();
+  BOOST_CHECK_EQUAL(wire.type(), tlv::Content);
+  wire.parse();
+  BOOST_CHECK(wire.find(tlv::ims::LookupLatencyHistogram) == wire.elements_end());
+
+  InMemoryStorageCounters counters2(wire);
+  BOOST_CHECK_EQUAL(counters2.getNHits(), 2);
+  BOOST_CHECK_EQUAL(counters2.getNMisses(), 1);
+  BOOST_CHECK_EQUAL(counters2.getNInserts(), 1);
+  BOOST_CHECK_EQUAL(counters2.getNDuplicateInserts(), 1);
+  BOOST_CHECK_EQUAL(counters2.getNEvictions(InMemoryStorageCounters::EVICTION_LIMIT), 0);
+  BOOST_CHECK_EQUAL(counters2.getNEvictions(InMemoryStorageCounters::EVICTION_BYTE_LIMIT), 1);
+  BOOST_CHECK_EQUAL(counters2.getNErased(), 1);
+  BOOST_CHECK_EQUAL(counters2.getNResizes(), 1);
+
+  counters1.lookedUp(time::nanoseconds(5));
+  counters2.wireDecode(counters1.wireEncode());
+  BOOST_CHECK_EQUAL(counters2.getNLookups(2), 1);
+
+  BOOST_CHECK_THROW(counters2.wireDecode(Block(tlv::Content)), InMemoryStorageCounters::Error);
+  BOOST_CHECK_THROW(counters2.wireDecode(Block(tlv::Data)), InMemoryStorageCounters::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // Counters
+BOOST_AUTO_TEST_SUITE_END() // UtilInMemoryStorage
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,225 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "util/in-memory-storage-sharded.hpp"
+#include "util/in-memory-storage-lru.hpp"
+#include "util/in-memory-storage-persistent.hpp"
+
+#include "boost-test.hpp"
+#include "../make-interest-data.hpp"
+
+#include <thread>
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(UtilInMemoryStorage)
+BOOST_AUTO_TEST_SUITE(Sharded)
+
+static unique_ptr<InMemoryStorage>
+makeLruShard(size_t limit)
+{
+  return unique_ptr<InMemoryStorage>(new InMemoryStorageLru(limit));
+}
+
+static unique_ptr<InMemoryStorage>
+makePersistentShard(size_t)
+{
+  return unique_ptr<InMemoryStorage>(new InMemoryStoragePersistent);
+}
+
+BOOST_AUTO_TEST_CASE(InsertFindErase)
+{
+  InMemoryStorageSharded ims(&makePersistentShard, 8, 2);
+  BOOST_CHECK_EQUAL(ims.getNShards(), 8);
+
+  shared_ptr<Data> data = makeData("/A");
+  ims.insert(*data);
+  for (int i = 0; i < 20; ++i) {
+    ims.insert(*makeData(Name("/A").appendNumber(i).append("x")));
+  }
+  BOOST_CHECK_EQUAL(ims.size(), 21);
+
+  BOOST_CHECK_EQUAL(ims.find(*makeInterest(data->getFullName())), data);
+  BOOST_CHECK_EQUAL(ims.find(data->getFullName()), data);
+  BOOST_REQUIRE(ims.find(*makeInterest(Name("/A").appendNumber(7))) != nullptr);
+  BOOST_CHECK_EQUAL(ims.find(*makeInterest(Name("/A").appendNumber(7)))->getName(),
+                    Name("/A").appendNumber(7).append("x"));
+  BOOST_CHECK(ims.find(*makeInterest("/B")) == nullptr);
+
+  ims.erase(data->getFullName(), false);
+  BOOST_CHECK_EQUAL(ims.size(), 20);
+  BOOST_CHECK(ims.find(data->getFullName()) == nullptr);
+
+  ims.erase(Name("/A").appendNumber(7));
+  BOOST_CHECK_EQUAL(ims.size(), 19);
+  BOOST_CHECK(ims.find(*makeInterest(Name("/A").appendNumber(7))) == nullptr);
+
+  ims.erase("/A");
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ChildSelectorAcrossShards)
+{
+  InMemoryStorageSharded ims(&makePersistentShard, 8, 3);
+  for (int child = 0; child < 16; ++child) {
+    for (int i = 1; i <= 2; ++i) {
+      ims.insert(*makeData(Name("/B").appendNumber(child).appendNumber(i)));
+    }
+  }
+  ims.insert(*makeData("/C"));
+
+  shared_ptr<Interest> interest = makeInterest("/B");
+  interest->setChildSelector(0);
+  BOOST_REQUIRE(ims.find(*interest) != nullptr);
+  BOOST_CHECK_EQUAL(ims.find(*interest)->getName(), Name("/B").appendNumber(0).appendNumber(1));
+
+  interest->setChildSelector(1);
+  BOOST_REQUIRE(ims.find(*interest) != nullptr);
+  BOOST_CHECK_EQUAL(ims.find(*interest)->getName(), Name("/B").appendNumber(15).appendNumber(1));
+
+  BOOST_REQUIRE(ims.find(Name("/C")) != nullptr);
+  BOOST_CHECK_EQUAL(ims.find(Name("/C"))->getName(), Name("/C"));
+}
+
+BOOST_AUTO_TEST_CASE(Limit)
+{
+  InMemoryStorageSharded ims(&makeLruShard, 4, 1, 8);
+  BOOST_CHECK_EQUAL(ims.getLimit(), 8);
+
+  for (int i = 0; i < 100; ++i) {
+    ims.insert(*makeData(Name("/L").appendNumber(i)));
+  }
+  // all Data share the shard of /L
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+  BOOST_CHECK(ims.find(Name("/L").appendNumber(99)) != nullptr);
+  BOOST_CHECK(ims.find(Name("/L").appendNumber(0)) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(LimitRemainder)
+{
+  InMemoryStorageSharded ims(&makeLruShard, 4, 1, 10);
+  BOOST_CHECK_EQUAL(ims.getLimit(), 10);
+
+  // Data under many prefixes fill every shard up to its limit
+  for (int i = 0; i < 1000; ++i) {
+    ims.insert(*makeData(Name().appendNumber(i)));
+  }
+  BOOST_CHECK_EQUAL(ims.size(), 10);
+}
+
+static uint64_t
+getNHits(const InMemoryStorageSharded& ims)
+{
+  uint64_t nHits = 0;
+  for (size_t i = 0; i < ims.getNShards(); ++i) {
+    nHits += ims.getShardCounters(i).getNHits();
+  }
+  return nHits;
+}
+
+static uint64_t
+getNMisses(const InMemoryStorageSharded& ims)
+{
+  uint64_t nMisses = 0;
+  for (size_t i = 0; i < ims.getNShards(); ++i) {
+    nMisses += ims.getShardCounters(i).getNMisses();
+  }
+  return nMisses;
+}
+
+BOOST_AUTO_TEST_CASE(CountersAcrossShards)
+{
+  InMemoryStorageSharded ims(&makePersistentShard, 8, 3);
+  for (int child = 0; child < 16; ++child) {
+    ims.insert(*makeData(Name("/B").appendNumber(child).appendNumber(1)));
+  }
+
+  // lookups in a single shard
+  BOOST_CHECK(ims.find(*makeInterest(Name("/B").appendNumber(3).appendNumber(1))) != nullptr);
+  BOOST_CHECK(ims.find(*makeInterest(Name("/B").appendNumber(3).appendNumber(2))) == nullptr);
+  BOOST_CHECK_EQUAL(getNHits(ims), 1);
+  BOOST_CHECK_EQUAL(getNMisses(ims), 1);
+
+  // lookups across shards count once each
+  BOOST_CHECK(ims.find(*makeInterest("/B")) != nullptr);
+  BOOST_CHECK_EQUAL(getNHits(ims), 2);
+
+  std::vector<uint64_t> nMisses, nInserts;
+  for (size_t i = 0; i < ims.getNShards(); ++i) {
+    nMisses.push_back(ims.getShardCounters(i).getNMisses());
+    nInserts.push_back(ims.getShardCounters(i).getNInserts());
+  }
+  BOOST_CHECK(ims.find(*makeInterest("/C")) == nullptr);
+  BOOST_CHECK_EQUAL(getNMisses(ims), 2);
+
+  // the miss is counted in the shard where Data named as the Interest would be stored
+  ims.insert(*makeData("/C"));
+  for (size_t i = 0; i < ims.getNShards(); ++i) {
+    BOOST_CHECK_EQUAL(ims.getShardCounters(i).getNMisses() - nMisses[i],
+                      ims.getShardCounters(i).getNInserts() - nInserts[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentInsertFind)
+{
+  const int N_THREADS = 4;
+  const int N_DATA = 500;
+
+  InMemoryStorageSharded ims(&makeLruShard, 16, 2);
+
+  std::vector<shared_ptr<Data>> datas;
+  for (int t = 0; t < N_THREADS; ++t) {
+    for (int i = 0; i < N_DATA; ++i) {
+      datas.push_back(makeData(Name("/T").appendNumber(t).appendNumber(i)));
+    }
+  }
+
+  std::vector<int> nFound(N_THREADS, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < N_THREADS; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < N_DATA; ++i) {
+        const Data& data = *datas[t * N_DATA + i];
+        ims.insert(data);
+        if (ims.find(Interest(data.getName())) != nullptr) {
+          ++nFound[t];
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  BOOST_CHECK_EQUAL(ims.size(), N_THREADS * N_DATA);
+  for (int t = 0; t < N_THREADS; ++t) {
+    BOOST_CHECK_EQUAL(nFound[t], N_DATA);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END() // Sharded
+BOOST_AUTO_TEST_SUITE_END() // UtilInMemoryStorage
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "util/in-memory-storage-slru.hpp"
+#include "security/key-chain.hpp"
+
+#include "boost-test.hpp"
+#include "../make-interest-data.hpp"
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(UtilInMemoryStorage)
+BOOST_AUTO_TEST_SUITE(Slru)
+
+BOOST_AUTO_TEST_CASE(ProbationFirst)
+{
+  InMemoryStorageSlru ims;
+
+  Name name1("/insert/1");
+  ims.insert(*makeData(name1));
+  Name name2("/insert/2");
+  ims.insert(*makeData(name2));
+  Name name3("/insert/3");
+  ims.insert(*makeData(name3));
+
+  shared_ptr<Interest> interest1 = makeInterest(name1);
+  shared_ptr<Interest> interest2 = makeInterest(name2);
+  shared_ptr<Interest> interest3 = makeInterest(name3);
+
+  // /insert/1 is protected, while /insert/2 and /insert/3 are probationary
+  ims.find(*interest1);
+
+  ims.evictItem();
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+  BOOST_CHECK(!static_cast<bool>(ims.find(*interest2)));
+
+  ims.evictItem();
+  BOOST_CHECK_EQUAL(ims.size(), 1);
+  BOOST_CHECK(!static_cast<bool>(ims.find(*interest3)));
+
+  ims.evictItem();
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ScanResistance)
+{
+  InMemoryStorageSlru ims(4);
+
+  Name name1("/popular/1");
+  ims.insert(*makeData(name1));
+  Name name2("/popular/2");
+  ims.insert(*makeData(name2));
+  ims.find(*makeInterest(name1));
+  ims.find(*makeInterest(name2));
+
+  for (int i = 0; i < 20; i++) {
+    std::ostringstream convert;
+    convert << i;
+    ims.insert(*makeData("/scan/" + convert.str()));
+  }
+
+  BOOST_CHECK_EQUAL(ims.size(), 4);
+  BOOST_CHECK(static_cast<bool>(ims.find(*makeInterest(name1))));
+  BOOST_CHECK(static_cast<bool>(ims.find(*makeInterest(name2))));
+  BOOST_CHECK(static_cast<bool>(ims.find(*makeInterest("/scan/19"))));
+}
+
+BOOST_AUTO_TEST_CASE(Demotion)
+{
+  InMemoryStorageSlru ims(4);
+
+  std::vector<Name> names;
+  for (int i = 0; i < 4; i++) {
+    std::ostringstream convert;
+    convert << i;
+    names.push_back(Name("/insert/" + convert.str()));
+    ims.insert(*makeData(names.back()));
+  }
+
+  // protected segment holds at most 3 of 4 packets, /insert/0 is demoted upon access to /insert/3
+  for (const Name& name : names) {
+    ims.find(*makeInterest(name));
+  }
+
+  ims.evictItem();
+  BOOST_CHECK_EQUAL(ims.size(), 3);
+  BOOST_CHECK(!static_cast<bool>(ims.find(*makeInterest(names[0]))));
+}
+
+BOOST_AUTO_TEST_SUITE_END() // Slru
+BOOST_AUTO_TEST_SUITE_END() // UtilInMemoryStorage
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
@@ -85,6 +85,74 @@ BOOST_AUTO_TEST_CASE(SelfCancel)
   BOOST_REQUIRE_NO_THROW(advanceClocks(time::milliseconds(100), 10));
 }
 
+BOOST_AUTO_TEST_CASE(SameTimeOrder)
+{
+  Scheduler scheduler(io);
+
+  std::vector<int> fired;
+  std::vector<EventId> eventIds;
+  for (int i = 0; i < 20; ++i) {
+    eventIds.push_back(scheduler.scheduleEvent(time::milliseconds(100), [&fired, i] {
+        fired.push_back(i);
+      }));
+  }
+  scheduler.scheduleEvent(time::milliseconds(50), [&fired] { fired.push_back(-1); });
+  scheduler.cancelEvent(eventIds[0]);
+  scheduler.cancelEvent(eventIds[7]);
+
+  advanceClocks(time::milliseconds(10), 20);
+
+  std::vector<int> expected{-1};
+  for (int i = 1; i < 20; ++i) {
+    if (i != 7) {
+      expected.push_back(i);
+    }
+  }
+  BOOST_CHECK_EQUAL_COLLECTIONS(fired.begin(), fired.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(CancelMany)
+{
+  Scheduler scheduler(io);
+
+  std::vector<int> fired;
+  std::vector<int> expected;
+  std::vector<EventId> eventIds;
+  for (int i = 0; i < 1000; ++i) {
+    // delays are a permutation of 0..999 ms
+    int delay = (i * 7919) % 1000;
+    if (i % 3 == 0) {
+      expected.push_back(delay);
+    }
+    eventIds.push_back(scheduler.scheduleEvent(time::milliseconds(delay), [&fired, delay] {
+        fired.push_back(delay);
+      }));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 3 != 0) {
+      scheduler.cancelEvent(eventIds[i]);
+    }
+  }
+  // cancelling again has no effect
+  scheduler.cancelEvent(eventIds[1]);
+
+  advanceClocks(time::milliseconds(1), 1000);
+
+  std::sort(expected.begin(), expected.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(fired.begin(), fired.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(EventIdOutlivesScheduler)
+{
+  EventId eventId;
+  {
+    Scheduler scheduler(io);
+    eventId = scheduler.scheduleEvent(time::seconds(1), [] {});
+  }
+  BOOST_CHECK(eventId != nullptr);
+  eventId.reset();
+}
+
 class SelfRescheduleFixture : public UnitTestTimeFixture
 {
 public:
@@ -26,12 +26,73 @@
 #include "security/key-chain.hpp"
 #include "../unit-test-time-fixture.hpp"
 
+#include <boost/lexical_cast.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
 namespace ndn {
 namespace util {
 namespace tests {
 
 BOOST_AUTO_TEST_SUITE(UtilSegmentFetcher)
 
+/** \brief verifies segments on the calling thread after being released
+ *
+ *  Segment 0 and the invalid segment are verified at once, and other segments wait for release().
+ *  The invalid segment is rejected, or causes an exception if isThrowing is set.
+ */
+class ThreadedVerifier
+{
+public:
+  struct State
+  {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool isReleased = false;
+    uint64_t invalidSegment = std::numeric_limits<uint64_t>::max();
+    bool isThrowing = false;
+    std::set<std::thread::id> threads;
+  };
+
+  ThreadedVerifier()
+    : state(make_shared<State>())
+  {
+  }
+
+  bool
+  operator()(const Data& data) const
+  {
+    uint64_t segment = data.getName().get(-1).toSegment();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->threads.insert(std::this_thread::get_id());
+    if (segment == state->invalidSegment) {
+      if (state->isThrowing) {
+        BOOST_THROW_EXCEPTION(std::runtime_error("verifier failure"));
+      }
+      return false;
+    }
+    if (segment > 0) {
+      state->cv.wait(lock, [this] { return state->isReleased; });
+    }
+    return true;
+  }
+
+  void
+  release()
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->isReleased = true;
+    state->cv.notify_all();
+  }
+
+public:
+  shared_ptr<State> state;
+};
+
 class Fixture : public ndn::tests::UnitTestTimeFixture
 {
 public:
@@ -58,6 +119,53 @@ public:
     return data;
   }
 
+  shared_ptr<Data>
+  makeSegment(const Name& baseName, uint64_t segment, bool isFinal)
+  {
+    std::string content = boost::lexical_cast<std::string>(segment);
+
+    shared_ptr<Data> data = make_shared<Data>(Name(baseName).appendSegment(segment));
+    data->setContent(reinterpret_cast<const uint8_t*>(content.data()), content.size());
+
+    if (isFinal)
+      data->setFinalBlockId(data->getName()[-1]);
+    keyChain.sign(*data);
+
+    return data;
+  }
+
+  size_t
+  countInterests(const Name& name) const
+  {
+    return std::count_if(face->sentInterests.begin(), face->sentInterests.end(),
+                         [&name] (const Interest& interest) { return interest.getName() == name; });
+  }
+
+  /** \brief processes events of the Face until \p predicate holds, for at most a few seconds
+   */
+  void
+  pollUntil(const function<bool()>& predicate)
+  {
+    for (int i = 0; i < 5000 && !predicate(); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      io.poll();
+      io.reset();
+    }
+  }
+
+  void
+  onSegment(uint64_t offset, const Block& content)
+  {
+    segments.push_back(std::make_pair(offset, std::string(content.value_begin(),
+                                                          content.value_end())));
+  }
+
+  void
+  onStreamComplete()
+  {
+    ++nDatas;
+  }
+
   void
   onError(uint32_t errorCode)
   {
@@ -70,6 +178,7 @@ public:
   {
     ++nDatas;
     dataSize = data->size();
+    lastData = data;
   }
 
 
@@ -81,6 +190,8 @@ public:
   uint32_t lastError;
   uint32_t nDatas;
   size_t dataSize;
+  ConstBufferPtr lastData;
+  std::vector<std::pair<uint64_t, std::string>> segments;
 };
 
 BOOST_FIXTURE_TEST_CASE(Timeout, Fixture)
@@ -290,7 +401,298 @@ BOOST_FIXTURE_TEST_CASE(TripleWithInitialSegmentFetching, Fixture)
     BOOST_CHECK_EQUAL(interest.getChildSelector(), 0);
   }
 }
+BOOST_FIXTURE_TEST_CASE(PipelinedOutOfOrder, Fixture)
+{
+  SegmentFetcher::fetch(*face, Interest("/hello/world", time::seconds(1)),
+                        DontVerifySegment(),
+                        bind(&Fixture::onData, this, _1),
+                        bind(&Fixture::onError, this, _1),
+                        SegmentFetcher::Options());
+
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 1);
+  face->receive(*makeSegment("/hello/world/version0", 0, false));
+
+  // slow start: window grows by one segment per received segment
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 3);
+  BOOST_CHECK_EQUAL(face->sentInterests[1].getName(), "/hello/world/version0/%00%01");
+  BOOST_CHECK_EQUAL(face->sentInterests[1].getMustBeFresh(), false);
+  BOOST_CHECK_EQUAL(face->sentInterests[1].getChildSelector(), 0);
+  BOOST_CHECK_EQUAL(face->sentInterests[2].getName(), "/hello/world/version0/%00%02");
+
+  face->receive(*makeSegment("/hello/world/version0", 2, false));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 5);
+
+  face->receive(*makeSegment("/hello/world/version0", 3, true));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK_EQUAL(nDatas, 0);
 
+  // Interest for segment 4 is cancelled, and segment 1 completes the content
+  face->receive(*makeSegment("/hello/world/version0", 1, false));
+  advanceClocks(time::milliseconds(1), 10);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_REQUIRE_EQUAL(nDatas, 1);
+  BOOST_CHECK_EQUAL(std::string(lastData->begin(), lastData->end()), "0123");
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 5);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(PipelinedRetransmission, Fixture)
+{
+  SegmentFetcher::fetch(*face, Interest("/hello/world", time::seconds(4)),
+                        DontVerifySegment(),
+                        bind(&Fixture::onData, this, _1),
+                        bind(&Fixture::onError, this, _1),
+                        SegmentFetcher::Options());
+
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(*makeSegment("/hello/world/version0", 0, false));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 3);
+
+  face->receive(*makeSegment("/hello/world/version0", 1, false));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK_EQUAL(countInterests("/hello/world/version0/%00%02"), 1);
+
+  // RTO is at least 200ms
+  advanceClocks(time::milliseconds(10), 25);
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_REQUIRE_EQUAL(countInterests("/hello/world/version0/%00%02"), 2);
+
+  std::vector<uint32_t> nonces;
+  for (const Interest& interest : face->sentInterests) {
+    if (interest.getName() == "/hello/world/version0/%00%02") {
+      nonces.push_back(interest.getNonce());
+    }
+  }
+  BOOST_CHECK_NE(nonces[0], nonces[1]);
+
+  // retransmissions wait for room in the window
+  face->receive(*makeSegment("/hello/world/version0", 2, false));
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(*makeSegment("/hello/world/version0", 3, false));
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(*makeSegment("/hello/world/version0", 4, true));
+  advanceClocks(time::milliseconds(1), 10);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_REQUIRE_EQUAL(nDatas, 1);
+  BOOST_CHECK_EQUAL(std::string(lastData->begin(), lastData->end()), "01234");
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(PipelinedRetriesExhausted, Fixture)
+{
+  SegmentFetcher::Options options;
+  options.maxRetries = 2;
+  SegmentFetcher::fetch(*face, Interest("/hello/world", time::seconds(1)),
+                        DontVerifySegment(),
+                        bind(&Fixture::onData, this, _1),
+                        bind(&Fixture::onError, this, _1),
+                        options);
+
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(*makeSegment("/hello/world/version0", 0, false));
+
+  // RTO expires twice, then the last Interest times out
+  advanceClocks(time::milliseconds(10), 250);
+
+  BOOST_CHECK_EQUAL(nErrors, 1);
+  BOOST_CHECK_EQUAL(lastError, static_cast<uint32_t>(SegmentFetcher::INTEREST_TIMEOUT));
+  BOOST_CHECK_EQUAL(nDatas, 0);
+  BOOST_CHECK_EQUAL(countInterests("/hello/world/version0/%00%01"), 3);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(Stream, Fixture)
+{
+  SegmentFetcher::fetchStream(*face, Interest("/hello/world", time::seconds(1)),
+                              DontVerifySegment(),
+                              bind(&Fixture::onSegment, this, _1, _2),
+                              bind(&Fixture::onStreamComplete, this),
+                              bind(&Fixture::onError, this, _1));
+
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(*makeSegment("/hello/world/version0", 0, false));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(segments.size(), 1);
+
+  face->receive(*makeSegment("/hello/world/version0", 2, false));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK_EQUAL(segments.size(), 1);
+
+  face->receive(*makeSegment("/hello/world/version0", 1, false));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK_EQUAL(segments.size(), 3);
+  BOOST_CHECK_EQUAL(nDatas, 0);
+
+  for (uint64_t segment = 3; segment <= 10; ++segment) {
+    face->receive(*makeSegment("/hello/world/version0", segment, segment == 10));
+    advanceClocks(time::milliseconds(1), 10);
+  }
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nDatas, 1);
+  BOOST_REQUIRE_EQUAL(segments.size(), 11);
+  uint64_t offset = 0;
+  for (uint64_t segment = 0; segment <= 10; ++segment) {
+    BOOST_CHECK_EQUAL(segments[segment].first, offset);
+    BOOST_CHECK_EQUAL(segments[segment].second, boost::lexical_cast<std::string>(segment));
+    offset += segments[segment].second.size();
+  }
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(StreamReorderLimit, Fixture)
+{
+  SegmentFetcher::Options options;
+  options.initCwnd = 4.0;
+  options.maxCwnd = 4.0;
+  SegmentFetcher::fetchStream(*face, Interest("/hello/world", time::seconds(10)),
+                              DontVerifySegment(),
+                              bind(&Fixture::onSegment, this, _1, _2),
+                              bind(&Fixture::onStreamComplete, this),
+                              bind(&Fixture::onError, this, _1),
+                              options);
+
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(*makeSegment("/hello/world/version0", 0, false));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 5);
+
+  // segment 1 is missing: segments 2-4 are held, and segment 5 is not requested
+  for (uint64_t segment = 2; segment <= 4; ++segment) {
+    face->receive(*makeSegment("/hello/world/version0", segment, false));
+    advanceClocks(time::milliseconds(1), 10);
+  }
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 5);
+  BOOST_CHECK_EQUAL(segments.size(), 1);
+
+  face->receive(*makeSegment("/hello/world/version0", 1, false));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK_EQUAL(segments.size(), 5);
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 9);
+  BOOST_CHECK_EQUAL(face->sentInterests.back().getName(), "/hello/world/version0/%00%08");
+}
+
+BOOST_FIXTURE_TEST_CASE(ParallelVerification, Fixture)
+{
+  ThreadedVerifier verifier;
+  SegmentFetcher::Options options;
+  options.initCwnd = 4.0;
+  options.maxCwnd = 8.0;
+  options.nVerifyThreads = 4;
+  SegmentFetcher::fetchStream(*face, Interest("/hello/world", time::seconds(10)),
+                              verifier,
+                              bind(&Fixture::onSegment, this, _1, _2),
+                              bind(&Fixture::onStreamComplete, this),
+                              bind(&Fixture::onError, this, _1),
+                              options);
+
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(*makeSegment("/hello/world/version0", 0, false));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(segments.size(), 1);
+
+  // Interests are expressed while segments are being verified
+  for (uint64_t segment = 1; segment <= 6; ++segment) {
+    face->receive(*makeSegment("/hello/world/version0", segment, false));
+    advanceClocks(time::milliseconds(1), 10);
+  }
+  BOOST_CHECK_EQUAL(segments.size(), 1);
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 9);
+  BOOST_CHECK_EQUAL(face->sentInterests.back().getName(), "/hello/world/version0/%00%08");
+
+  verifier.release();
+  face->receive(*makeSegment("/hello/world/version0", 7, false));
+  face->receive(*makeSegment("/hello/world/version0", 8, true));
+  pollUntil([this] { return nDatas > 0; });
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nDatas, 1);
+  BOOST_REQUIRE_EQUAL(segments.size(), 9);
+  for (uint64_t segment = 0; segment <= 8; ++segment) {
+    BOOST_CHECK_EQUAL(segments[segment].first, segment);
+    BOOST_CHECK_EQUAL(segments[segment].second, boost::lexical_cast<std::string>(segment));
+  }
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+
+  // the first segment is verified on the Face's thread, and the others are not
+  BOOST_CHECK(verifier.state->threads.count(std::this_thread::get_id()) > 0);
+  BOOST_CHECK_GT(verifier.state->threads.size(), 1);
+
+  // SegmentFetcher is released after the last verification result is processed
+  pollUntil([&verifier] { return verifier.state.use_count() == 1; });
+  BOOST_CHECK_EQUAL(verifier.state.use_count(), 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(ParallelVerificationFail, Fixture)
+{
+  ThreadedVerifier verifier;
+  verifier.state->invalidSegment = 2;
+  verifier.release();
+  SegmentFetcher::Options options;
+  options.initCwnd = 4.0;
+  options.nVerifyThreads = 2;
+  SegmentFetcher::fetchStream(*face, Interest("/hello/world", time::seconds(10)),
+                              verifier,
+                              bind(&Fixture::onSegment, this, _1, _2),
+                              bind(&Fixture::onStreamComplete, this),
+                              bind(&Fixture::onError, this, _1),
+                              options);
+
+  advanceClocks(time::milliseconds(1), 10);
+  for (uint64_t segment = 0; segment <= 4; ++segment) {
+    face->receive(*makeSegment("/hello/world/version0", segment, segment == 4));
+    advanceClocks(time::milliseconds(1), 10);
+  }
+  pollUntil([this] { return nErrors > 0; });
+
+  BOOST_CHECK_EQUAL(nErrors, 1);
+  BOOST_CHECK_EQUAL(lastError, static_cast<uint32_t>(SegmentFetcher::SEGMENT_VERIFICATION_FAIL));
+  BOOST_CHECK_EQUAL(nDatas, 0);
+  BOOST_CHECK_LE(segments.size(), 2);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+
+  pollUntil([&verifier] { return verifier.state.use_count() == 1; });
+  BOOST_CHECK_EQUAL(verifier.state.use_count(), 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(ParallelVerificationThrow, Fixture)
+{
+  ThreadedVerifier verifier;
+  verifier.state->invalidSegment = 2;
+  verifier.state->isThrowing = true;
+  verifier.release();
+  SegmentFetcher::Options options;
+  options.initCwnd = 4.0;
+  options.nVerifyThreads = 2;
+  SegmentFetcher::fetchStream(*face, Interest("/hello/world", time::seconds(10)),
+                              verifier,
+                              bind(&Fixture::onSegment, this, _1, _2),
+                              bind(&Fixture::onStreamComplete, this),
+                              bind(&Fixture::onError, this, _1),
+                              options);
+
+  advanceClocks(time::milliseconds(1), 10);
+  for (uint64_t segment = 0; segment <= 4; ++segment) {
+    face->receive(*makeSegment("/hello/world/version0", segment, segment == 4));
+    advanceClocks(time::milliseconds(1), 10);
+  }
+  pollUntil([this] { return nErrors > 0; });
+
+  BOOST_CHECK_EQUAL(nErrors, 1);
+  BOOST_CHECK_EQUAL(lastError, static_cast<uint32_t>(SegmentFetcher::SEGMENT_VERIFICATION_FAIL));
+  BOOST_CHECK_EQUAL(nDatas, 0);
+  BOOST_CHECK_LE(segments.size(), 2);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+
+  pollUntil([&verifier] { return verifier.state.use_count() == 1; });
+  BOOST_CHECK_EQUAL(verifier.state.use_count(), 1);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,212 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "util/segment-pipeline.hpp"
+
+#include "boost-test.hpp"
+#include "util/dummy-client-face.hpp"
+#include "security/key-chain.hpp"
+#include "../unit-test-time-fixture.hpp"
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(UtilSegmentPipeline)
+
+class Fixture : public ndn::tests::UnitTestTimeFixture
+{
+public:
+  Fixture()
+    : face(makeDummyClientFace(io))
+    , nTimeouts(0)
+    , lastTimeout(0)
+  {
+  }
+
+  void
+  start(const SegmentPipeline::Options& options)
+  {
+    Interest interest;
+    interest.setInterestLifetime(time::seconds(1));
+
+    pipeline = SegmentPipeline::create(*face, interest, "/hello/world", options,
+                                       bind(&Fixture::onData, this, _1, _2),
+                                       bind(&Fixture::onLoss, this, _1, _2),
+                                       bind(&Fixture::onTimeout, this, _1));
+    pipeline->start(0);
+    advanceClocks(time::milliseconds(1), 10);
+  }
+
+  void
+  receive(uint64_t segment)
+  {
+    shared_ptr<Data> data = make_shared<Data>(Name("/hello/world").appendSegment(segment));
+    keyChain.sign(*data);
+    face->receive(*data);
+    advanceClocks(time::milliseconds(1), 10);
+  }
+
+  size_t
+  countInterests(uint64_t segment) const
+  {
+    Name name = Name("/hello/world").appendSegment(segment);
+    return std::count_if(face->sentInterests.begin(), face->sentInterests.end(),
+                         [&name] (const Interest& interest) { return interest.getName() == name; });
+  }
+
+  void
+  onData(const SegmentPipeline::SegmentInfo& info, const Data& data)
+  {
+    BOOST_CHECK_EQUAL(data.getName().get(-1).toSegment(), info.segmentNo);
+    infos.push_back(info);
+  }
+
+  void
+  onLoss(uint64_t segmentNo, bool isInterestTimeout)
+  {
+    losses.push_back(std::make_pair(segmentNo, isInterestTimeout));
+  }
+
+  void
+  onTimeout(uint64_t segmentNo)
+  {
+    ++nTimeouts;
+    lastTimeout = segmentNo;
+  }
+
+public:
+  shared_ptr<DummyClientFace> face;
+  KeyChain keyChain;
+  shared_ptr<SegmentPipeline> pipeline;
+
+  std::vector<SegmentPipeline::SegmentInfo> infos;
+  std::vector<std::pair<uint64_t, bool>> losses;
+  uint32_t nTimeouts;
+  uint64_t lastTimeout;
+};
+
+BOOST_FIXTURE_TEST_CASE(WithoutVersionDiscovery, Fixture)
+{
+  start(SegmentPipeline::Options());
+  BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 1);
+  BOOST_CHECK_EQUAL(face->sentInterests[0].getName(), "/hello/world/%00%00");
+  BOOST_CHECK_EQUAL(face->sentInterests[0].getInterestLifetime(), time::seconds(1));
+
+  receive(0);
+  BOOST_REQUIRE_EQUAL(infos.size(), 1);
+  BOOST_CHECK_EQUAL(infos[0].segmentNo, 0);
+  BOOST_CHECK_EQUAL(infos[0].nRetries, 0);
+  // Data is received after the clock is advanced by 10ms in start()
+  BOOST_CHECK(infos[0].rtt >= time::milliseconds(10));
+  BOOST_CHECK(infos[0].rtt <= time::milliseconds(20));
+
+  // slow start: window grows by one segment per received segment
+  BOOST_CHECK_EQUAL(pipeline->getCwnd(), 2.0);
+  BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 3);
+  BOOST_CHECK_EQUAL(face->sentInterests[1].getName(), "/hello/world/%00%01");
+  BOOST_CHECK_EQUAL(face->sentInterests[2].getName(), "/hello/world/%00%02");
+
+  // the Interest for segment 2 is cancelled
+  pipeline->setFinalSegmentNo(1);
+  receive(1);
+  BOOST_CHECK_EQUAL(infos.size(), 2);
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 3);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+  BOOST_CHECK_EQUAL(pipeline->getNRetransmissions(), 0);
+  BOOST_CHECK_EQUAL(nTimeouts, 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(Retransmission, Fixture)
+{
+  start(SegmentPipeline::Options());
+  receive(0);
+  BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 3);
+
+  // RTO is at least 200ms, and the window is decreased once for both losses
+  advanceClocks(time::milliseconds(10), 25);
+  BOOST_REQUIRE_EQUAL(losses.size(), 2);
+  BOOST_CHECK_EQUAL(losses[0].first, 1);
+  BOOST_CHECK_EQUAL(losses[0].second, false);
+  BOOST_CHECK_EQUAL(losses[1].first, 2);
+  BOOST_CHECK_EQUAL(pipeline->getCwnd(), 2.0);
+  BOOST_CHECK(pipeline->getRto() == time::milliseconds(400));
+  BOOST_CHECK_EQUAL(countInterests(1), 2);
+  BOOST_CHECK_EQUAL(countInterests(2), 2);
+  BOOST_CHECK_EQUAL(pipeline->getNRetransmissions(), 2);
+
+  receive(1);
+  BOOST_REQUIRE_EQUAL(infos.size(), 2);
+  BOOST_CHECK_EQUAL(infos[1].segmentNo, 1);
+  BOOST_CHECK_EQUAL(infos[1].nRetries, 1);
+  BOOST_CHECK_EQUAL(nTimeouts, 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(RetriesExhausted, Fixture)
+{
+  SegmentPipeline::Options options;
+  options.maxRetries = 1;
+  start(options);
+
+  // RTO expires once, then the last Interest times out
+  advanceClocks(time::milliseconds(10), 250);
+
+  BOOST_REQUIRE_EQUAL(losses.size(), 1);
+  BOOST_CHECK_EQUAL(losses[0].first, 0);
+  BOOST_CHECK_EQUAL(nTimeouts, 1);
+  BOOST_CHECK_EQUAL(lastTimeout, 0);
+  BOOST_CHECK_EQUAL(countInterests(0), 2);
+  BOOST_CHECK_EQUAL(infos.size(), 0);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(DeliveryLimit, Fixture)
+{
+  SegmentPipeline::Options options;
+  options.initCwnd = 4.0;
+  options.maxCwnd = 4.0;
+  start(options);
+  BOOST_REQUIRE_EQUAL(face->sentInterests.size(), 4);
+
+  // segments 1 to 3 wait for segment 0
+  receive(1);
+  receive(2);
+  receive(3);
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 4);
+
+  receive(0);
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 4);
+
+  pipeline->setNextSegmentToDeliver(4);
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK_EQUAL(face->sentInterests.size(), 8);
+  BOOST_CHECK_EQUAL(countInterests(7), 1);
+
+  pipeline->stop();
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK_EQUAL(face->getNPendingInterests(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
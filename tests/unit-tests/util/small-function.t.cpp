@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2015 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "util/small-function.hpp"
+#include "util/scheduler.hpp"
+#include "face.hpp"
+
+#include "boost-test.hpp"
+
+#include <array>
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+static int
+addOne(int x)
+{
+  return x + 1;
+}
+
+BOOST_AUTO_TEST_SUITE(UtilSmallFunction)
+
+BOOST_AUTO_TEST_CASE(Empty)
+{
+  SmallFunction<int(int)> f;
+  BOOST_CHECK(!f);
+  BOOST_CHECK(f == nullptr);
+  BOOST_CHECK_THROW(f(1), std::bad_function_call);
+
+  int (*nullFunction)(int) = nullptr;
+  f = nullFunction;
+  BOOST_CHECK(!f);
+
+  f = function<int(int)>();
+  BOOST_CHECK(!f);
+
+  f = &addOne;
+  BOOST_CHECK(f != nullptr);
+  f = nullptr;
+  BOOST_CHECK(!f);
+}
+
+BOOST_AUTO_TEST_CASE(Invoke)
+{
+  SmallFunction<int(int)> f = &addOne;
+  BOOST_CHECK_EQUAL(f(1), 2);
+
+  f = [] (int x) { return x * 2; };
+  BOOST_CHECK_EQUAL(f(3), 6);
+
+  f = function<int(int)>(bind(&addOne, _1));
+  BOOST_CHECK_EQUAL(f(4), 5);
+
+  // a mutable target keeps its state across invocations
+  int count = 0;
+  SmallFunction<int()> g = [count] () mutable { return ++count; };
+  g();
+  BOOST_CHECK_EQUAL(g(), 2);
+
+  // SmallFunction can be converted back to std::function
+  function<int(int)> h = SmallFunction<int(int)>(&addOne);
+  BOOST_CHECK_EQUAL(h(5), 6);
+}
+
+BOOST_AUTO_TEST_CASE(CopyMove)
+{
+  auto counter = make_shared<int>(0);
+  SmallFunction<void()> f = [counter] { ++*counter; };
+  BOOST_CHECK_EQUAL(counter.use_count(), 2);
+
+  SmallFunction<void()> g = f;
+  BOOST_CHECK_EQUAL(counter.use_count(), 3);
+  g();
+  f();
+  BOOST_CHECK_EQUAL(*counter, 2);
+
+  SmallFunction<void()> h = std::move(g);
+  BOOST_CHECK(!g);
+  BOOST_CHECK_EQUAL(counter.use_count(), 3);
+  h();
+  BOOST_CHECK_EQUAL(*counter, 3);
+
+  swap(f, g);
+  BOOST_CHECK(!f);
+  BOOST_CHECK(static_cast<bool>(g));
+
+  g = nullptr;
+  h = nullptr;
+  BOOST_CHECK_EQUAL(counter.use_count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(LargeTarget)
+{
+  std::array<uint64_t, 32> array;
+  array.fill(1);
+  auto counter = make_shared<int>(0);
+
+  SmallFunction<uint64_t()> f = [array, counter] { return array[31] + (*counter)++; };
+  SmallFunction<uint64_t()> g = f;
+  BOOST_CHECK_EQUAL(counter.use_count(), 3);
+  BOOST_CHECK_EQUAL(f(), 1);
+  BOOST_CHECK_EQUAL(g(), 2);
+
+  SmallFunction<uint64_t()> h = std::move(f);
+  BOOST_CHECK(!f);
+  BOOST_CHECK_EQUAL(h(), 3);
+
+  g = nullptr;
+  h = nullptr;
+  BOOST_CHECK_EQUAL(counter.use_count(), 1);
+}
+
+class Consumer
+{
+public:
+  void
+  onData(const Interest&, Data&, const shared_ptr<Consumer>&)
+  {
+  }
+
+  void
+  onTimeout(const Interest&, const shared_ptr<Consumer>&)
+  {
+  }
+
+  void
+  onEvent(const shared_ptr<Consumer>&)
+  {
+  }
+};
+
+// the allocation counts are measured in tests/benchmarks/small-function-bench.cpp, which replaces
+// the global operator new; this checks that typical callbacks still fit the inline storage
+BOOST_AUTO_TEST_CASE(TypicalCallbacksInline)
+{
+  auto consumer = make_shared<Consumer>();
+
+  auto onData = bind(&Consumer::onData, consumer.get(), _1, _2, consumer);
+  auto onTimeout = bind(&Consumer::onTimeout, consumer.get(), _1, consumer);
+  auto onInterest = [consumer] (const InterestFilter&, const Interest&) {};
+  static_assert(OnData::isStoredInline<decltype(onData)>(),
+                "bind of a member function, object pointer, and shared_ptr must fit OnData");
+  static_assert(OnTimeout::isStoredInline<decltype(onTimeout)>(),
+                "bind of a member function, object pointer, and shared_ptr must fit OnTimeout");
+  static_assert(OnInterest::isStoredInline<decltype(onInterest)>(),
+                "lambda capturing a shared_ptr must fit OnInterest");
+
+  auto event = bind(&Consumer::onEvent, consumer.get(), consumer);
+  auto lambdaEvent = [consumer] { consumer->onEvent(consumer); };
+  static_assert(Scheduler::Event::isStoredInline<decltype(event)>(),
+                "bind of a member function, object pointer, and shared_ptr must fit an Event");
+  static_assert(Scheduler::Event::isStoredInline<decltype(lambdaEvent)>(),
+                "lambda capturing a shared_ptr must fit an Event");
+  static_assert(Scheduler::Event::isStoredInline<function<void()>>(),
+                "std::function must fit an Event");
+
+  // a target larger than the inline storage is detected
+  std::array<uint64_t, 32> array;
+  auto large = [array] { return array[0]; };
+  static_assert(!SmallFunction<uint64_t()>::isStoredInline<decltype(large)>(),
+                "a 256-byte target must not fit the inline storage");
+
+  OnData f = onData;
+  BOOST_CHECK(static_cast<bool>(f));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
@@ -23,10 +23,13 @@
 #include "util/in-memory-storage-fifo.hpp"
 #include "util/in-memory-storage-lfu.hpp"
 #include "util/in-memory-storage-lru.hpp"
+#include "util/in-memory-storage-clock.hpp"
+#include "util/in-memory-storage-slru.hpp"
 #include "security/key-chain.hpp"
 
 #include "boost-test.hpp"
 #include "../make-interest-data.hpp"
+#include "../unit-test-time-fixture.hpp"
 
 #include <boost/mpl/list.hpp>
 
@@ -38,7 +41,8 @@ BOOST_AUTO_TEST_SUITE(UtilInMemoryStorage)
 BOOST_AUTO_TEST_SUITE(Common)
 
 typedef boost::mpl::list<InMemoryStoragePersistent, InMemoryStorageFifo, InMemoryStorageLfu,
-                         InMemoryStorageLru> InMemoryStorages;
+                         InMemoryStorageLru, InMemoryStorageClock,
+                         InMemoryStorageSlru> InMemoryStorages;
 
 BOOST_AUTO_TEST_CASE_TEMPLATE(Insertion, T, InMemoryStorages)
 {
@@ -291,6 +295,51 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(DigestCalculation, T, InMemoryStorages)
                                 entry->getFullName()[-1].value_end());
 }
 
+static int
+sign(int x)
+{
+  return (x > 0) - (x < 0);
+}
+
+BOOST_AUTO_TEST_CASE(CompareFullName)
+{
+  std::vector<shared_ptr<Data>> datas;
+  for (const char* uri : {"/", "/a", "/a/b", "/a/b/c", "/b", "/a%00"}) {
+    datas.push_back(makeData(uri));
+  }
+  // same name as another packet, but different digest
+  shared_ptr<Data> withContent = make_shared<Data>("/a");
+  withContent->setContent(reinterpret_cast<const uint8_t*>("x"), 1);
+  datas.push_back(signData(withContent));
+  // name that ends with something which looks like the implicit digest of another packet
+  datas.push_back(makeData(Name("/a").append(datas[1]->getFullName().get(-1))));
+
+  std::vector<Name> names;
+  for (const shared_ptr<Data>& data : datas) {
+    names.push_back(data->getName());
+    names.push_back(data->getFullName());
+    names.push_back(Name(data->getFullName()).append("x"));
+  }
+
+  std::vector<shared_ptr<InMemoryStorageEntry>> entries;
+  for (const shared_ptr<Data>& data : datas) {
+    entries.push_back(make_shared<InMemoryStorageEntry>());
+    entries.back()->setData(*data);
+  }
+
+  for (const shared_ptr<InMemoryStorageEntry>& entry : entries) {
+    const Name& fullName = entry->getData().getFullName();
+    for (const shared_ptr<Data>& data : datas) {
+      BOOST_CHECK_EQUAL(sign(entry->compareFullName(*data)),
+                        sign(fullName.compare(data->getFullName())));
+    }
+    for (const Name& name : names) {
+      BOOST_CHECK_EQUAL(sign(entry->compareFullName(name)), sign(fullName.compare(name)));
+      BOOST_CHECK_EQUAL(entry->hasFullNamePrefix(name), name.isPrefixOf(fullName));
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE(Iterator, T, InMemoryStorages)
 {
   T ims;
@@ -629,8 +678,84 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(ExcludeSelector, T, InMemoryStorages)
   BOOST_CHECK_EQUAL(found3->getName(), "/c/a");
 }
 
-typedef boost::mpl::list<InMemoryStorageFifo, InMemoryStorageLfu, InMemoryStorageLru>
-                         InMemoryStoragesLimited;
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(MustBeFresh, T, InMemoryStorages, ndn::tests::UnitTestTimeFixture)
+{
+  T ims;
+
+  shared_ptr<Data> data1 = makeData("/A/1");
+  data1->setFreshnessPeriod(time::seconds(1));
+  signData(data1);
+  ims.insert(*data1);
+
+  shared_ptr<Data> data2 = makeData("/A/2");
+  ims.insert(*data2);
+
+  shared_ptr<Interest> interest = makeInterest("/A");
+  interest->setMustBeFresh(true);
+  shared_ptr<Interest> fullNameInterest = makeInterest(data1->getFullName());
+  fullNameInterest->setMustBeFresh(true);
+
+  BOOST_REQUIRE(static_cast<bool>(ims.find(*interest)));
+  BOOST_CHECK_EQUAL(ims.find(*interest)->getName(), "/A/1");
+  BOOST_CHECK(static_cast<bool>(ims.find(*fullNameInterest)));
+
+  advanceClocks(time::milliseconds(1500));
+
+  // Data without FreshnessPeriod never becomes stale
+  BOOST_REQUIRE(static_cast<bool>(ims.find(*interest)));
+  BOOST_CHECK_EQUAL(ims.find(*interest)->getName(), "/A/2");
+  BOOST_CHECK(!static_cast<bool>(ims.find(*fullNameInterest)));
+
+  interest->setMustBeFresh(false);
+  BOOST_REQUIRE(static_cast<bool>(ims.find(*interest)));
+  BOOST_CHECK_EQUAL(ims.find(*interest)->getName(), "/A/1");
+}
+
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(Sweep, T, InMemoryStorages, ndn::tests::UnitTestTimeFixture)
+{
+  Scheduler scheduler(io);
+  T ims;
+
+  ims.insert(*makeData("/sweep/1"));
+  advanceClocks(time::milliseconds(500));
+  ims.insert(*makeData("/sweep/2"));
+  ims.insert(*makeData("/sweep/3"));
+
+  ims.startSweep(scheduler, time::seconds(1), time::milliseconds(100), 1);
+
+  advanceClocks(time::milliseconds(100), 4);
+  BOOST_CHECK_EQUAL(ims.size(), 3);
+  advanceClocks(time::milliseconds(100));
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+  BOOST_CHECK(!static_cast<bool>(ims.find(Name("/sweep/1"))));
+
+  // both remaining packets expire together; the sweep is rescheduled until they are erased
+  advanceClocks(time::milliseconds(500));
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+
+  ims.insert(*makeData("/sweep/4"));
+  ims.stopSweep();
+  advanceClocks(time::seconds(2));
+  BOOST_CHECK_EQUAL(ims.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(EraseExpired)
+{
+  InMemoryStorageLru ims;
+
+  ims.insert(*makeData("/expired/1"));
+  ims.insert(*makeData("/expired/2"));
+
+  BOOST_CHECK_EQUAL(ims.eraseExpired(time::seconds(-1), 1), false);
+  BOOST_CHECK_EQUAL(ims.size(), 1);
+  BOOST_CHECK(!static_cast<bool>(ims.find(Name("/expired/1"))));
+
+  BOOST_CHECK_EQUAL(ims.eraseExpired(time::seconds(-1)), true);
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+}
+
+typedef boost::mpl::list<InMemoryStorageFifo, InMemoryStorageLfu, InMemoryStorageLru,
+                         InMemoryStorageClock, InMemoryStorageSlru> InMemoryStoragesLimited;
 
 BOOST_AUTO_TEST_CASE_TEMPLATE(setCapacity, T, InMemoryStoragesLimited)
 {
@@ -699,6 +824,150 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(InsertAndEvict, T, InMemoryStoragesLimited)
   BOOST_CHECK(!static_cast<bool>(found));
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(EraseSubtree, T, InMemoryStoragesLimited)
+{
+  T ims(1000);
+
+  for (int i = 0; i < 100; ++i) {
+    ims.insert(*makeData(Name("/a").appendSegment(i)));
+  }
+  ims.insert(*makeData("/a"));
+  ims.insert(*makeData("/ab"));
+  ims.insert(*makeData("/b"));
+  BOOST_CHECK_EQUAL(ims.size(), 103);
+  BOOST_CHECK_EQUAL(ims.getCapacity(), 160);
+
+  ims.erase("/a");
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+  BOOST_CHECK_EQUAL(ims.getCapacity(), 5);
+  BOOST_CHECK(ims.find(Name("/ab")) != nullptr);
+  BOOST_CHECK(ims.find(Name("/b")) != nullptr);
+
+  ims.erase("/");
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+  BOOST_CHECK_EQUAL(ims.getCapacity(), 1);
+
+  ims.insert(*makeData("/c"));
+  ims.insert(*makeData("/d"));
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(InsertBatch, T, InMemoryStoragesLimited)
+{
+  T ims(1000);
+
+  shared_ptr<Data> existing = makeData(Name("/batch").appendSegment(5));
+  ims.insert(*existing);
+  ims.insert(*makeData("/other"));
+
+  std::vector<shared_ptr<Data>> datas;
+  for (int i = 99; i >= 0; --i) {
+    datas.push_back(makeData(Name("/batch").appendSegment(i)));
+  }
+  datas.push_back(datas.front());
+
+  ims.insertBatch(datas.begin(), datas.end());
+  BOOST_CHECK_EQUAL(ims.size(), 101);
+  // capacity is grown once for the whole batch, instead of doubled up to 160
+  BOOST_CHECK_EQUAL(ims.getCapacity(), 2 + datas.size());
+  BOOST_CHECK_EQUAL(ims.find(Name("/batch").appendSegment(5)), existing);
+  for (int i = 0; i < 100; ++i) {
+    BOOST_CHECK(ims.find(*makeInterest(Name("/batch").appendSegment(i))) != nullptr);
+  }
+
+  shared_ptr<Interest> interest = makeInterest("/batch");
+  interest->setChildSelector(1);
+  BOOST_REQUIRE(ims.find(*interest) != nullptr);
+  BOOST_CHECK_EQUAL(ims.find(*interest)->getName(), Name("/batch").appendSegment(99));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(InsertBatchAppend, T, InMemoryStoragesLimited)
+{
+  T ims(1000);
+
+  ims.insert(*makeData(Name("/append/a").appendSegment(0)));
+  ims.insert(*makeData(Name("/append/a").appendSegment(1)));
+
+  // all but the first packet sort after every packet in the storage
+  std::vector<shared_ptr<Data>> datas;
+  datas.push_back(makeData("/append/0"));
+  for (int i = 0; i < 50; ++i) {
+    datas.push_back(makeData(Name("/append/b").appendSegment(i)));
+  }
+
+  ims.insertBatch(datas.begin(), datas.end());
+  BOOST_CHECK_EQUAL(ims.size(), 53);
+  for (const shared_ptr<Data>& data : datas) {
+    BOOST_CHECK_EQUAL(ims.find(data->getFullName()), data);
+  }
+
+  shared_ptr<Interest> interest = makeInterest("/append");
+  interest->setChildSelector(1);
+  BOOST_REQUIRE(ims.find(*interest) != nullptr);
+  BOOST_CHECK_EQUAL(ims.find(*interest)->getName().getPrefix(2), Name("/append/b"));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(InsertBatchAndEvict, T, InMemoryStoragesLimited)
+{
+  T ims(10);
+
+  std::vector<shared_ptr<Data>> datas;
+  for (int i = 0; i < 25; ++i) {
+    datas.push_back(makeData(Name("/evict").appendSegment(i)));
+  }
+
+  ims.insertBatch(datas.begin(), datas.end());
+  BOOST_CHECK_EQUAL(ims.size(), 10);
+  BOOST_CHECK_EQUAL(ims.getCapacity(), 10);
+  BOOST_CHECK(ims.find(Name("/evict").appendSegment(24)) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(MemoryUsage, T, InMemoryStorages)
+{
+  T ims;
+
+  BOOST_CHECK_EQUAL(ims.getNPayloadBytes(), 0);
+  size_t emptyOverhead = ims.getNOverheadBytes();
+
+  shared_ptr<Data> data1 = makeData("/memory/1");
+  shared_ptr<Data> data2 = makeData("/memory/2");
+  ims.insert(*data1);
+  ims.insert(*data2);
+
+  BOOST_CHECK_EQUAL(ims.getNPayloadBytes(),
+                    data1->wireEncode().size() + data2->wireEncode().size());
+  BOOST_CHECK_GT(ims.getNOverheadBytes(), emptyOverhead);
+  BOOST_CHECK_EQUAL(ims.getNBytes(), ims.getNPayloadBytes() + ims.getNOverheadBytes());
+
+  ims.erase("/memory");
+  BOOST_CHECK_EQUAL(ims.getNPayloadBytes(), 0);
+  BOOST_CHECK_EQUAL(ims.getNOverheadBytes(), ims.getCapacity() * sizeof(InMemoryStorageEntry));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(ByteLimit, T, InMemoryStoragesLimited)
+{
+  T ims(10000);
+
+  size_t emptyBytes = ims.getNBytes();
+  ims.insert(*makeData("/bytes/0"));
+  size_t nBytesPerPacket = ims.getNBytes() - emptyBytes;
+
+  ims.setByteLimit(emptyBytes + 3 * nBytesPerPacket + nBytesPerPacket / 2);
+  BOOST_CHECK_EQUAL(ims.size(), 1);
+
+  for (int i = 1; i < 10; i++) {
+    std::ostringstream convert;
+    convert << i;
+    ims.insert(*makeData("/bytes/" + convert.str()));
+  }
+  BOOST_CHECK_EQUAL(ims.size(), 3);
+  BOOST_CHECK_LE(ims.getNBytes(), ims.getByteLimit());
+  BOOST_CHECK(static_cast<bool>(ims.find(*makeInterest("/bytes/9"))));
+
+  ims.setByteLimit(emptyBytes + nBytesPerPacket);
+  BOOST_CHECK_EQUAL(ims.size(), 1);
+}
+
 ///as Find function is implemented at the base case, therefore testing for one derived class is
 ///sufficient for all
 class FindFixture
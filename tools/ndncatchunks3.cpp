@@ -21,121 +21,317 @@
  * @author Wentao Shang <http://irl.cs.ucla.edu/~wentao/>
  */
 
+
 #include "face.hpp"
+#include "util/segment-pipeline.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
 
 namespace ndn {
 
-class Consumer
+/**
+ * @brief Fetches /<name>/<segment> with a SegmentPipeline and writes the content in segment order
+ *
+ * The last segment is learned from -c or from the FinalBlockId of any received segment.
+ * The report is built from the statistics of each segment reported by the pipeline.
+ */
+class Consumer : noncopyable
 {
 public:
-  Consumer(const std::string& dataName,
-           size_t pipeSize, size_t nTotalSegments,
-           int scope = -1, bool mustBeFresh = true)
-    : m_dataName(dataName)
-    , m_pipeSize(pipeSize)
-    , m_nTotalSegments(nTotalSegments)
-    , m_nextSegment(0)
-    , m_totalSize(0)
-    , m_isOutputEnabled(false)
-    , m_scope(scope)
-    , m_mustBeFresh(mustBeFresh)
-  {
-  }
-
-  inline void
-  enableOutput()
+  struct Options : public util::SegmentPipeline::Options
   {
-    m_isOutputEnabled = true;
-  }
+    Options()
+      : interestLifetime(4000)
+      , nTotalSegments(std::numeric_limits<uint64_t>::max())
+      , scope(-1)
+      , mustBeFresh(true)
+      , isOutputEnabled(false)
+      , isWindowTraceEnabled(false)
+    {
+      maxRto = time::seconds(60);
+    }
 
-  void
+    time::milliseconds interestLifetime;
+    uint64_t nTotalSegments;
+    int scope;
+    bool mustBeFresh;
+    bool isOutputEnabled;
+    bool isWindowTraceEnabled;
+  };
+
+  Consumer(const Name& dataName, const Options& options);
+
+  /**
+   * @brief Fetch all segments and print the report
+   * @return true if all segments are fetched
+   */
+  bool
   run();
 
 private:
   void
-  onData(Data& data);
+  onData(const util::SegmentPipeline::SegmentInfo& info, const Data& data);
+
+  void
+  onLoss(uint64_t segmentNo, bool isInterestTimeout);
+
+  void
+  onTimeout(uint64_t segmentNo);
+
+  void
+  setFinalSegment(uint64_t segmentNo);
+
+  void
+  writeInOrder(uint64_t segmentNo, const Block& content);
+
+  void
+  traceWindow();
+
+  void
+  stop();
+
+  void
+  fail(const std::string& msg);
 
   void
-  onTimeout(const Interest& interest);
+  printReport() const;
 
+private:
   Face m_face;
   Name m_dataName;
-  size_t m_pipeSize;
-  size_t m_nTotalSegments;
-  size_t m_nextSegment;
-  size_t m_totalSize;
-  bool m_isOutputEnabled;  // set to false by default
-
-  int m_scope;
-  bool m_mustBeFresh;
+  Options m_options;
+  shared_ptr<util::SegmentPipeline> m_pipeline;
+
+  bool m_hasFinalSegment;
+  uint64_t m_finalSegment;
+  uint64_t m_nextSegmentToWrite;
+  std::map<uint64_t, Block> m_outOfOrderContents;
+
+  bool m_hasFailed;
+  time::steady_clock::TimePoint m_startTime;
+  time::steady_clock::TimePoint m_stopTime;
+  uint64_t m_nBytes;
+  uint64_t m_nSegments;
+  uint64_t m_nTimeouts;
+  std::vector<double> m_rttSamples;                    // in milliseconds
+  std::vector<std::pair<double, double>> m_windowTrace; // time in milliseconds, window
 };
 
-void
+Consumer::Consumer(const Name& dataName, const Options& options)
+  : m_dataName(dataName)
+  , m_options(options)
+  , m_hasFinalSegment(false)
+  , m_finalSegment(0)
+  , m_nextSegmentToWrite(0)
+  , m_hasFailed(false)
+  , m_nBytes(0)
+  , m_nSegments(0)
+  , m_nTimeouts(0)
+{
+  Interest interest;
+  interest.setInterestLifetime(m_options.interestLifetime);
+  if (m_options.scope >= 0)
+    interest.setScope(m_options.scope);
+  interest.setMustBeFresh(m_options.mustBeFresh);
+
+  m_pipeline = util::SegmentPipeline::create(m_face, interest, m_dataName, m_options,
+                                             bind(&Consumer::onData, this, _1, _2),
+                                             bind(&Consumer::onLoss, this, _1, _2),
+                                             bind(&Consumer::onTimeout, this, _1));
+}
+
+bool
 Consumer::run()
 {
+  m_startTime = time::steady_clock::now();
+  traceWindow();
+
   try
     {
-      for (size_t i = 0; i < m_pipeSize; i++)
-        {
-          Interest interest(Name(m_dataName).appendSegment(m_nextSegment++));
-          interest.setInterestLifetime(time::milliseconds(4000));
-          if (m_scope >= 0)
-            interest.setScope(m_scope);
-          interest.setMustBeFresh(m_mustBeFresh);
-
-          m_face.expressInterest(interest,
-                                 bind(&Consumer::onData, this, _2),
-                                 bind(&Consumer::onTimeout, this, _1));
-        }
+      if (m_options.nTotalSegments != std::numeric_limits<uint64_t>::max())
+        setFinalSegment(m_options.nTotalSegments - 1);
+      m_pipeline->start(0);
 
-      // processEvents will block until the requested data received or timeout occurs
+      // processEvents will block until all segments are received or fetching fails
       m_face.processEvents();
     }
   catch (std::exception& e)
     {
       std::cerr << "ERROR: " << e.what() << std::endl;
+      return false;
     }
+
+  printReport();
+  return !m_hasFailed;
 }
 
 void
-Consumer::onData(Data& data)
+Consumer::onData(const util::SegmentPipeline::SegmentInfo& info, const Data& data)
 {
-  const Block& content = data.getContent();
-  const Name& name = data.getName();
+  if (info.nRetries == 0)
+    m_rttSamples.push_back(info.rtt.count() / 1000000.0);
 
-  if (m_isOutputEnabled)
+  const name::Component& finalBlockId = data.getFinalBlockId();
+  if (!finalBlockId.empty() && !m_hasFinalSegment)
     {
-      std::cout.write(reinterpret_cast<const char*>(content.value()), content.value_size());
+      try
+        {
+          setFinalSegment(finalBlockId.toSegment());
+        }
+      catch (const tlv::Error& e)
+        {
+          return fail(std::string("FinalBlockId is not a segment number: ") + e.what());
+        }
     }
 
-  m_totalSize += content.value_size();
+  traceWindow();
+
+  ++m_nSegments;
+  writeInOrder(info.segmentNo, data.getContent());
+}
+
+void
+Consumer::onLoss(uint64_t segmentNo, bool isInterestTimeout)
+{
+  ++m_nTimeouts;
+  traceWindow();
+}
+
+void
+Consumer::onTimeout(uint64_t segmentNo)
+{
+  ++m_nTimeouts;
 
-  if (name[-1].toSegment() + 1 == m_nTotalSegments)
+  std::ostringstream os;
+  os << "segment #" << segmentNo << " timed out after " << m_options.maxRetries
+     << " retransmissions";
+  fail(os.str());
+}
+
+void
+Consumer::setFinalSegment(uint64_t segmentNo)
+{
+  m_hasFinalSegment = true;
+  m_finalSegment = segmentNo;
+  m_pipeline->setFinalSegmentNo(segmentNo);
+
+  m_outOfOrderContents.erase(m_outOfOrderContents.upper_bound(m_finalSegment),
+                             m_outOfOrderContents.end());
+}
+
+void
+Consumer::writeInOrder(uint64_t segmentNo, const Block& content)
+{
+  if (segmentNo > m_nextSegmentToWrite)
+    {
+      m_outOfOrderContents.insert(std::make_pair(segmentNo, content));
+      return;
+    }
+
+  if (segmentNo == m_nextSegmentToWrite)
+    {
+      if (m_options.isOutputEnabled)
+        std::cout.write(reinterpret_cast<const char*>(content.value()), content.value_size());
+      m_nBytes += content.value_size();
+      ++m_nextSegmentToWrite;
+
+      for (std::map<uint64_t, Block>::iterator it = m_outOfOrderContents.begin();
+           it != m_outOfOrderContents.end() && it->first == m_nextSegmentToWrite;
+           m_outOfOrderContents.erase(it++))
+        {
+          if (m_options.isOutputEnabled)
+            std::cout.write(reinterpret_cast<const char*>(it->second.value()),
+                            it->second.value_size());
+          m_nBytes += it->second.value_size();
+          ++m_nextSegmentToWrite;
+        }
+    }
+
+  if (m_hasFinalSegment && m_nextSegmentToWrite > m_finalSegment)
     {
       std::cerr << "Last segment received." << std::endl;
-      std::cerr << "Total # bytes of content received: " << m_totalSize << std::endl;
+      stop();
     }
   else
     {
-      // Send interest for next segment
-      Interest interest(Name(m_dataName).appendSegment(m_nextSegment++));
-      if (m_scope >= 0)
-        interest.setScope(m_scope);
-      interest.setInterestLifetime(time::milliseconds(4000));
-      interest.setMustBeFresh(m_mustBeFresh);
-
-      m_face.expressInterest(interest,
-                             bind(&Consumer::onData, this, _2),
-                             bind(&Consumer::onTimeout, this, _1));
+      m_pipeline->setNextSegmentToDeliver(m_nextSegmentToWrite);
     }
 }
 
+void
+Consumer::traceWindow()
+{
+  if (m_options.isWindowTraceEnabled)
+    {
+      time::nanoseconds elapsed = time::steady_clock::now() - m_startTime;
+      m_windowTrace.push_back(std::make_pair(elapsed.count() / 1000000.0,
+                                             m_pipeline->getCwnd()));
+    }
+}
 
 void
-Consumer::onTimeout(const Interest& interest)
+Consumer::stop()
 {
-  //XXX: currently no retrans
-  std::cerr << "TIMEOUT: last interest sent for segment #" << (m_nextSegment - 1) << std::endl;
+  m_stopTime = time::steady_clock::now();
+  m_pipeline->stop();
+  m_outOfOrderContents.clear();
+}
+
+void
+Consumer::fail(const std::string& msg)
+{
+  std::cerr << "ERROR: " << msg << std::endl;
+  m_hasFailed = true;
+  stop();
+}
+
+static double
+percentile(const std::vector<double>& sortedSamples, double p)
+{
+  size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sortedSamples.size()));
+  return sortedSamples[std::max<size_t>(rank, 1) - 1];
+}
+
+void
+Consumer::printReport() const
+{
+  time::nanoseconds elapsed = m_stopTime - m_startTime;
+  double seconds = elapsed.count() / 1000000000.0;
+
+  std::cerr << std::fixed << std::setprecision(3)
+            << "Total # bytes of content received: " << m_nBytes << "\n"
+            << "Segments received: " << m_nSegments << "\n"
+            << "Time elapsed: " << seconds << " s\n";
+  if (seconds > 0)
+    std::cerr << "Goodput: " << m_nBytes * 8 / seconds / 1000000.0 << " Mbit/s\n";
+  std::cerr << "Retransmissions: " << m_pipeline->getNRetransmissions()
+            << ", timeouts: " << m_nTimeouts << "\n"
+            << "Final window: " << m_pipeline->getCwnd() << " segments, RTO: "
+            << time::duration_cast<time::milliseconds>(m_pipeline->getRto()).count() << " ms\n";
+
+  if (!m_rttSamples.empty())
+    {
+      std::vector<double> samples(m_rttSamples);
+      std::sort(samples.begin(), samples.end());
+      std::cerr << "RTT (ms) from " << samples.size() << " samples:"
+                << " min " << samples.front()
+                << ", p50 " << percentile(samples, 50)
+                << ", p90 " << percentile(samples, 90)
+                << ", p99 " << percentile(samples, 99)
+                << ", max " << samples.back() << "\n";
+    }
+
+  if (m_options.isWindowTraceEnabled)
+    {
+      std::cerr << "Window trace (ms, segments):\n";
+      for (size_t i = 0; i < m_windowTrace.size(); ++i)
+        std::cerr << m_windowTrace[i].first << "\t" << m_windowTrace[i].second << "\n";
+    }
+
+  std::cerr.flush();
 }
 
 
@@ -143,7 +339,16 @@ int
 usage(const std::string &filename)
 {
   std::cerr << "Usage: \n    "
-            << filename << " [-p pipeSize] [-c nTotalSegmentsment] [-o] /ndn/name\n";
+            << filename << " [-p initWindow] [-w maxWindow] [-l lifetimeMs] [-r maxRetries]"
+            << " [-c nTotalSegments] [-o] [-t] /ndn/name\n"
+            << "\n"
+            << "  -p  initial window size, in segments (default 1)\n"
+            << "  -w  maximum window size, in segments (default 1024)\n"
+            << "  -l  InterestLifetime, in milliseconds (default 4000)\n"
+            << "  -r  maximum number of retransmissions of each segment (default 3)\n"
+            << "  -c  number of segments, if the producer does not set FinalBlockId\n"
+            << "  -o  write the content to the standard output\n"
+            << "  -t  print the window trace in the report\n";
   return 1;
 }
 
@@ -152,29 +357,36 @@ int
 main(int argc, char** argv)
 {
   std::string name;
-  int pipeSize = 1;
-  int nTotalSegments = std::numeric_limits<int>::max();
-  bool output = false;
+  Consumer::Options options;
 
   int opt;
-  while ((opt = getopt(argc, argv, "op:c:")) != -1)
+  while ((opt = getopt(argc, argv, "op:w:l:r:c:t")) != -1)
     {
       switch (opt)
         {
         case 'p':
-          pipeSize = atoi(optarg);
-          if (pipeSize <= 0)
-            pipeSize = 1;
-          std::cerr << "main(): set pipe size = " << pipeSize << std::endl;
+          options.initCwnd = std::max(1, atoi(optarg));
+          std::cerr << "main(): set initial window = " << options.initCwnd << std::endl;
+          break;
+        case 'w':
+          options.maxCwnd = std::max(1, atoi(optarg));
+          std::cerr << "main(): set maximum window = " << options.maxCwnd << std::endl;
+          break;
+        case 'l':
+          options.interestLifetime = time::milliseconds(std::max(1, atoi(optarg)));
+          break;
+        case 'r':
+          options.maxRetries = std::max(0, atoi(optarg));
           break;
         case 'c':
-          nTotalSegments = atoi(optarg);
-          if (nTotalSegments <= 0)
-            nTotalSegments = 1;
-          std::cerr << "main(): set total seg = " << nTotalSegments << std::endl;
+          options.nTotalSegments = std::max(1, atoi(optarg));
+          std::cerr << "main(): set total seg = " << options.nTotalSegments << std::endl;
           break;
         case 'o':
-          output = true;
+          options.isOutputEnabled = true;
+          break;
+        case 't':
+          options.isWindowTraceEnabled = true;
           break;
         default:
           return usage(argv[0]);
@@ -191,14 +403,9 @@ main(int argc, char** argv)
       return usage(argv[0]);
     }
 
-  Consumer consumer(name, pipeSize, nTotalSegments);
-
-  if (output)
-    consumer.enableOutput();
-
-  consumer.run();
+  Consumer consumer(name, options);
 
-  return 0;
+  return consumer.run() ? 0 : 1;
 }
 
 } // namespace ndn
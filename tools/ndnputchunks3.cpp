@@ -23,108 +23,446 @@
 
 #include "face.hpp"
 #include "security/key-chain.hpp"
+#include "util/in-memory-storage-lru.hpp"
+
+#include <boost/asio/io_service.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace ndn {
 
 const size_t MAX_SEG_SIZE = 4096;
 
-class Producer
+static std::string
+makeErrorMessage(const std::string& what)
+{
+  return what + ": " + std::strerror(errno);
+}
+
+/**
+ * @brief Serves a file as /<prefix>/<segment> without preparing the segments in advance
+ *
+ * A regular file, given with -f or redirected to the standard input, is memory-mapped, so
+ * that only the pages of requested segments are read and they can be reclaimed by the kernel.
+ * Other input is read into memory first.  The prefix is registered right away, and each
+ * segment is created and signed when it is first requested.  With signing threads, segments
+ * are signed in parallel, and segments following a requested one are signed ahead of the
+ * consumer.  Signed segments are kept in a bounded LRU cache.
+ */
+class Producer : noncopyable
 {
 public:
-  Producer(const char* name)
-    : m_name(name)
-    , m_isVerbose(false)
+  struct Options
   {
-    int segnum = 0;
-    char* buf = new char[MAX_SEG_SIZE];
-    do
-      {
-        std::cin.read(buf, MAX_SEG_SIZE);
-        int got = std::cin.gcount();
-
-        if (got > 0)
-          {
-            shared_ptr<Data> data =
-              make_shared<Data>(Name(m_name).appendSegment(segnum));
-
-            data->setFreshnessPeriod(time::milliseconds(10000)); // 10 sec
-            data->setContent(reinterpret_cast<const uint8_t*>(buf), got);
-
-            m_keychain.sign(*data);
-            m_store.push_back(data);
-            segnum++;
-          }
-      }
-    while (static_cast<bool>(std::cin));
-
-    if (m_isVerbose)
-      std::cerr << "Created " << segnum << " chunks for prefix [" << m_name << "]" << std::endl;
-  }
+    Options()
+      : segmentSize(MAX_SEG_SIZE)
+      , freshnessPeriod(10000)
+      , nSignThreads(0)
+      , nReadahead(0)
+      , cacheCapacity(16384)
+      , isVerbose(false)
+    {
+    }
+
+    std::string fileName; // read the standard input if empty
+    size_t segmentSize;
+    time::milliseconds freshnessPeriod;
+    size_t nSignThreads;
+    size_t nReadahead;
+    size_t cacheCapacity;
+    bool isVerbose;
+  };
+
+  Producer(const Name& name, const Options& options);
+
+  ~Producer();
 
   void
-  onInterest(const Interest& interest)
+  run();
+
+private:
+  /**
+   * @brief A thread with its own KeyChain, as KeyChain is not thread-safe
+   */
+  struct Signer
   {
-    if (m_isVerbose)
-      std::cerr << "<< I: " << interest << std::endl;
+    boost::asio::io_service service;
+    unique_ptr<boost::asio::io_service::work> work;
+    KeyChain keyChain;
+    std::thread thread;
+  };
 
-    size_t segnum = static_cast<size_t>(interest.getName().rbegin()->toSegment());
+  void
+  openInput();
 
-    if (segnum < m_store.size())
-      {
-        m_face.put(*m_store[segnum]);
-      }
-  }
+  shared_ptr<Data>
+  makeSegment(uint64_t segmentNo) const;
 
   void
-  onRegisterFailed(const Name& prefix, const std::string& reason)
-  {
-    std::cerr << "ERROR: Failed to register prefix '"
-              << prefix << "' in local hub's daemon (" << reason << ")"
-              << std::endl;
-    m_face.shutdown();
-  }
+  signInBackground(uint64_t segmentNo, bool isRequested);
 
   void
-  run()
-  {
-    if (m_store.empty())
-      {
-        std::cerr << "Nothing to serve. Exiting." << std::endl;
-        return;
-      }
-
-    m_face.setInterestFilter(m_name,
-                             bind(&Producer::onInterest, this, _2),
-                             RegisterPrefixSuccessCallback(),
-                             bind(&Producer::onRegisterFailed, this, _1, _2));
-    m_face.processEvents();
-  }
+  onSegmentSigned(const shared_ptr<Data>& data);
+
+  void
+  onSigningFailed(uint64_t segmentNo, const std::string& reason);
+
+  void
+  onInterest(const Interest& interest);
+
+  void
+  onRegisterSuccess(const Name& prefix);
+
+  void
+  onRegisterFailed(const Name& prefix, const std::string& reason);
 
 private:
   Name m_name;
+  Options m_options;
   Face m_face;
   KeyChain m_keychain;
 
-  std::vector< shared_ptr<Data> > m_store;
+  const uint8_t* m_content;
+  size_t m_contentSize;
+  void* m_mapping;
+  std::vector<uint8_t> m_buffer; // content that cannot be mapped
+  uint64_t m_nSegments;
+  name::Component m_finalBlockId;
+
+  util::InMemoryStorageLru m_store;
+  std::vector<unique_ptr<Signer>> m_signers;
+  size_t m_nextSigner;
+  std::map<uint64_t, bool> m_signingSegments; // segment => whether it has been requested
+  uint64_t m_readaheadEnd;                    // segments before this are signed ahead
 
-  bool m_isVerbose;
+  time::steady_clock::TimePoint m_startTime;
+  bool m_isFirstInterest;
 };
 
+Producer::Producer(const Name& name, const Options& options)
+  : m_name(name)
+  , m_options(options)
+  , m_content(0)
+  , m_contentSize(0)
+  , m_mapping(MAP_FAILED)
+  , m_nSegments(0)
+  , m_store(options.cacheCapacity)
+  , m_nextSigner(0)
+  , m_readaheadEnd(0)
+  , m_startTime(time::steady_clock::now())
+  , m_isFirstInterest(true)
+{
+  openInput();
+
+  m_nSegments = (m_contentSize + m_options.segmentSize - 1) / m_options.segmentSize;
+  if (m_nSegments > 0)
+    m_finalBlockId = name::Component::fromSegment(m_nSegments - 1);
+
+  // segments signed ahead must not be evicted before they are requested
+  m_options.nReadahead = std::min(m_options.nReadahead, m_options.cacheCapacity / 2);
+
+  for (size_t i = 0; i < m_options.nSignThreads; ++i)
+    {
+      m_signers.push_back(unique_ptr<Signer>(new Signer));
+      Signer* signer = m_signers.back().get();
+      signer->work.reset(new boost::asio::io_service::work(signer->service));
+      signer->thread = std::thread([signer] { signer->service.run(); });
+    }
+
+  std::cerr << "Serving " << m_contentSize << " bytes in " << m_nSegments << " segments"
+            << (m_mapping != MAP_FAILED ? " from a memory-mapped file" : "") << std::endl;
+}
+
+Producer::~Producer()
+{
+  for (size_t i = 0; i < m_signers.size(); ++i)
+    {
+      m_signers[i]->work.reset();
+      m_signers[i]->service.stop();
+      m_signers[i]->thread.join();
+    }
+
+  if (m_mapping != MAP_FAILED)
+    ::munmap(m_mapping, m_contentSize);
+}
+
+void
+Producer::openInput()
+{
+  int fd = STDIN_FILENO;
+  if (!m_options.fileName.empty())
+    {
+      fd = ::open(m_options.fileName.c_str(), O_RDONLY);
+      if (fd < 0)
+        throw std::runtime_error(makeErrorMessage("cannot open " + m_options.fileName));
+    }
+
+  struct stat st;
+  if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+    {
+      m_contentSize = static_cast<size_t>(st.st_size);
+      if (m_contentSize > 0)
+        {
+          m_mapping = ::mmap(0, m_contentSize, PROT_READ, MAP_SHARED, fd, 0);
+          if (m_mapping == MAP_FAILED)
+            throw std::runtime_error(makeErrorMessage("mmap"));
+          ::madvise(m_mapping, m_contentSize, MADV_SEQUENTIAL);
+          m_content = reinterpret_cast<const uint8_t*>(m_mapping);
+        }
+    }
+  else
+    {
+      uint8_t buf[MAX_SEG_SIZE];
+      ssize_t n;
+      while ((n = ::read(fd, buf, sizeof(buf))) != 0)
+        {
+          if (n < 0 && errno == EINTR)
+            continue;
+          if (n < 0)
+            throw std::runtime_error(makeErrorMessage("cannot read input"));
+          m_buffer.insert(m_buffer.end(), buf, buf + n);
+        }
+      m_content = m_buffer.data();
+      m_contentSize = m_buffer.size();
+    }
+
+  if (fd != STDIN_FILENO)
+    ::close(fd);
+}
+
+shared_ptr<Data>
+Producer::makeSegment(uint64_t segmentNo) const
+{
+  size_t offset = segmentNo * m_options.segmentSize;
+  size_t size = std::min(m_options.segmentSize, m_contentSize - offset);
+
+  shared_ptr<Data> data = make_shared<Data>(Name(m_name).appendSegment(segmentNo));
+  data->setFreshnessPeriod(m_options.freshnessPeriod);
+  data->setFinalBlockId(m_finalBlockId);
+  data->setContent(m_content + offset, size);
+  return data;
+}
+
+void
+Producer::signInBackground(uint64_t segmentNo, bool isRequested)
+{
+  m_signingSegments[segmentNo] = isRequested;
+
+  Signer* signer = m_signers[m_nextSigner++ % m_signers.size()].get();
+  signer->service.post([this, signer, segmentNo] {
+      try
+        {
+          shared_ptr<Data> data = makeSegment(segmentNo);
+          signer->keyChain.sign(*data);
+          m_face.getIoService().post(bind(&Producer::onSegmentSigned, this, data));
+        }
+      catch (std::exception& e)
+        {
+          // the failure is handled on the Face's thread, which owns m_signingSegments
+          m_face.getIoService().post(bind(&Producer::onSigningFailed, this,
+                                          segmentNo, std::string(e.what())));
+        }
+    });
+}
+
+void
+Producer::onSegmentSigned(const shared_ptr<Data>& data)
+{
+  m_store.insert(*data);
+
+  std::map<uint64_t, bool>::iterator it = m_signingSegments.find(data->getName()[-1].toSegment());
+  if (it != m_signingSegments.end())
+    {
+      // a segment signed ahead is only sent when an Interest for it arrives
+      if (it->second)
+        m_face.put(*data);
+      m_signingSegments.erase(it);
+    }
+}
+
+void
+Producer::onSigningFailed(uint64_t segmentNo, const std::string& reason)
+{
+  std::cerr << "ERROR: Failed to sign segment " << segmentNo << ": " << reason << std::endl;
+
+  // the segment is signed again when the next Interest for it arrives
+  m_signingSegments.erase(segmentNo);
+}
+
+void
+Producer::onInterest(const Interest& interest)
+{
+  if (m_options.isVerbose)
+    std::cerr << "<< I: " << interest << std::endl;
+
+  if (m_isFirstInterest)
+    {
+      m_isFirstInterest = false;
+      std::cerr << "First Interest after "
+                << time::duration_cast<time::milliseconds>(time::steady_clock::now() - m_startTime)
+                << std::endl;
+    }
+
+  const Name& name = interest.getName();
+  if (name.size() != m_name.size() + 1 || !name[-1].isSegment())
+    return;
+
+  uint64_t segmentNo = name[-1].toSegment();
+  if (segmentNo >= m_nSegments)
+    return;
+
+  shared_ptr<const Data> data = m_store.find(name);
+  if (static_cast<bool>(data))
+    {
+      m_face.put(*data);
+    }
+  else if (m_signers.empty())
+    {
+      shared_ptr<Data> segment = makeSegment(segmentNo);
+      m_keychain.sign(*segment);
+      m_store.insert(*segment);
+      m_face.put(*segment);
+    }
+  else
+    {
+      std::map<uint64_t, bool>::iterator it = m_signingSegments.find(segmentNo);
+      if (it == m_signingSegments.end())
+        signInBackground(segmentNo, true);
+      else
+        it->second = true;
+    }
+
+  if (m_signers.empty() || m_options.nReadahead == 0)
+    return;
+
+  // restart the readahead if the consumer goes back
+  uint64_t end = std::min<uint64_t>(segmentNo + 1 + m_options.nReadahead, m_nSegments);
+  if (m_readaheadEnd > end + m_options.nReadahead)
+    m_readaheadEnd = segmentNo + 1;
+
+  for (uint64_t i = std::max(m_readaheadEnd, segmentNo + 1); i < end; ++i)
+    {
+      if (m_signingSegments.count(i) == 0)
+        signInBackground(i, false);
+    }
+  m_readaheadEnd = std::max(m_readaheadEnd, end);
+}
+
+void
+Producer::onRegisterSuccess(const Name& prefix)
+{
+  std::cerr << "Prefix '" << prefix << "' registered after "
+            << time::duration_cast<time::milliseconds>(time::steady_clock::now() - m_startTime)
+            << std::endl;
+}
+
+void
+Producer::onRegisterFailed(const Name& prefix, const std::string& reason)
+{
+  std::cerr << "ERROR: Failed to register prefix '"
+            << prefix << "' in local hub's daemon (" << reason << ")"
+            << std::endl;
+  m_face.shutdown();
+}
+
+void
+Producer::run()
+{
+  if (m_nSegments == 0)
+    {
+      std::cerr << "Nothing to serve. Exiting." << std::endl;
+      return;
+    }
+
+  m_face.setInterestFilter(m_name,
+                           bind(&Producer::onInterest, this, _2),
+                           bind(&Producer::onRegisterSuccess, this, _1),
+                           bind(&Producer::onRegisterFailed, this, _1, _2));
+  m_face.processEvents();
+}
+
+int
+usage(const std::string& filename)
+{
+  std::cerr << "Usage: \n    "
+            << filename << " [-f file] [-s segmentSize] [-j nSignThreads] [-a readahead]"
+            << " [-c cacheSize] [-v] /data/prefix\n"
+            << "\n"
+            << "  -f  file to serve (default: the standard input)\n"
+            << "      input that is not a regular file, e.g., a pipe, is read into memory\n"
+            << "      completely before the prefix is registered\n"
+            << "  -s  maximum content size of a segment, in bytes (default " << MAX_SEG_SIZE << ")\n"
+            << "      at most " << MAX_NDN_PACKET_SIZE << " minus "
+            << Data::ENCODING_HEADROOM << " and the size of the encoded prefix\n"
+            << "  -j  number of threads that sign segments (default 0: sign upon each Interest)\n"
+            << "  -a  number of segments to sign ahead of the requested one (default 0)\n"
+            << "  -c  maximum number of signed segments to keep (default 16384)\n"
+            << "  -v  print each Interest\n";
+  return 1;
+}
+
 int
 main(int argc, char** argv)
 {
-  if (argc < 2)
+  Producer::Options options;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "f:s:j:a:c:v")) != -1)
     {
-      std::cerr << "Usage: ./ndnputchunks [data_prefix]\n";
-      return -1;
+      switch (opt)
+        {
+        case 'f':
+          options.fileName = optarg;
+          break;
+        case 's':
+          options.segmentSize = std::max(1, atoi(optarg));
+          break;
+        case 'j':
+          options.nSignThreads = std::max(0, atoi(optarg));
+          break;
+        case 'a':
+          options.nReadahead = std::max(0, atoi(optarg));
+          break;
+        case 'c':
+          options.cacheCapacity = std::max(1, atoi(optarg));
+          break;
+        case 'v':
+          options.isVerbose = true;
+          break;
+        default:
+          return usage(argv[0]);
+        }
+    }
+
+  if (optind >= argc)
+    {
+      return usage(argv[0]);
     }
 
   try
     {
+      // leave room for the Name, MetaInfo and Signature, so that every segment fits in a packet
+      size_t prefixSize = Name(argv[optind]).wireEncode().size();
+      if (prefixSize + Data::ENCODING_HEADROOM >= MAX_NDN_PACKET_SIZE ||
+          options.segmentSize > MAX_NDN_PACKET_SIZE - Data::ENCODING_HEADROOM - prefixSize)
+        {
+          std::cerr << "ERROR: segments of " << options.segmentSize << " bytes under this "
+                    << "prefix would exceed the maximum packet size" << std::endl;
+          return usage(argv[0]);
+        }
+
       time::steady_clock::TimePoint startTime = time::steady_clock::now();
 
       std::cerr << "Preparing the input..." << std::endl;
-      Producer producer(argv[1]);
+      Producer producer(argv[optind], options);
       std::cerr << "Ready... (took " << (time::steady_clock::now() - startTime) << std::endl;
 
       while (true)